@@ -0,0 +1,412 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2024 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <string_view>
+#include <gpu/texture/layout.h>
+#include <gpu/texture/bc_decoder.h>
+
+/**
+ * @brief A host benchmark for the texture tiling and decoding kernels, every kernel is checked against a golden output prior to being timed
+ * @note Usage: texture_benchmark [filter] [--golden], where only benchmarks with a name containing the filter are run and --golden prints the hashes of the BCn decoder outputs for updating their golden hashes
+ */
+namespace skyline::benchmark {
+    using namespace gpu::texture;
+
+    constexpr std::chrono::milliseconds MinimumDuration{250}; //!< The minimum duration to repeatedly run a kernel for
+    constexpr size_t MinimumIterations{3};
+
+    std::string_view filter;
+    bool printGolden{};
+    size_t failureCount{};
+
+    /**
+     * @brief Runs the kernel repeatedly and reports the throughput of the fastest iteration
+     * @param bytes The amount of bytes produced by a single iteration of the kernel
+     * @param isValid If the output of the kernel matched the golden output
+     */
+    void Report(const std::string &name, size_t bytes, bool isValid, const std::function<void()> &kernel) {
+        std::chrono::duration<double> best{std::chrono::duration<double>::max()}, total{};
+        for (size_t iteration{}; iteration < MinimumIterations || total < MinimumDuration; iteration++) {
+            auto start{std::chrono::steady_clock::now()};
+            kernel();
+            std::chrono::duration<double> duration{std::chrono::steady_clock::now() - start};
+            best = std::min(best, duration);
+            total += duration;
+        }
+
+        if (!isValid)
+            failureCount++;
+        std::printf("%-64s %10zu B %9.2f GB/s  %s\n", name.c_str(), bytes, static_cast<double>(bytes) / best.count() / 1e9, isValid ? "OK" : "MISMATCH");
+    }
+
+    bool IsFiltered(const std::string &name) {
+        return !filter.empty() && name.find(filter) == std::string::npos;
+    }
+
+    std::vector<u8> RandomBuffer(size_t size, u64 seed) {
+        std::mt19937_64 random{seed};
+        std::vector<u8> buffer(size);
+        for (size_t offset{}; offset < size; offset += sizeof(u64)) {
+            u64 value{random()};
+            std::memcpy(buffer.data() + offset, &value, std::min(sizeof(u64), size - offset));
+        }
+        return buffer;
+    }
+
+    /**
+     * @return A 64-bit FNV-1a hash of the buffer, this is used over XXH3 so golden hashes are independent of the hashing library
+     */
+    u64 HashBuffer(const std::vector<u8> &buffer) {
+        u64 hash{0xCBF29CE484222325};
+        for (u8 byte : buffer)
+            hash = (hash ^ byte) * 0x100000001B3;
+        return hash;
+    }
+
+    /**
+     * @brief A straightforward implementation of block-linear addressing that the optimized kernels are validated against
+     * @param widthBytes The width of the surface in bytes, this is not aligned to GOBs
+     * @param heightLines The height of the surface in lines of format blocks
+     * @return The offset of the byte at the supplied coordinates in a block-linear surface
+     */
+    size_t ReferenceBlockLinearOffset(size_t x, size_t y, size_t z, size_t widthBytes, size_t heightLines, size_t gobBlockHeight, size_t gobBlockDepth) {
+        constexpr size_t GobWidth{64}, GobHeight{8}, GobSize{GobWidth * GobHeight};
+        size_t robHeight{GobHeight * gobBlockHeight};
+        size_t blockSize{GobSize * gobBlockHeight * gobBlockDepth};
+        size_t robSize{util::DivideCeil(widthBytes, GobWidth) * blockSize};
+        size_t mobSize{util::DivideCeil(heightLines, robHeight) * robSize};
+
+        size_t gobOffset{(z / gobBlockDepth) * mobSize + (y / robHeight) * robSize + (x / GobWidth) * blockSize +
+                         (z % gobBlockDepth) * GobSize * gobBlockHeight + ((y % robHeight) / GobHeight) * GobSize};
+        return gobOffset + ((x % 64) / 32) * 256 + ((y % 8) / 2) * 64 + ((x % 32) / 16) * 32 + (y % 2) * 16 + (x % 16);
+    }
+
+    struct SurfaceCase {
+        Dimensions dimensions;
+        size_t formatBlockWidth, formatBlockHeight, formatBpb;
+        size_t gobBlockHeight, gobBlockDepth;
+    };
+
+    /**
+     * @brief Representative surfaces covering all common bpb values, block heights and depths alongside sizes that aren't aligned to GOBs or blocks
+     */
+    const std::vector<SurfaceCase> SurfaceCases{
+        {{1920, 1080, 1}, 1, 1, 4, 16, 1},
+        {{1920, 1080, 1}, 1, 1, 8, 16, 1},
+        {{1280, 720, 1}, 1, 1, 2, 16, 1},
+        {{2048, 2048, 1}, 1, 1, 1, 16, 1},
+        {{1024, 1024, 1}, 1, 1, 16, 8, 1},
+        {{1000, 750, 1}, 1, 1, 12, 4, 1},
+        {{1023, 577, 1}, 1, 1, 4, 8, 1},
+        {{33, 17, 1}, 1, 1, 4, 2, 1},
+        {{2048, 2048, 1}, 4, 4, 8, 16, 1}, // BC1
+        {{2048, 1024, 1}, 4, 4, 16, 16, 1}, // BC3/BC7
+        {{1366, 766, 1}, 4, 4, 16, 8, 1}, // BC7 with partial blocks
+        {{1000, 600, 1}, 8, 8, 16, 8, 1}, // ASTC 8x8
+        {{256, 256, 64}, 1, 1, 4, 2, 2},
+        {{128, 128, 33}, 1, 1, 8, 1, 4},
+    };
+
+    std::string SurfaceName(const char *kernel, const SurfaceCase &surface) {
+        char name[128];
+        std::snprintf(name, sizeof(name), "%s %ux%ux%u bpb=%zu fb=%zux%zu gob=%zux%zu", kernel, surface.dimensions.width, surface.dimensions.height, surface.dimensions.depth, surface.formatBpb, surface.formatBlockWidth, surface.formatBlockHeight, surface.gobBlockHeight, surface.gobBlockDepth);
+        return name;
+    }
+
+    /**
+     * @brief Calls the function with the block-linear and pitch offsets of every byte of a pitch surface
+     * @param pitch The pitch of the pitch surface in bytes
+     */
+    template<typename Function>
+    void ForEachByte(const SurfaceCase &surface, size_t pitch, Function function) {
+        size_t widthBytes{util::DivideCeil<size_t>(surface.dimensions.width, surface.formatBlockWidth) * surface.formatBpb};
+        size_t heightLines{util::DivideCeil<size_t>(surface.dimensions.height, surface.formatBlockHeight)};
+        for (size_t z{}; z < surface.dimensions.depth; z++)
+            for (size_t y{}; y < heightLines; y++)
+                for (size_t x{}; x < widthBytes; x++)
+                    function(ReferenceBlockLinearOffset(x, y, z, widthBytes, heightLines, surface.gobBlockHeight, surface.gobBlockDepth), (z * heightLines + y) * pitch + x);
+    }
+
+    void BenchmarkTiling() {
+        for (const auto &surface : SurfaceCases) {
+            size_t widthBytes{util::DivideCeil<size_t>(surface.dimensions.width, surface.formatBlockWidth) * surface.formatBpb};
+            size_t heightLines{util::DivideCeil<size_t>(surface.dimensions.height, surface.formatBlockHeight)};
+            size_t linearSize{widthBytes * heightLines * surface.dimensions.depth};
+            size_t blockLinearSize{GetBlockLinearLayerSize(surface.dimensions, surface.formatBlockWidth, surface.formatBlockHeight, surface.formatBpb, surface.gobBlockHeight, surface.gobBlockDepth)};
+            size_t pitch{util::AlignUp(widthBytes, 256) + 256}; //!< A pitch with padding after every line to ensure it's respected
+            size_t pitchSize{pitch * heightLines * surface.dimensions.depth};
+
+            auto blockLinear{RandomBuffer(blockLinearSize, 1)};
+            auto linear{RandomBuffer(linearSize, 2)};
+
+            if (auto name{SurfaceName("BlockLinearToLinear", surface)}; !IsFiltered(name)) {
+                std::vector<u8> output(linearSize);
+                CopyBlockLinearToLinear(surface.dimensions, surface.formatBlockWidth, surface.formatBlockHeight, surface.formatBpb, surface.gobBlockHeight, surface.gobBlockDepth, blockLinear.data(), output.data());
+
+                bool isValid{true};
+                ForEachByte(surface, widthBytes, [&](size_t blockLinearOffset, size_t linearOffset) {
+                    isValid &= output[linearOffset] == blockLinear[blockLinearOffset];
+                });
+
+                Report(name, linearSize, isValid, [&] {
+                    CopyBlockLinearToLinear(surface.dimensions, surface.formatBlockWidth, surface.formatBlockHeight, surface.formatBpb, surface.gobBlockHeight, surface.gobBlockDepth, blockLinear.data(), output.data());
+                });
+            }
+
+            if (auto name{SurfaceName("LinearToBlockLinear", surface)}; !IsFiltered(name)) {
+                std::vector<u8> output(blockLinearSize);
+                CopyLinearToBlockLinear(surface.dimensions, surface.formatBlockWidth, surface.formatBlockHeight, surface.formatBpb, surface.gobBlockHeight, surface.gobBlockDepth, linear.data(), output.data());
+
+                bool isValid{true};
+                ForEachByte(surface, widthBytes, [&](size_t blockLinearOffset, size_t linearOffset) {
+                    isValid &= output[blockLinearOffset] == linear[linearOffset];
+                });
+
+                Report(name, linearSize, isValid, [&] {
+                    CopyLinearToBlockLinear(surface.dimensions, surface.formatBlockWidth, surface.formatBlockHeight, surface.formatBpb, surface.gobBlockHeight, surface.gobBlockDepth, linear.data(), output.data());
+                });
+            }
+
+            if (auto name{SurfaceName("BlockLinearToPitch", surface)}; !IsFiltered(name)) {
+                std::vector<u8> output(pitchSize);
+                CopyBlockLinearToPitch(surface.dimensions, surface.formatBlockWidth, surface.formatBlockHeight, surface.formatBpb, static_cast<u32>(pitch), surface.gobBlockHeight, surface.gobBlockDepth, blockLinear.data(), output.data());
+
+                bool isValid{true};
+                ForEachByte(surface, pitch, [&](size_t blockLinearOffset, size_t pitchOffset) {
+                    isValid &= output[pitchOffset] == blockLinear[blockLinearOffset];
+                });
+
+                Report(name, linearSize, isValid, [&] {
+                    CopyBlockLinearToPitch(surface.dimensions, surface.formatBlockWidth, surface.formatBlockHeight, surface.formatBpb, static_cast<u32>(pitch), surface.gobBlockHeight, surface.gobBlockDepth, blockLinear.data(), output.data());
+                });
+            }
+
+            if (auto name{SurfaceName("PitchToBlockLinear", surface)}; !IsFiltered(name)) {
+                auto input{RandomBuffer(pitchSize, 3)};
+                std::vector<u8> output(blockLinearSize);
+                CopyPitchToBlockLinear(surface.dimensions, surface.formatBlockWidth, surface.formatBlockHeight, surface.formatBpb, static_cast<u32>(pitch), surface.gobBlockHeight, surface.gobBlockDepth, input.data(), output.data());
+
+                bool isValid{true};
+                ForEachByte(surface, pitch, [&](size_t blockLinearOffset, size_t pitchOffset) {
+                    isValid &= output[blockLinearOffset] == input[pitchOffset];
+                });
+
+                Report(name, linearSize, isValid, [&] {
+                    CopyPitchToBlockLinear(surface.dimensions, surface.formatBlockWidth, surface.formatBlockHeight, surface.formatBpb, static_cast<u32>(pitch), surface.gobBlockHeight, surface.gobBlockDepth, input.data(), output.data());
+                });
+            }
+        }
+    }
+
+    /**
+     * @brief Benchmarks copying between a pitch surface and a subrect of a larger block-linear surface, as done by the DMA and I2M engines
+     */
+    void BenchmarkSubrectTiling() {
+        struct SubrectCase {
+            SurfaceCase surface; //!< The block-linear surface
+            Dimensions subrect;
+            u32 originX, originY; //!< The origin of the subrect in texels
+        };
+
+        const std::vector<SubrectCase> subrectCases{
+            {{{1920, 1080, 1}, 1, 1, 4, 16, 1}, {1280, 720, 1}, 320, 180},
+            {{{1920, 1080, 1}, 1, 1, 4, 16, 1}, {1000, 500, 1}, 7, 3},
+            {{{2048, 2048, 1}, 1, 1, 1, 16, 1}, {2000, 2000, 1}, 48, 48},
+            {{{1024, 1024, 1}, 1, 1, 16, 8, 1}, {512, 512, 1}, 256, 256},
+            {{{1024, 1024, 1}, 1, 1, 2, 4, 1}, {513, 257, 1}, 33, 65},
+            {{{512, 512, 4}, 1, 1, 8, 2, 2}, {300, 300, 4}, 16, 16},
+        };
+
+        for (const auto &[surface, subrect, originX, originY] : subrectCases) {
+            size_t widthBytes{util::DivideCeil<size_t>(surface.dimensions.width, surface.formatBlockWidth) * surface.formatBpb};
+            size_t heightLines{util::DivideCeil<size_t>(surface.dimensions.height, surface.formatBlockHeight)};
+            size_t blockLinearSize{GetBlockLinearLayerSize(surface.dimensions, surface.formatBlockWidth, surface.formatBlockHeight, surface.formatBpb, surface.gobBlockHeight, surface.gobBlockDepth)};
+            size_t subrectWidthBytes{util::DivideCeil<size_t>(subrect.width, surface.formatBlockWidth) * surface.formatBpb};
+            size_t subrectLines{util::DivideCeil<size_t>(subrect.height, surface.formatBlockHeight)};
+            size_t subrectSize{subrectWidthBytes * subrectLines * subrect.depth};
+            size_t pitch{subrectWidthBytes + 64};
+
+            size_t originXBytes{util::DivideCeil<size_t>(originX, surface.formatBlockWidth) * surface.formatBpb}, originLine{util::DivideCeil<size_t>(originY, surface.formatBlockHeight)};
+            auto forEachByte{[&](size_t rowPitch, auto function) {
+                for (size_t z{}; z < subrect.depth; z++)
+                    for (size_t y{}; y < subrectLines; y++)
+                        for (size_t x{}; x < subrectWidthBytes; x++)
+                            function(ReferenceBlockLinearOffset(originXBytes + x, originLine + y, z, widthBytes, heightLines, surface.gobBlockHeight, surface.gobBlockDepth), (z * subrectLines + y) * rowPitch + x);
+            }};
+
+            char suffix[64];
+            std::snprintf(suffix, sizeof(suffix), " rect=%ux%u@%u,%u", subrect.width, subrect.height, originX, originY);
+            auto blockLinear{RandomBuffer(blockLinearSize, 4)};
+
+            if (auto name{SurfaceName("BlockLinearToPitchSubrect", surface) + suffix}; !IsFiltered(name)) {
+                std::vector<u8> output(pitch * subrectLines * subrect.depth);
+                auto copy{[&] {
+                    CopyBlockLinearToPitchSubrect(subrect, surface.dimensions, surface.formatBlockWidth, surface.formatBlockHeight, surface.formatBpb, static_cast<u32>(pitch), surface.gobBlockHeight, surface.gobBlockDepth, blockLinear.data(), output.data(), originX, originY);
+                }};
+                copy();
+
+                bool isValid{true};
+                forEachByte(pitch, [&](size_t blockLinearOffset, size_t pitchOffset) {
+                    isValid &= output[pitchOffset] == blockLinear[blockLinearOffset];
+                });
+                Report(name, subrectSize, isValid, copy);
+            }
+
+            if (auto name{SurfaceName("LinearToBlockLinearSubrect", surface) + suffix}; !IsFiltered(name)) {
+                auto input{RandomBuffer(subrectSize, 5)};
+                auto output{blockLinear};
+                auto copy{[&] {
+                    CopyLinearToBlockLinearSubrect(subrect, surface.dimensions, surface.formatBlockWidth, surface.formatBlockHeight, surface.formatBpb, surface.gobBlockHeight, surface.gobBlockDepth, input.data(), output.data(), originX, originY);
+                }};
+                copy();
+
+                bool isValid{true};
+                forEachByte(subrectWidthBytes, [&](size_t blockLinearOffset, size_t linearOffset) {
+                    isValid &= output[blockLinearOffset] == input[linearOffset];
+                });
+                Report(name, subrectSize, isValid, copy);
+            }
+
+            if (auto name{SurfaceName("PitchToBlockLinearSubrect", surface) + suffix}; !IsFiltered(name)) {
+                auto input{RandomBuffer(pitch * subrectLines * subrect.depth, 6)};
+                auto output{blockLinear};
+                auto copy{[&] {
+                    CopyPitchToBlockLinearSubrect(subrect, surface.dimensions, surface.formatBlockWidth, surface.formatBlockHeight, surface.formatBpb, static_cast<u32>(pitch), surface.gobBlockHeight, surface.gobBlockDepth, input.data(), output.data(), originX, originY);
+                }};
+                copy();
+
+                bool isValid{true};
+                forEachByte(pitch, [&](size_t blockLinearOffset, size_t pitchOffset) {
+                    isValid &= output[blockLinearOffset] == input[pitchOffset];
+                });
+                Report(name, subrectSize, isValid, copy);
+            }
+        }
+    }
+
+    /**
+     * @brief Benchmarks deswizzling full mip chains in the same manner as Texture::SynchronizeHost
+     */
+    void BenchmarkMipChains() {
+        struct MipCase {
+            SurfaceCase surface;
+            size_t levelCount;
+        };
+
+        const std::vector<MipCase> mipCases{
+            {{{2048, 2048, 1}, 4, 4, 16, 16, 1}, 12},
+            {{{1024, 1024, 1}, 1, 1, 4, 16, 1}, 11},
+            {{{1000, 700, 1}, 4, 4, 8, 8, 1}, 10},
+            {{{128, 128, 128}, 1, 1, 4, 1, 8}, 8},
+        };
+
+        for (const auto &[surface, levelCount] : mipCases) {
+            char suffix[32];
+            std::snprintf(suffix, sizeof(suffix), " levels=%zu", levelCount);
+            auto name{SurfaceName("BlockLinearToLinearMips", surface) + suffix};
+            if (IsFiltered(name))
+                continue;
+
+            const auto &layout{GetBlockLinearLayout(surface.dimensions, surface.formatBlockWidth, surface.formatBlockHeight, surface.formatBpb, 0, 0, 0, surface.gobBlockHeight, surface.gobBlockDepth, levelCount)};
+            auto blockLinear{RandomBuffer(layout.layerSize, 7)};
+            std::vector<u8> output(layout.linearLayerSize);
+            auto copy{[&] {
+                u8 *input{blockLinear.data()}, *linear{output.data()};
+                for (const auto &level : layout.mipLevels) {
+                    CopyBlockLinearToLinear(level.dimensions, surface.formatBlockWidth, surface.formatBlockHeight, surface.formatBpb, level.blockHeight, level.blockDepth, input, linear);
+                    input += level.blockLinearSize;
+                    linear += level.linearSize;
+                }
+            }};
+            copy();
+
+            bool isValid{true};
+            size_t inputOffset{}, linearOffset{};
+            for (const auto &level : layout.mipLevels) {
+                SurfaceCase levelSurface{level.dimensions, surface.formatBlockWidth, surface.formatBlockHeight, surface.formatBpb, level.blockHeight, level.blockDepth};
+                size_t widthBytes{util::DivideCeil<size_t>(level.dimensions.width, surface.formatBlockWidth) * surface.formatBpb};
+                ForEachByte(levelSurface, widthBytes, [&](size_t blockLinearOffset, size_t offset) {
+                    isValid &= output[linearOffset + offset] == blockLinear[inputOffset + blockLinearOffset];
+                });
+                inputOffset += level.blockLinearSize;
+                linearOffset += level.linearSize;
+            }
+
+            Report(name, layout.linearLayerSize, isValid, copy);
+        }
+    }
+
+    /**
+     * @brief Benchmarks every BCn decoder on random blocks, the output is validated against hashes of the output of the original scalar decoders
+     * @note Random blocks exercise every mode of BC6H/BC7, including reserved ones
+     */
+    void BenchmarkBcn() {
+        struct BcnCase {
+            const char *name;
+            size_t blockSize, outputBpp;
+            std::function<void(const u8 *, u8 *, size_t, size_t)> decoder;
+            u64 goldenHash; //!< The hash of the output for a 1000x600 surface, this is checked prior to benchmarking on a 2048x2048 surface
+        };
+
+        const std::vector<BcnCase> bcnCases{
+            {"BC1", 8, 4, [](const u8 *input, u8 *output, size_t width, size_t height) { bcn::DecodeBc1(input, output, width, height, true); }, 0x2AA8CF92DD213E0F},
+            {"BC1 (No Alpha)", 8, 4, [](const u8 *input, u8 *output, size_t width, size_t height) { bcn::DecodeBc1(input, output, width, height, false); }, 0x144585C5714E00E2},
+            {"BC2", 16, 4, bcn::DecodeBc2, 0x7172AAA64E87ED2F},
+            {"BC3", 16, 4, bcn::DecodeBc3, 0x2C39AA3F3629FBF9},
+            {"BC4 Unorm", 8, 1, [](const u8 *input, u8 *output, size_t width, size_t height) { bcn::DecodeBc4(input, output, width, height, false); }, 0x8F0E97499D269070},
+            {"BC4 Snorm", 8, 1, [](const u8 *input, u8 *output, size_t width, size_t height) { bcn::DecodeBc4(input, output, width, height, true); }, 0xEAD19748612D7C0C},
+            {"BC5 Unorm", 16, 2, [](const u8 *input, u8 *output, size_t width, size_t height) { bcn::DecodeBc5(input, output, width, height, false); }, 0x210A1B692757A727},
+            {"BC5 Snorm", 16, 2, [](const u8 *input, u8 *output, size_t width, size_t height) { bcn::DecodeBc5(input, output, width, height, true); }, 0xE010BE280E0AEC4A},
+            {"BC6H Ufloat", 16, 8, [](const u8 *input, u8 *output, size_t width, size_t height) { bcn::DecodeBc6(input, output, width, height, false); }, 0x4E7694370CA25520},
+            {"BC6H Sfloat", 16, 8, [](const u8 *input, u8 *output, size_t width, size_t height) { bcn::DecodeBc6(input, output, width, height, true); }, 0xCBE6113F3F51BD93},
+            {"BC7", 16, 4, bcn::DecodeBc7, 0x496782312B79D8C4},
+        };
+
+        for (const auto &bcnCase : bcnCases) {
+            auto name{std::string{"Decode "} + bcnCase.name};
+            if (IsFiltered(name))
+                continue;
+
+            auto decode{[&](size_t width, size_t height) {
+                auto input{RandomBuffer(util::DivideCeil<size_t>(width, 4) * util::DivideCeil<size_t>(height, 4) * bcnCase.blockSize, 8)};
+                std::vector<u8> output(width * height * bcnCase.outputBpp);
+                bcnCase.decoder(input.data(), output.data(), width, height);
+                return std::pair{std::move(input), std::move(output)};
+            }};
+
+            u64 hash{HashBuffer(decode(1000, 600).second)};
+            if (printGolden)
+                std::printf("%s: 0x%016llX\n", bcnCase.name, static_cast<unsigned long long>(hash));
+
+            auto [input, output]{decode(2048, 2048)};
+            Report(name + " 2048x2048", output.size(), hash == bcnCase.goldenHash, [&] {
+                bcnCase.decoder(input.data(), output.data(), 2048, 2048);
+            });
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    using namespace skyline::benchmark;
+    for (int index{1}; index < argc; index++) {
+        std::string_view argument{argv[index]};
+        if (argument == "--golden")
+            printGolden = true;
+        else
+            filter = argument;
+    }
+
+    BenchmarkTiling();
+    BenchmarkSubrectTiling();
+    BenchmarkMipChains();
+    BenchmarkBcn();
+
+    if (failureCount)
+        std::printf("%zu benchmarks didn't match their golden output\n", failureCount);
+    return failureCount ? 1 : 0;
+}
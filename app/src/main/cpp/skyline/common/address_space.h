@@ -6,7 +6,8 @@
 #include <boost/container/small_vector.hpp>
 #include <concepts>
 #include <common.h>
-#include "segment_table.h"
+#include "function_ref.h"
+#include "radix_page_table.h"
 #include "spin_lock.h"
 
 namespace skyline {
@@ -15,6 +16,8 @@ namespace skyline {
 
     using TranslatedAddressRange = boost::container::small_vector<span<u8>, 1>;
 
+    using CpuAccessCallback = FunctionRef<void(span<u8>)>; //!< A callback which is called with every host region that's accessed by a memory manager operation, this is non-owning so it doesn't need to allocate on every access
+
     struct EmptyStruct {};
 
     /**
@@ -97,7 +100,7 @@ namespace skyline {
         u8 *sparseMap; //!< Pointer to a zero filled memory region that is returned by TranslateRange for sparse mappings
 
         /**
-         * @brief Version of `Block` that is trivial so it can be stored in a segment table for rapid lookups, also holds an additional extent member
+         * @brief Version of `Block` that is trivial so it can be stored in a page table for rapid lookups, also holds an additional extent member
          */
         struct SegmentTableEntry {
             VaType virt;
@@ -107,24 +110,50 @@ namespace skyline {
         };
 
         static constexpr size_t AddressSpaceSize{1ULL << AddressSpaceBits};
-        SegmentTable<SegmentTableEntry, AddressSpaceSize, VaGranularityBits, VaL2GranularityBits> blockSegmentTable; //!< A page table of all buffer mappings for O(1) lookups on full matches
+        RadixPageTable<SegmentTableEntry, AddressSpaceSize, VaGranularityBits, VaL2GranularityBits> blockPageTable; //!< A page table of all mappings for O(1) lock-free lookups on full matches, this mirrors `blocks` which remains authoritative for range operations
 
-        TranslatedAddressRange TranslateRangeImpl(VaType virt, VaType size, std::function<void(span<u8>)> cpuAccessCallback = {});
+        /**
+         * @brief A per-thread cache of recent page translations, this avoids even the page table walk for repeated accesses to the same pages
+         * @note Entries are tagged with the generation they were looked up in and are implicitly invalidated by any Map/Unmap as it bumps `tlbGeneration`
+         */
+        struct TranslationLookasideBuffer {
+            static constexpr size_t EntryCount{16}; //!< The amount of entries in the TLB, it's direct-mapped by VA page
 
-        std::pair<span<u8>, size_t> LookupBlockLocked(VaType virt, std::function<void(span<u8>)> cpuAccessCallback = {}) {
-            const auto &blockEntry{this->blockSegmentTable[virt]};
-            VaType segmentOffset{virt - blockEntry.virt};
+            struct Entry {
+                const FlatMemoryManager *owner; //!< The memory manager this entry was looked up in, the TLB is shared across all instances on a thread
+                u64 generation;
+                VaType page; //!< The VA of the page shifted down by the granularity
+                SegmentTableEntry segment;
+            };
 
-            if (blockEntry.extraInfo.sparseMapped || blockEntry.phys == nullptr)
-                return {span<u8>{static_cast<u8*>(nullptr), blockEntry.extent}, segmentOffset};
+            std::array<Entry, EntryCount> entries{};
+        };
 
-            span<u8> blockSpan{blockEntry.phys, blockEntry.extent};
-            if (cpuAccessCallback)
-                cpuAccessCallback(blockSpan);
+        static inline thread_local TranslationLookasideBuffer tlb;
+        static inline std::atomic<u64> tlbGeneration{1}; //!< Incremented after any change to the page table of any instance, this is global to avoid a new instance at the address of a destroyed one hitting its stale entries
 
-            return {blockSpan, segmentOffset};
+        /**
+         * @return The page table entry for the supplied VA, this is looked up in the TLB first
+         */
+        SegmentTableEntry LookupSegment(VaType virt) {
+            VaType page{virt >> VaGranularityBits};
+            auto &entry{tlb.entries[page % TranslationLookasideBuffer::EntryCount]};
+            u64 generation{tlbGeneration.load(std::memory_order_acquire)}; // This must be loaded prior to the page table walk, so any concurrent update invalidates the entry we insert
+            if (entry.owner == this && entry.page == page && entry.generation == generation) [[likely]]
+                return entry.segment;
+
+            entry = {this, generation, page, blockPageTable[virt]};
+            return entry.segment;
         }
 
+        /**
+         * @brief Republishes the page table entries for all blocks that intersect or directly neighbour the supplied range, as Map/Unmap can truncate the blocks around them
+         * @note blockMutex MUST be locked when calling this
+         */
+        void UpdatePageTableLocked(VaType virt, VaType virtEnd);
+
+        TranslatedAddressRange TranslateRangeImpl(VaType virt, VaType size, CpuAccessCallback cpuAccessCallback = {});
+
       public:
         FlatMemoryManager();
 
@@ -140,39 +169,48 @@ namespace skyline {
         /**
          * @brief Looks up the mapped region that contains the given VA
          * @return A span of the mapped region and the offset of the input VA in the region
+         * @note This is lock-free and doesn't contend with other lookups, a lookup concurrent with a Map/Unmap of the same region will return either the old or new mapping
          */
-        __attribute__((always_inline)) std::pair<span<u8>, VaType> LookupBlock(VaType virt, std::function<void(span<u8>)> cpuAccessCallback = {}) {
-            std::shared_lock lock{this->blockMutex};
-            return LookupBlockLocked(virt, cpuAccessCallback);
+        __attribute__((always_inline)) std::pair<span<u8>, VaType> LookupBlock(VaType virt, CpuAccessCallback cpuAccessCallback = {}) {
+            auto blockEntry{LookupSegment(virt)};
+            VaType segmentOffset{virt - blockEntry.virt};
+
+            if (blockEntry.extraInfo.sparseMapped || blockEntry.phys == nullptr)
+                return {span<u8>{static_cast<u8*>(nullptr), blockEntry.extent}, segmentOffset};
+
+            span<u8> blockSpan{blockEntry.phys, blockEntry.extent};
+            if (cpuAccessCallback)
+                cpuAccessCallback(blockSpan);
+
+            return {blockSpan, segmentOffset};
         }
 
         /**
          * @brief Translates a region in the VA space to a corresponding set of regions in the PA space
          */
-        TranslatedAddressRange TranslateRange(VaType virt, VaType size, std::function<void(span<u8>)> cpuAccessCallback = {}) {
-            std::shared_lock lock{this->blockMutex};
-
-            // Fast path for when the range is mapped in a single block
-            auto [blockSpan, rangeOffset]{LookupBlockLocked(virt, cpuAccessCallback)};
+        TranslatedAddressRange TranslateRange(VaType virt, VaType size, CpuAccessCallback cpuAccessCallback = {}) {
+            // Fast path for when the range is mapped in a single block, this doesn't require locking
+            auto [blockSpan, rangeOffset]{LookupBlock(virt, cpuAccessCallback)};
             if (blockSpan.size() - rangeOffset >= size) {
                 TranslatedAddressRange ranges;
                 ranges.push_back(blockSpan.subspan(blockSpan.valid() ? rangeOffset : 0, size));
                 return ranges;
             }
 
+            std::shared_lock lock{this->blockMutex};
             return TranslateRangeImpl(virt, size, cpuAccessCallback);
         }
 
 
-        void Read(u8 *destination, VaType virt, VaType size, std::function<void(span<u8>)> cpuAccessCallback = {});
+        void Read(u8 *destination, VaType virt, VaType size, CpuAccessCallback cpuAccessCallback = {});
 
         template<typename T>
-        void Read(span <T> destination, VaType virt, std::function<void(span<u8>)> cpuAccessCallback = {}) {
+        void Read(span <T> destination, VaType virt, CpuAccessCallback cpuAccessCallback = {}) {
             Read(reinterpret_cast<u8 *>(destination.data()), virt, destination.size_bytes(), cpuAccessCallback);
         }
 
         template<typename T>
-        T Read(VaType virt, std::function<void(span<u8>)> cpuAccessCallback = {}) {
+        T Read(VaType virt, CpuAccessCallback cpuAccessCallback = {}) {
             T obj;
             Read(reinterpret_cast<u8 *>(&obj), virt, sizeof(T), cpuAccessCallback);
             return obj;
@@ -186,7 +224,7 @@ namespace skyline {
          * @note The function will provide no feedback on if the end has been reached or if there was an early exit
          */
         template<typename Function, typename Container>
-        span<u8> ReadTill(Container& destination, VaType virt, Function function, std::function<void(span<u8>)> cpuAccessCallback = {}) {
+        span<u8> ReadTill(Container& destination, VaType virt, Function function, CpuAccessCallback cpuAccessCallback = {}) {
             //TRACE_EVENT("containers", "FlatMemoryManager::ReadTill");
 
             std::shared_lock lock(this->blockMutex);
@@ -234,29 +272,29 @@ namespace skyline {
             return {destination.data(), destination.size()};
         }
 
-        void Write(VaType virt, u8 *source, VaType size, std::function<void(span<u8>)> cpuAccessCallback = {});
+        void Write(VaType virt, u8 *source, VaType size, CpuAccessCallback cpuAccessCallback = {});
 
         template<typename T>
-        void Write(VaType virt, span<T> source, std::function<void(span<u8>)> cpuAccessCallback = {}) {
-            Write(virt, reinterpret_cast<u8 *>(source.data()), source.size_bytes());
+        void Write(VaType virt, span<T> source, CpuAccessCallback cpuAccessCallback = {}) {
+            Write(virt, reinterpret_cast<u8 *>(source.data()), source.size_bytes(), cpuAccessCallback);
         }
 
-        void Write(VaType virt, util::TrivialObject auto source, std::function<void(span<u8>)> cpuAccessCallback = {}) {
+        void Write(VaType virt, util::TrivialObject auto source, CpuAccessCallback cpuAccessCallback = {}) {
             Write(virt, reinterpret_cast<u8 *>(&source), sizeof(source), cpuAccessCallback);
         }
 
-        void Copy(VaType dst, VaType src, VaType size, std::function<void(span<u8>)> cpuAccessCallback = {});
+        void Copy(VaType dst, VaType src, VaType size, CpuAccessCallback cpuAccessCallback = {});
 
         void Map(VaType virt, u8 *phys, VaType size, MemoryManagerBlockInfo extraInfo = {}) {
             std::scoped_lock lock(this->blockMutex);
-            blockSegmentTable.Set(virt, virt + size, {virt, phys, size, extraInfo});
             this->MapLocked(virt, phys, size, extraInfo);
+            UpdatePageTableLocked(virt, virt + size);
         }
 
         void Unmap(VaType virt, VaType size) {
             std::scoped_lock lock(this->blockMutex);
-            blockSegmentTable.Set(virt, virt + size, {});
             this->UnmapLocked(virt, size);
+            UpdatePageTableLocked(virt, virt + size);
         }
     };
 
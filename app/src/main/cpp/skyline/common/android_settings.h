@@ -49,14 +49,17 @@ namespace skyline {
             forceMaxGpuClocks = ktSettings.GetBool("forceMaxGpuClocks");
             useAsyncShaders = ktSettings.GetBool("useAsyncShaders");
             disableShaderCache = ktSettings.GetBool("disableShaderCache");
+            lazyPipelineLoading = ktSettings.GetBool("lazyPipelineLoading");
             enableSampleShading = ktSettings.GetBool("enableSampleShading");
             freeGuestTextureMemory = ktSettings.GetBool("freeGuestTextureMemory");
+            useGpuTextureDecoding = ktSettings.GetBool("useGpuTextureDecoding");
             enableFastGpuReadbackHack = ktSettings.GetBool("enableFastGpuReadbackHack");
             enableFastReadbackWrites = ktSettings.GetBool("enableFastReadbackWrites");
             disableSubgroupShuffle = ktSettings.GetBool("disableSubgroupShuffle");
             enableJitFastmem = ktSettings.GetBool("enableJitFastmem"); 
             logLevel = ktSettings.GetInt<skyline::AsyncLogger::LogLevel>("logLevel");
             validationLayer = ktSettings.GetBool("validationLayer");
+            logMacroStatistics = ktSettings.GetBool("logMacroStatistics");
         };
     };
 }
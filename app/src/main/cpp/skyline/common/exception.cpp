@@ -7,8 +7,7 @@
 namespace skyline {
     std::vector<void *> exception::GetStackFrames() {
         std::vector<void*> frames;
-        signal::StackFrame *frame{};
-        asm("MOV %0, FP" : "=r"(frame));
+        auto frame{static_cast<signal::StackFrame *>(__builtin_frame_address(0))}; // Frame records on x86-64 share the layout of AArch64 frame records, allowing this to be used in host-built tools
         if (frame)
             frame = frame->next; // We want to skip the first frame as it's going to be the caller of this function
         while (frame && frame->lr) {
@@ -0,0 +1,46 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2024 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include <concepts>
+#include <functional>
+#include <memory>
+#include <type_traits>
+
+namespace skyline {
+    template<typename Signature>
+    class FunctionRef;
+
+    /**
+     * @brief A non-owning reference to a callable object, unlike std::function this never allocates and is trivially copyable so it's suitable for passing callbacks on hot paths
+     * @note The referenced callable must outlive the FunctionRef, it should only be used for parameters and never be stored
+     */
+    template<typename ReturnType, typename... Args>
+    class FunctionRef<ReturnType(Args...)> {
+      private:
+        void *callable{}; //!< A type-erased pointer to the callable object
+        ReturnType (*invoker)(void *, Args...){}; //!< A function which casts `callable` back to its original type and invokes it, this is nullptr for an empty FunctionRef
+
+      public:
+        constexpr FunctionRef() = default;
+
+        constexpr FunctionRef(std::nullptr_t) {}
+
+        template<typename Callable> requires (!std::same_as<std::remove_cvref_t<Callable>, FunctionRef> && std::is_invocable_r_v<ReturnType, Callable &, Args...>)
+        FunctionRef(Callable &&callable) : callable{const_cast<void *>(static_cast<const void *>(std::addressof(callable)))}, invoker{[](void *callable, Args... args) -> ReturnType {
+            return std::invoke(*static_cast<std::remove_reference_t<Callable> *>(callable), std::forward<Args>(args)...);
+        }} {}
+
+        ReturnType operator()(Args... args) const {
+            return invoker(callable, std::forward<Args>(args)...);
+        }
+
+        /**
+         * @return If this references a callable object
+         */
+        constexpr explicit operator bool() const {
+            return invoker != nullptr;
+        }
+    };
+}
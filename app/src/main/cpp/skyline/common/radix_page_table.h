@@ -0,0 +1,250 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2024 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include <sys/mman.h>
+#include <atomic>
+#include <memory>
+#include <unordered_map>
+#include "span.h"
+
+namespace skyline {
+    /**
+     * @brief A two-level radix page table which supports lock-free lookups concurrently with updates, the upper level is indexed at L2 granularity and its entries can either directly hold a segment (a large leaf) or point to a lower level table at L1 granularity
+     * @tparam SegmentType The type of segment stored in the table, this must be trivially copyable as it's copied in and out of the table word-by-word; a 0'd out segment is returned for unset entries
+     * @tparam Size The size of the table in terms of units, this represents size in bytes for a page table covering an address space
+     * @tparam L1Bits The size of an L1 page as a power of 2, this determines the minimum granularity of the table
+     * @tparam L2Bits The size of an L2 page as a power of 2, this should be higher than L1Bits and will determine the maximum granularity of the table
+     * @tparam MaxSegments The maximum amount of distinct segments that can be present in the table at once
+     * @note Updates are RCU-style: segments are written into a slot which is only then published into the table, slots that are no longer referenced are recycled with a new generation so readers can detect and retry on a concurrently recycled slot
+     * @note Lookups are thread-safe and lock-free, while all updates (Set/Clear) **MUST** be externally synchronized with respect to each other
+     */
+    template<typename SegmentType, size_t Size, size_t L1Bits, size_t L2Bits, size_t MaxSegments = 1 << 20> requires std::is_trivially_copyable_v<SegmentType>
+    class RadixPageTable {
+      private:
+        static constexpr size_t L1Size{1ULL << L1Bits}, L2Size{1ULL << L2Bits}, L1inL2Count{L2Size / L1Size}, L2Entries{util::DivideCeil(Size, L2Size)};
+        static_assert(L2Bits > L1Bits, "L2 pages must be larger than L1 pages");
+
+        /**
+         * @brief An entry in either level of the table, this is 0 for an unset entry, a pointer to an L1 table tagged with `TableTag` or a handle composed of a slot index and the generation of the slot
+         */
+        using Entry = std::atomic<u64>;
+        static constexpr u64 TableTag{1}; //!< The tag set on upper level entries which point to an L1 table rather than a segment
+
+        using L1Table = std::array<Entry, L1inL2Count>;
+
+        static constexpr size_t SegmentWords{util::DivideCeil(sizeof(SegmentType), sizeof(u64))};
+
+        /**
+         * @brief Storage for a single segment along with the state required to safely recycle it
+         */
+        struct Slot {
+            std::atomic<u32> generation; //!< Incremented every time the slot is reused, readers compare this against the generation in their handle before and after copying the segment
+            u32 references; //!< The amount of table entries which refer to this slot, this is only accessed by the updating thread
+            std::array<std::atomic<u64>, SegmentWords> words; //!< The segment, split into atomically accessible words
+        };
+
+        span<Entry, L2Entries> level2Table;
+        std::unordered_map<size_t, std::unique_ptr<L1Table>> level1Tables; //!< All L1 tables that have been allocated keyed by their L2 index, these are never freed as readers may still be traversing them after being detached but are reused when the same L2 page is split again
+        span<Slot, MaxSegments> slots; //!< Slot 0 is reserved so a handle is never 0
+        u32 nextSlot{1}; //!< The index of the next never-used slot
+        std::vector<u32> freeSlots; //!< Indices of slots that are no longer referenced by any entry
+
+        template<typename Type, size_t Amount>
+        static span<Type, Amount> AllocateTable() {
+            void *ptr{mmap(nullptr, Amount * sizeof(Type), PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE | MAP_NORESERVE, -1, 0)};
+            if (ptr == MAP_FAILED)
+                throw exception{"Failed to allocate 0x{:X} bytes of memory for radix page table: {}", Amount * sizeof(Type), strerror(errno)};
+            return span<Type, Amount>(static_cast<Type *>(ptr), Amount);
+        }
+
+        static constexpr u64 MakeHandle(u32 index, u32 generation) {
+            return (static_cast<u64>(generation) << 32) | (static_cast<u64>(index) << 1);
+        }
+
+        static constexpr u32 HandleIndex(u64 handle) {
+            return static_cast<u32>(handle) >> 1;
+        }
+
+        static constexpr u32 HandleGeneration(u64 handle) {
+            return static_cast<u32>(handle >> 32);
+        }
+
+        static L1Table *HandleTable(u64 handle) {
+            return reinterpret_cast<L1Table *>(handle & ~TableTag);
+        }
+
+        /**
+         * @brief Writes the segment into a free slot, the slot is not referenced by any entry until it's published with `Replace`
+         * @return A handle to the slot
+         */
+        u64 AllocateSlot(const SegmentType &segment) {
+            u32 index;
+            if (!freeSlots.empty()) {
+                index = freeSlots.back();
+                freeSlots.pop_back();
+            } else if (nextSlot < MaxSegments) {
+                index = nextSlot++;
+            } else {
+                throw exception("Radix page table ran out of segment slots: {}", MaxSegments);
+            }
+
+            auto &slot{slots[index]};
+            u32 generation{slot.generation.load(std::memory_order_relaxed) + 1};
+            slot.generation.store(generation, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release); // Any reader that observes the new words must also observe the new generation
+
+            std::array<u64, SegmentWords> words{};
+            std::memcpy(words.data(), &segment, sizeof(SegmentType));
+            for (size_t i{}; i < SegmentWords; i++)
+                slot.words[i].store(words[i], std::memory_order_relaxed);
+
+            slot.references = 0;
+            return MakeHandle(index, generation);
+        }
+
+        void Retain(u64 handle) {
+            if (handle)
+                slots[HandleIndex(handle)].references++;
+        }
+
+        void Release(u64 handle) {
+            if (!handle)
+                return;
+
+            u32 index{HandleIndex(handle)};
+            if (--slots[index].references == 0)
+                freeSlots.push_back(index);
+        }
+
+        /**
+         * @brief Publishes a handle into a leaf entry, releasing the segment that was previously referenced by it
+         */
+        void Replace(Entry &entry, u64 handle) {
+            u64 oldHandle{entry.load(std::memory_order_relaxed)};
+            Retain(handle);
+            entry.store(handle, std::memory_order_release);
+            Release(oldHandle);
+        }
+
+        /**
+         * @brief Releases all references held by an L2 entry without modifying it
+         */
+        void ReleaseL2Entry(u64 handle) {
+            if (handle & TableTag)
+                for (auto &entry : *HandleTable(handle))
+                    Release(entry.load(std::memory_order_relaxed));
+            else
+                Release(handle);
+        }
+
+        /**
+         * @return The L1 table for the supplied L2 entry, splitting a large leaf into an L1 table if necessary
+         */
+        L1Table &SplitL2Entry(size_t l2Index) {
+            auto &l2Entry{level2Table[l2Index]};
+            u64 handle{l2Entry.load(std::memory_order_relaxed)};
+            if (handle & TableTag)
+                return *HandleTable(handle);
+
+            auto &table{level1Tables[l2Index]};
+            if (!table)
+                table = std::make_unique<L1Table>();
+
+            // Any stale handles in a reused table hold no references so they can simply be overwritten, the table is published after it's filled so readers never see them
+            for (auto &entry : *table) {
+                Retain(handle);
+                entry.store(handle, std::memory_order_relaxed);
+            }
+            Release(handle);
+
+            l2Entry.store(reinterpret_cast<u64>(table.get()) | TableTag, std::memory_order_release);
+            return *table;
+        }
+
+        void SetHandle(size_t start, size_t end, u64 handle) {
+            for (size_t l2Index{start >> L2Bits}, l2End{util::DivideCeil(end, L2Size)}; l2Index < l2End; l2Index++) {
+                size_t l2Start{l2Index << L2Bits}, l2EndAddress{l2Start + L2Size};
+                if (start <= l2Start && end >= l2EndAddress) {
+                    // Large leaves can be used for any L2 pages that are entirely covered, detached L1 tables are retained for reuse
+                    auto &l2Entry{level2Table[l2Index]};
+                    u64 oldHandle{l2Entry.load(std::memory_order_relaxed)};
+                    Retain(handle);
+                    l2Entry.store(handle, std::memory_order_release);
+                    ReleaseL2Entry(oldHandle);
+                } else {
+                    auto &table{SplitL2Entry(l2Index)};
+                    size_t l1Start{(std::max(start, l2Start) - l2Start) >> L1Bits}, l1End{util::DivideCeil(std::min(end, l2EndAddress) - l2Start, L1Size)};
+                    for (size_t l1Index{l1Start}; l1Index < l1End; l1Index++)
+                        Replace(table[l1Index], handle);
+                }
+            }
+        }
+
+      public:
+        RadixPageTable() : level2Table{AllocateTable<Entry, L2Entries>()}, slots{AllocateTable<Slot, MaxSegments>()} {}
+
+        RadixPageTable(const RadixPageTable &) = delete;
+
+        RadixPageTable &operator=(const RadixPageTable &) = delete;
+
+        ~RadixPageTable() {
+            munmap(level2Table.data(), level2Table.size_bytes());
+            munmap(slots.data(), slots.size_bytes());
+        }
+
+        /**
+         * @return A copy of the segment at the given index, this'll return a 0'd out segment if the segment is unset
+         * @note This is lock-free and may be called concurrently with updates, in which case either the old or new segment is returned
+         */
+        SegmentType operator[](size_t index) const {
+            while (true) {
+                u64 handle{level2Table[index >> L2Bits].load(std::memory_order_acquire)};
+                if (handle & TableTag)
+                    handle = (*HandleTable(handle))[(index >> L1Bits) & (L1inL2Count - 1)].load(std::memory_order_acquire);
+
+                if (!handle)
+                    return SegmentType{};
+
+                const auto &slot{slots[HandleIndex(handle)]};
+                u32 generation{HandleGeneration(handle)};
+                if (slot.generation.load(std::memory_order_acquire) != generation) [[unlikely]]
+                    continue; // The slot was recycled after we loaded the handle, the entry must've been updated so retry from the top
+
+                std::array<u64, SegmentWords> words;
+                for (size_t i{}; i < SegmentWords; i++)
+                    words[i] = slot.words[i].load(std::memory_order_relaxed);
+
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (slot.generation.load(std::memory_order_relaxed) != generation) [[unlikely]]
+                    continue;
+
+                SegmentType segment;
+                std::memcpy(&segment, words.data(), sizeof(SegmentType));
+                return segment;
+            }
+        }
+
+        /**
+         * @brief Sets all L1 pages between the start and end to the supplied segment
+         */
+        void Set(size_t start, size_t end, const SegmentType &segment) {
+            if (start >= end)
+                return;
+
+            u64 handle{AllocateSlot(segment)};
+            Retain(handle); // Hold a reference for the duration of the update so the slot can't be recycled before it's been published
+            SetHandle(start, end, handle);
+            Release(handle);
+        }
+
+        /**
+         * @brief Unsets all L1 pages between the start and end
+         */
+        void Clear(size_t start, size_t end) {
+            if (start < end)
+                SetHandle(start, end, 0);
+        }
+    };
+}
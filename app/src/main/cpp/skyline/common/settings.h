@@ -75,6 +75,7 @@ namespace skyline {
         Setting<int> vsyncMode;
         Setting<bool> useAsyncShaders;
         Setting<bool> disableShaderCache;  //!< Prevents cached shaders from being loaded and disables caching of new shaders
+        Setting<bool> lazyPipelineLoading; //!< If cached pipelines should be compiled in the background after boot rather than all being compiled while the loading screen is shown
 
         // CPU
         Setting<bool> enableJitFastmem;
@@ -87,6 +88,7 @@ namespace skyline {
         Setting<bool> useDirectMemoryImport; //!< If buffer emulation should be done by importing guest buffer mappings
         Setting<bool> forceMaxGpuClocks; //!< If the GPU should be forced to run at maximum clocks
         Setting<bool> freeGuestTextureMemory; //!< If guest textrue memory should be freed when the owning texture is GPU dirty
+        Setting<bool> useGpuTextureDecoding; //!< If guest textures should be deswizzled and decoded on the GPU when supported for their format
         Setting<bool> enableSampleShading;
 
         // Hacks
@@ -100,6 +102,7 @@ namespace skyline {
         // Debug
         Setting<AsyncLogger::LogLevel> logLevel; //!< The log level
         Setting<bool> validationLayer; //!< If the vulkan validation layer is enabled
+        Setting<bool> logMacroStatistics; //!< If per-macro execution statistics should be collected and logged when a GPU channel is destroyed
 
         Settings() = default;
 
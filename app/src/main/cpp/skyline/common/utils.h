@@ -6,9 +6,12 @@
 #include <algorithm>
 #include <random>
 #include <span>
+#include <chrono>
 #include <frozen/unordered_map.h>
 #include <frozen/string.h>
+#ifdef __ANDROID__
 #include <sys/system_properties.h>
+#endif
 #include <type_traits>
 #include <xxhash.h>
 #include "base.h"
@@ -25,8 +28,10 @@ namespace skyline::util {
         /**
          * @brief Retrieves the system counter clock frequency
          * @note Some devices report an incorrect value so they need special handling
+         * @note Hosts other than AArch64 (such as for host-built tools) use the steady clock as the system counter
          */
         inline u64 InitFrequency() {
+            #if defined(__ANDROID__) && defined(__aarch64__)
             char buffer[PROP_VALUE_MAX];
             int len{__system_property_get("ro.product.board", buffer)};
             std::string_view board{buffer, static_cast<size_t>(len)};
@@ -44,6 +49,26 @@ namespace skyline::util {
                 asm volatile("MRS %0, CNTFRQ_EL0" : "=r"(frequency));
 
             return frequency;
+            #elif defined(__aarch64__)
+            u64 frequency;
+            asm volatile("MRS %0, CNTFRQ_EL0" : "=r"(frequency));
+            return frequency;
+            #else
+            return static_cast<u64>(std::chrono::steady_clock::period::den / std::chrono::steady_clock::period::num);
+            #endif
+        }
+
+        /**
+         * @return The current value of the system counter
+         */
+        inline u64 GetTicks() {
+            #if defined(__aarch64__)
+            u64 ticks;
+            asm volatile("MRS %0, CNTVCT_EL0" : "=r"(ticks));
+            return ticks;
+            #else
+            return static_cast<u64>(std::chrono::steady_clock::now().time_since_epoch().count());
+            #endif
         }
     }
 
@@ -52,8 +77,7 @@ namespace skyline::util {
     template<i64 TargetFrequency>
     inline i64 GetTimeScaled() {
         u64 frequency{ClockFrequency};
-        u64 ticks;
-        asm volatile("MRS %0, CNTVCT_EL0" : "=r"(ticks));
+        u64 ticks{detail::GetTicks()};
         return static_cast<i64>(((ticks / frequency) * TargetFrequency) + (((ticks % frequency) * TargetFrequency + (frequency / 2)) / frequency));
     }
     /**
@@ -240,7 +240,8 @@ namespace skyline::gpu {
             vk::PhysicalDeviceIndexTypeUint8FeaturesEXT,
             vk::PhysicalDeviceExtendedDynamicStateFeaturesEXT,
             vk::PhysicalDeviceRobustness2FeaturesEXT,
-            vk::PhysicalDeviceSynchronization2Features>()};
+            vk::PhysicalDeviceSynchronization2Features,
+            vk::PhysicalDeviceMultiDrawFeaturesEXT>()};
         decltype(deviceFeatures2) enabledFeatures2{}; // We only want to enable features we required due to potential overhead from unused features
 
         #define FEAT_REQ(structName, feature)                                            \
@@ -368,9 +369,12 @@ namespace skyline::gpu {
         shader.emplace(state, *this,
                        state.os->publicAppFilesPath + "shader_replacements/" + titleId,
                        state.os->publicAppFilesPath + "shader_dumps/" + titleId);
-        if (!*state.settings->disableShaderCache)
+        if (!*state.settings->disableShaderCache) {
             graphicsPipelineCacheManager.emplace(state,
                                                  state.os->publicAppFilesPath + "graphics_pipeline_cache/" + titleId);
+            shaderModuleCacheManager.emplace(state.os->publicAppFilesPath + "shader_module_cache/" + titleId);
+        }
         graphicsPipelineManager.emplace(*this, *state.jvm);
+        decodedTextureCacheManager.emplace(state.os->publicAppFilesPath + "decoded_texture_cache/" + titleId);
     }
 }
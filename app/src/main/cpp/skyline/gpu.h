@@ -9,11 +9,14 @@
 #include "gpu/command_scheduler.h"
 #include "gpu/presentation_engine.h"
 #include "gpu/texture_manager.h"
+#include "gpu/texture/tiling_pool.h"
 #include "gpu/buffer_manager.h"
 #include "gpu/megabuffer.h"
 #include "gpu/descriptor_allocator.h"
 #include "gpu/shader_manager.h"
 #include "gpu/pipeline_cache_manager.h"
+#include "gpu/shader_module_cache_manager.h"
+#include "gpu/decoded_texture_cache_manager.h"
 #include "gpu/graphics_pipeline_assembler.h"
 #include "gpu/shaders/helper_shaders.h"
 #include "gpu/cache/renderpass_cache.h"
@@ -50,6 +53,7 @@ namespace skyline::gpu {
         CommandScheduler scheduler;
         PresentationEngine presentation;
 
+        texture::TilingPool tilingPool; //!< This must be declared prior to (and destroyed after) the texture manager as destroying textures may synchronize them to the guest using the pool
         TextureManager texture;
         BufferManager buffer;
         MegaBufferAllocator megaBufferAllocator;
@@ -65,7 +69,9 @@ namespace skyline::gpu {
 
         std::mutex channelLock;
         std::optional<PipelineCacheManager> graphicsPipelineCacheManager;
+        std::optional<ShaderModuleCacheManager> shaderModuleCacheManager;
         std::optional<interconnect::maxwell3d::PipelineManager> graphicsPipelineManager;
+        std::optional<DecodedTextureCacheManager> decodedTextureCacheManager;
         interconnect::kepler_compute::PipelineManager computePipelineManager;
 
         static constexpr size_t DebugTracingBufferSize{0x80000}; //!< 512KiB
@@ -0,0 +1,283 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2024 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include <fstream>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <lz4.h>
+#include "decoded_texture_cache_manager.h"
+
+namespace skyline::gpu {
+    /*  File format pseudocode:
+        DecodedTextureCacheFileHeader header;
+
+        struct Record {
+            DecodedTextureCacheRecordPrefix prefix;
+            DecodedTextureCacheEntryHeader entryHeader;
+            u8 data[entryHeader.storedSize];
+        } records[]; // Records are only ever appended, the end of the file is determined by the first record that fails validation
+
+        The staging file has the same format, records in it are validated and merged into the main file on the next boot
+    */
+
+    struct DecodedTextureCacheFileHeader {
+        static constexpr u32 Magic{util::MakeMagic<u32>("DTEX")}; //!< The magic value used to identify a decoded texture cache file
+        static constexpr u32 Version{2}; //!< The version of the decoded texture cache file format, MUST be incremented for any format changes (including changes to any decoders)
+
+        u32 magic{Magic};
+        u32 version{Version};
+
+        /**
+         * @brief Checks if the header is valid
+         */
+        bool IsValid() {
+            return magic == Magic && version == Version;
+        }
+    };
+
+    /**
+     * @brief The header of each entry in the cache file, it's immediately followed by the stored data
+     */
+    struct DecodedTextureCacheEntryHeader {
+        DecodedTextureCacheManager::Key key;
+        u32 size; //!< The size of the decoded data
+        u32 storedSize; //!< The size of the stored data, the data is LZ4 compressed if this differs from `size`
+    };
+
+    /**
+     * @brief The prefix of each record in the cache file, this allows validating a record without any other state so records can be committed without updating a header
+     */
+    struct DecodedTextureCacheRecordPrefix {
+        u64 hash; //!< An XXH3 hash of the record data following the prefix, XXH3 is used over XXH64 as all records are rehashed on every boot and textures are far larger than other cached objects
+        u32 size; //!< The size of the record data following the prefix
+        u32 _pad_{};
+    };
+    static_assert(sizeof(DecodedTextureCacheRecordPrefix) == 0x10);
+
+    /**
+     * @return The size of the record at the supplied offset including its prefix, or 0 if it's truncated or corrupted
+     */
+    static size_t ValidateRecord(span<const u8> data, size_t offset) {
+        if (offset + sizeof(DecodedTextureCacheRecordPrefix) > data.size())
+            return 0;
+
+        auto prefix{data.subspan(offset).as<const DecodedTextureCacheRecordPrefix>()};
+        size_t dataOffset{offset + sizeof(DecodedTextureCacheRecordPrefix)};
+        if (prefix.size < sizeof(DecodedTextureCacheEntryHeader) || dataOffset + prefix.size > data.size())
+            return 0;
+
+        auto entryHeader{data.subspan(dataOffset).as<const DecodedTextureCacheEntryHeader>()};
+        if (sizeof(DecodedTextureCacheEntryHeader) + entryHeader.storedSize != prefix.size || entryHeader.storedSize > entryHeader.size || XXH3_64bits(data.data() + dataOffset, prefix.size) != prefix.hash)
+            return 0;
+
+        return sizeof(DecodedTextureCacheRecordPrefix) + prefix.size;
+    }
+
+    u64 DecodedTextureCacheManager::HashKey(const Key &key) {
+        return XXH3_64bits(&key, sizeof(Key));
+    }
+
+    void DecodedTextureCacheManager::Run() {
+        std::ofstream stream{stagingPath, std::ios::binary | std::ios::trunc};
+        DecodedTextureCacheFileHeader header{};
+        stream.write(reinterpret_cast<const char *>(&header), sizeof(DecodedTextureCacheFileHeader));
+        stream.flush();
+
+        std::vector<u8> record; //!< A reusable buffer for the data of each record, the hash in the prefix is calculated over it
+        while (true) {
+            std::unique_lock lock(writeMutex);
+            writeCondition.wait(lock, [this] { return !writeQueue.empty() || stopWriter; });
+            if (stopWriter)
+                return; // Any entries that are still queued are dropped to avoid delaying exiting
+
+            auto batch{std::move(writeQueue)};
+            writeQueue = {};
+            lock.unlock();
+
+            // All entries queued since the last commit are written out together and committed with a single flush, records are self-validating so there's no header to update
+            while (!batch.empty()) {
+                auto &[key, data]{batch.front()};
+
+                // Decoded textures are frequently highly compressible (such as BCn decoded to RGBA8), the data is only stored compressed when it's actually smaller
+                record.resize(sizeof(DecodedTextureCacheEntryHeader) + static_cast<size_t>(LZ4_compressBound(static_cast<int>(data.size()))));
+                auto storedData{record.data() + sizeof(DecodedTextureCacheEntryHeader)};
+                int compressedSize{LZ4_compress_default(reinterpret_cast<const char *>(data.data()), reinterpret_cast<char *>(storedData), static_cast<int>(data.size()), static_cast<int>(record.size() - sizeof(DecodedTextureCacheEntryHeader)))};
+                bool isCompressed{compressedSize > 0 && static_cast<size_t>(compressedSize) < data.size()};
+                if (!isCompressed)
+                    std::memcpy(storedData, data.data(), data.size());
+
+                DecodedTextureCacheEntryHeader entryHeader{
+                    .key = key,
+                    .size = static_cast<u32>(data.size()),
+                    .storedSize = isCompressed ? static_cast<u32>(compressedSize) : static_cast<u32>(data.size()),
+                };
+                std::memcpy(record.data(), &entryHeader, sizeof(DecodedTextureCacheEntryHeader));
+                record.resize(sizeof(DecodedTextureCacheEntryHeader) + entryHeader.storedSize);
+
+                DecodedTextureCacheRecordPrefix prefix{
+                    .hash = XXH3_64bits(record.data(), record.size()),
+                    .size = static_cast<u32>(record.size()),
+                };
+                stream.write(reinterpret_cast<const char *>(&prefix), sizeof(DecodedTextureCacheRecordPrefix));
+                stream.write(reinterpret_cast<const char *>(record.data()), static_cast<std::streamsize>(record.size()));
+                batch.pop();
+            }
+            stream.flush();
+        }
+    }
+
+    void DecodedTextureCacheManager::MergeStaging() {
+        std::ifstream stagingStream{stagingPath, std::ios::binary};
+        if (stagingStream.fail())
+            return; // If the staging file doesn't exist then there's nothing to merge
+
+        DecodedTextureCacheFileHeader stagingHeader{};
+        stagingStream.read(reinterpret_cast<char *>(&stagingHeader), sizeof(DecodedTextureCacheFileHeader));
+        if (stagingStream.fail() || !stagingHeader.IsValid()) {
+            LOGW("Discarding invalid decoded texture cache staging file");
+            return;
+        }
+
+        std::ofstream mainStream{mainPath, std::ios::binary | std::ios::app};
+
+        // Records are validated and merged one at a time as the staging file can be far too large to be read in at once
+        std::vector<u8> record;
+        size_t offset{sizeof(DecodedTextureCacheFileHeader)};
+        while (true) {
+            record.resize(sizeof(DecodedTextureCacheRecordPrefix));
+            if (!stagingStream.read(reinterpret_cast<char *>(record.data()), sizeof(DecodedTextureCacheRecordPrefix)))
+                break;
+
+            // The size is bounded prior to reading the record to avoid a huge allocation if the prefix is corrupted
+            u32 recordDataSize{span(record).as<DecodedTextureCacheRecordPrefix>().size};
+            if (recordDataSize > sizeof(DecodedTextureCacheEntryHeader) + MaxCacheSize) {
+                LOGW("Discarding invalid decoded texture cache staging records at 0x{:X}", offset);
+                break;
+            }
+
+            record.resize(sizeof(DecodedTextureCacheRecordPrefix) + recordDataSize);
+            stagingStream.read(reinterpret_cast<char *>(record.data() + sizeof(DecodedTextureCacheRecordPrefix)), recordDataSize);
+
+            // This occurs when the emulator exits while a batch is being written, only the records prior to that are merged
+            if (stagingStream.fail() || !ValidateRecord(record, 0)) {
+                LOGW("Discarding invalid decoded texture cache staging records at 0x{:X}", offset);
+                break;
+            }
+
+            mainStream.write(reinterpret_cast<const char *>(record.data()), static_cast<std::streamsize>(record.size()));
+            offset += record.size();
+        }
+    }
+
+    void DecodedTextureCacheManager::LoadMain() {
+        int fd{open(mainPath.c_str(), O_RDONLY | O_CLOEXEC)};
+        if (fd < 0)
+            throw exception("Failed to open decoded texture cache: {}", strerror(errno));
+
+        size_t size{static_cast<size_t>(lseek(fd, 0, SEEK_END))};
+        auto pointer{static_cast<u8 *>(mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0))};
+        close(fd); // The mapping holds a reference to the file
+        if (pointer == MAP_FAILED) [[unlikely]]
+            throw exception("Failed to map decoded texture cache: {}", strerror(errno));
+        mapping = span<u8>{pointer, size};
+
+        size_t offset{sizeof(DecodedTextureCacheFileHeader)}; //!< The offset of the end of the last valid record
+        while (size_t recordSize{ValidateRecord(mapping, offset)}) {
+            size_t entryOffset{offset + sizeof(DecodedTextureCacheRecordPrefix)};
+            auto entryHeader{mapping.subspan(entryOffset).as<DecodedTextureCacheEntryHeader>()};
+            size_t dataOffset{entryOffset + sizeof(DecodedTextureCacheEntryHeader)};
+            entries.try_emplace(HashKey(entryHeader.key), Entry{entryHeader.key, mapping.subspan(dataOffset, entryHeader.storedSize), entryHeader.size});
+            offset += recordSize;
+        }
+
+        if (offset != mapping.size()) {
+            // This occurs when the emulator exits while records are being merged, only the records prior to the first invalid one are kept and any data after them is truncated
+            LOGW("Discarding invalid decoded texture cache records at 0x{:X}", offset);
+            std::filesystem::resize_file(mainPath, offset); // The mapping past the end of the file is never accessed as it's not referenced by any entries
+        }
+
+        cacheSize = offset;
+    }
+
+    DecodedTextureCacheManager::DecodedTextureCacheManager(const std::string &path)
+        : stagingPath{path + ".staging"}, mainPath{path} {
+        bool didExist{std::filesystem::exists(mainPath)};
+        if (didExist) { // If the main file exists then we need to validate it
+            std::ifstream mainStream{mainPath, std::ios::binary};
+            DecodedTextureCacheFileHeader header{};
+            mainStream.read(reinterpret_cast<char *>(&header), sizeof(DecodedTextureCacheFileHeader));
+            if (mainStream.fail() || !header.IsValid()) { // Force a recreation of the file if it's invalid, this also occurs when the decoders are changed
+                LOGW("Discarding invalid decoded texture cache main file");
+                std::filesystem::remove(mainPath);
+                didExist = false;
+            }
+        }
+
+        if (!didExist) { // If the main file didn't exist we need to write the header
+            std::filesystem::create_directories(std::filesystem::path{mainPath}.parent_path());
+            std::ofstream mainStream{mainPath, std::ios::binary | std::ios::app};
+            DecodedTextureCacheFileHeader header{};
+            mainStream.write(reinterpret_cast<const char *>(&header), sizeof(DecodedTextureCacheFileHeader));
+        }
+
+        // Merge any staging changes into the main file before mapping it and starting the writer thread
+        MergeStaging();
+        LoadMain();
+        writerThread = std::thread(&DecodedTextureCacheManager::Run, this);
+    }
+
+    DecodedTextureCacheManager::~DecodedTextureCacheManager() {
+        {
+            std::scoped_lock lock{writeMutex};
+            stopWriter = true;
+            writeCondition.notify_one();
+        }
+        writerThread.join();
+
+        if (mapping.valid())
+            munmap(mapping.data(), mapping.size());
+    }
+
+    DecodedTextureCacheManager::Key DecodedTextureCacheManager::MakeKey(const GuestTexture &guest, texture::Format hostFormat, u32 levelCount, span<const u8> data) {
+        return Key{
+            .dataHash = XXH3_64bits(data.data(), data.size()),
+            .guestFormat = guest.format->vkFormat,
+            .hostFormat = hostFormat->vkFormat,
+            .dimensions = guest.dimensions,
+            .tileMode = guest.tileConfig.mode,
+            .tileParameter = guest.tileConfig.mode == texture::TileMode::Block ? static_cast<u32>(guest.tileConfig.blockHeight | (guest.tileConfig.blockDepth << 8)) : (guest.tileConfig.mode == texture::TileMode::Pitch ? guest.tileConfig.pitch : 0),
+            .levelCount = levelCount,
+            .layerCount = guest.layerCount,
+        };
+    }
+
+    bool DecodedTextureCacheManager::Lookup(const Key &key, span<u8> output) {
+        auto it{entries.find(HashKey(key))};
+        if (it == entries.end() || it->second.key != key || it->second.size != output.size())
+            return false;
+
+        const auto &entry{it->second};
+        if (entry.data.size() == entry.size) {
+            output.copy_from(entry.data);
+            return true;
+        }
+
+        int decompressedSize{LZ4_decompress_safe(reinterpret_cast<const char *>(entry.data.data()), reinterpret_cast<char *>(output.data()), static_cast<int>(entry.data.size()), static_cast<int>(output.size()))};
+        return decompressedSize == static_cast<int>(output.size());
+    }
+
+    void DecodedTextureCacheManager::QueueWrite(const Key &key, span<const u8> data) {
+        u64 hash{HashKey(key)};
+        if (entries.contains(hash))
+            return;
+
+        std::scoped_lock lock{writeMutex};
+        if (cacheSize + data.size() > MaxCacheSize || !queuedKeys.insert(hash).second)
+            return;
+
+        cacheSize += data.size(); // This is an upper bound as the data may be compressed
+        writeQueue.emplace(key, std::vector<u8>(data.begin(), data.end()));
+        writeCondition.notify_one();
+    }
+}
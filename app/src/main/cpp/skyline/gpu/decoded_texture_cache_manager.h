@@ -0,0 +1,102 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2024 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include <queue>
+#include <unordered_set>
+#include <common.h>
+#include "texture/texture.h"
+
+namespace skyline::gpu {
+    /**
+     * @brief Manages a persistent cache of guest textures decoded into their host format, this avoids redoing expensive decodes (such as ASTC or BC7 on the CPU) on every boot
+     * @note The main cache file is memory-mapped on construction while new entries are written to a staging file by a writer thread, they're only available for lookup after being merged into the main file on the next boot
+     */
+    class DecodedTextureCacheManager {
+      public:
+        /**
+         * @brief All properties of a guest texture which determine the contents of the decoded texture
+         */
+        struct Key {
+            u64 dataHash; //!< An XXH3 hash of the guest texture data
+            vk::Format guestFormat;
+            vk::Format hostFormat;
+            texture::Dimensions dimensions;
+            texture::TileMode tileMode;
+            u32 tileParameter; //!< The block height and depth in GOBs for block-linear textures or the pitch for pitch-linear textures
+            u32 levelCount;
+            u32 layerCount;
+            u32 _pad_{};
+
+            bool operator==(const Key &) const = default;
+        };
+        static_assert(std::has_unique_object_representations_v<Key>, "Key is hashed and serialised as raw bytes and must not contain any implicit padding");
+
+      private:
+        static constexpr size_t MaxCacheSize{0x40000000}; //!< The maximum size of the cache files in bytes, no new entries are written once this is exceeded
+        static constexpr size_t MinimumEntrySize{0x10000}; //!< The minimum size of a decoded texture in bytes to be cached, smaller textures are cheap enough to decode that the cache isn't beneficial
+
+        /**
+         * @brief The location of the data for a cache entry in the memory-mapped main file
+         */
+        struct Entry {
+            Key key;
+            span<const u8> data; //!< The stored data, this is LZ4 compressed if its size differs from `size`
+            u32 size; //!< The size of the decoded data
+        };
+
+        std::string stagingPath; //!< The path to the staging cache file, which will be actively written to at runtime
+        std::string mainPath; //!< The path to the main cache file
+        span<u8> mapping; //!< A read-only mapping of the main cache file
+        std::unordered_map<u64, Entry> entries; //!< A map from the hash of a key to its entry, this is immutable after construction
+        size_t cacheSize{}; //!< The total size of the cache files in bytes
+
+        std::thread writerThread;
+        std::queue<std::pair<Key, std::vector<u8>>> writeQueue; //!< The queue of decoded textures to be written to the cache
+        std::unordered_set<u64> queuedKeys; //!< Hashes of all keys that have been queued for writing during this run, used to avoid duplicate entries
+        std::mutex writeMutex; //!< Protects access to the write queue
+        std::condition_variable writeCondition; //!< Notifies the writer thread when the write queue is not empty
+        bool stopWriter{}; //!< If the writer thread should exit, this is protected by `writeMutex`
+
+        void Run();
+
+        void MergeStaging();
+
+        /**
+         * @brief Maps the main cache file and indexes all records in it, the file is truncated at the first record which fails validation
+         */
+        void LoadMain();
+
+        static u64 HashKey(const Key &key);
+
+      public:
+        DecodedTextureCacheManager(const std::string &path);
+
+        ~DecodedTextureCacheManager();
+
+        /**
+         * @return A key for the supplied guest texture when decoded into the supplied host format
+         * @param data The guest texture data, this is hashed so the key must be created after the texture has been synchronized
+         */
+        static Key MakeKey(const GuestTexture &guest, texture::Format hostFormat, u32 levelCount, span<const u8> data);
+
+        /**
+         * @return If a texture with a decoded size of `size` should be cached, this is used to skip hashing textures that will never be cached
+         */
+        static constexpr bool ShouldCache(size_t size) {
+            return size >= MinimumEntrySize;
+        }
+
+        /**
+         * @brief Copies the decoded texture corresponding to the key into the output buffer if it's present in the cache
+         * @return If the output buffer was filled with the decoded texture
+         */
+        bool Lookup(const Key &key, span<u8> output);
+
+        /**
+         * @brief Queues a decoded texture to be written to the cache, this is a no-op if it's already cached or the cache is full
+         */
+        void QueueWrite(const Key &key, span<const u8> data);
+    };
+}
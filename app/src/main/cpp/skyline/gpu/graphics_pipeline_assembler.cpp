@@ -213,16 +213,19 @@ namespace skyline::gpu {
             for (auto &shaderStage : pipelineDescIt->shaderStages)
                 (*gpu.vkDevice).destroyShaderModule(shaderStage.module, nullptr,  *gpu.vkDevice.getDispatcher());
 
+        ReleasePendingDescription(pipelineDescIt);
+        return pipeline;
+    }
+
+    void GraphicsPipelineAssembler::ReleasePendingDescription(std::list<PipelineDescription>::iterator pipelineDescIt) {
         std::scoped_lock lock{mutex};
         compilePendingDescs.erase(pipelineDescIt);
         if (compilationCallback)
             compilationCallback();
-
-        return pipeline;
     }
 
 
-    GraphicsPipelineAssembler::CompiledPipeline GraphicsPipelineAssembler::AssemblePipelineAsync(const PipelineState &state, span<const vk::DescriptorSetLayoutBinding> layoutBindings, span<const vk::PushConstantRange> pushConstantRanges, bool noPushDescriptors) {
+    GraphicsPipelineAssembler::CompiledPipeline GraphicsPipelineAssembler::AssemblePipelineAsync(const PipelineState &state, span<const vk::DescriptorSetLayoutBinding> layoutBindings, span<const vk::PushConstantRange> pushConstantRanges, bool noPushDescriptors, ShaderStageCompiler compileShaders) {
         vk::raii::DescriptorSetLayout descriptorSetLayout{gpu.vkDevice, vk::DescriptorSetLayoutCreateInfo{
             .flags = vk::DescriptorSetLayoutCreateFlags{(!noPushDescriptors && gpu.traits.supportsPushDescriptors) ? vk::DescriptorSetLayoutCreateFlagBits::ePushDescriptorKHR : vk::DescriptorSetLayoutCreateFlags{}},
             .pBindings = layoutBindings.data(),
@@ -245,7 +248,24 @@ namespace skyline::gpu {
         vk::PipelineLayout pipelineLayoutHandle = *pipelineLayout;
 
         auto pipelineFuture = pool.submit_task(
-            [this, descIt, pipelineLayoutHandle]() -> vk::raii::Pipeline {
+            [this, descIt, pipelineLayoutHandle, compileShaders = std::move(compileShaders)]() -> vk::raii::Pipeline {
+                // Shaders are compiled on the same worker as the pipeline so the pipeline only becomes ready once both are done
+                if (compileShaders) {
+                    try {
+                        compileShaders(descIt->shaderStages);
+                    } catch (const std::exception &e) {
+                        // The description must still be released so waiters aren't blocked on it, the exception is then stored in the future and rethrown on first use of the pipeline
+                        LOGE("Failed to compile pipeline shaders: {}", e.what());
+                        if (descIt->destroyShaderModules)
+                            for (auto &shaderStage : descIt->shaderStages)
+                                if (shaderStage.module)
+                                    (*gpu.vkDevice).destroyShaderModule(shaderStage.module, nullptr, *gpu.vkDevice.getDispatcher());
+
+                        ReleasePendingDescription(descIt);
+                        throw;
+                    }
+                }
+
                 return AssemblePipeline(descIt, pipelineLayoutHandle);
             }
         );
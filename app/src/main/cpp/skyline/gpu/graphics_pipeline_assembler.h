@@ -126,9 +126,16 @@ namespace skyline::gpu {
          */
         vk::raii::Pipeline AssemblePipeline(std::list<PipelineDescription>::iterator pipelineDescIt, vk::PipelineLayout pipelineLayout);
 
+        /**
+         * @brief Removes a description from the pending list and notifies the compilation callback, this must be called exactly once for every description regardless of whether compilation succeeded
+         */
+        void ReleasePendingDescription(std::list<PipelineDescription>::iterator pipelineDescIt);
+
       public:
         GraphicsPipelineAssembler(GPU &gpu, std::string_view pipelineCacheDir);
 
+        using ShaderStageCompiler = std::function<void(span<vk::PipelineShaderStageCreateInfo> shaderStages)>; //!< A function which fills in the modules of all shader stages in a pipeline
+
         struct CompiledPipeline {
             vk::raii::DescriptorSetLayout descriptorSetLayout;
             vk::raii::PipelineLayout pipelineLayout;
@@ -142,14 +149,22 @@ namespace skyline::gpu {
                 : descriptorSetLayout{std::move(descriptorSetLayout)},
                   pipelineLayout{std::move(pipelineLayout)},
                   pipeline{std::move(pipeline)} {};
+
+            /**
+             * @return If the pipeline has finished compiling, this doesn't block
+             */
+            bool IsCompiled() const {
+                return pipeline.wait_for(std::chrono::seconds::zero()) == std::future_status::ready;
+            }
         };
 
         /**
+         * @param compileShaders If supplied, this is called on a compilation worker to compile the shader modules prior to assembling the pipeline, the modules in the state can be left null in this case
          * @note All attachments in the PipelineState **must** be locked prior to calling this function
          * @note Shader specializiation constants are **not** supported and will result in UB
          * @note Input/Resolve attachments are **not** supported and using them with the supplied pipeline will result in UB
          */
-        CompiledPipeline AssemblePipelineAsync(const PipelineState &state, span<const vk::DescriptorSetLayoutBinding> layoutBindings, span<const vk::PushConstantRange> pushConstantRanges = {}, bool noPushDescriptors = false);
+        CompiledPipeline AssemblePipelineAsync(const PipelineState &state, span<const vk::DescriptorSetLayoutBinding> layoutBindings, span<const vk::PushConstantRange> pushConstantRanges = {}, bool noPushDescriptors = false, ShaderStageCompiler compileShaders = {});
 
         /**
          * @brief Waits until the pipeline compilation thread pool is idle and all pipelines have been compiled
@@ -105,44 +105,40 @@ namespace skyline::gpu::interconnect {
         u32 binarySize;
     };
 
-    bool PipelineStateBundle::Deserialise(std::ifstream &stream) {
-        if (stream.peek() == EOF)
-            return false;
+    void PipelineStateBundle::Deserialise(span<const u8> record) {
+        if (record.size() < sizeof(u64) + sizeof(u32))
+            throw exception("Pipeline state bundle record is too small: 0x{:X}", record.size());
 
-        u64 hash{};
-        stream.read(reinterpret_cast<char *>(&hash), sizeof(hash));
-
-        u32 bundleSize{};
-        stream.read(reinterpret_cast<char *>(&bundleSize), sizeof(bundleSize));
+        u64 hash{record.as<const u64>()};
+        u32 bundleSize{record.subspan(sizeof(u64)).as<const u32>()};
         if (bundleSize > MaxSerialisedBundleSize)
             throw exception("Pipeline state bundle is too large: 0x{:X}", bundleSize);
+        else if (sizeof(u64) + sizeof(u32) + bundleSize != record.size())
+            throw exception("Pipeline state bundle size mismatch: 0x{:X} (record: 0x{:X})", bundleSize, record.size());
 
-        fileBuffer.resize(static_cast<size_t>(bundleSize));
-        stream.read(reinterpret_cast<char *>(fileBuffer.data()), static_cast<std::streamsize>(bundleSize));
-
-        if (XXH64(fileBuffer.data(), bundleSize, 0) != hash)
+        auto data{record.subspan(sizeof(u64) + sizeof(u32))};
+        if (XXH64(data.data(), bundleSize, 0) != hash)
             throw exception("Pipeline state bundle hash mismatch");
 
-        auto data{span(fileBuffer)};
-        const auto &header{data.as<BundleDataHeader>()};
+        const auto &header{data.as<const BundleDataHeader>()};
         size_t offset{sizeof(BundleDataHeader)};
 
         Reset(data.subspan(offset, header.keySize));
         offset += header.keySize;
 
-        auto readConstantBufferValues{data.subspan(offset, header.constantBufferValueCount * sizeof(ConstantBufferValue)).cast<ConstantBufferValue>()};
-        textureTypes.reserve(header.textureTypeCount);
+        auto readConstantBufferValues{data.subspan(offset, header.constantBufferValueCount * sizeof(ConstantBufferValue)).cast<const ConstantBufferValue>()};
+        constantBufferValues.reserve(header.constantBufferValueCount);
         constantBufferValues.insert(constantBufferValues.end(), readConstantBufferValues.begin(), readConstantBufferValues.end());
         offset += header.constantBufferValueCount * sizeof(ConstantBufferValue);
 
-        auto readTextureTypes{data.subspan(offset, header.textureTypeCount * sizeof(TextureTypeEntry)).cast<TextureTypeEntry>()};
+        auto readTextureTypes{data.subspan(offset, header.textureTypeCount * sizeof(TextureTypeEntry)).cast<const TextureTypeEntry>()};
         textureTypes.reserve(header.textureTypeCount);
         textureTypes.insert(textureTypes.end(), readTextureTypes.begin(), readTextureTypes.end());
         offset += header.textureTypeCount * sizeof(TextureTypeEntry);
 
         pipelineStages.resize(header.pipelineStageCount);
         for (u32 i{}; i < header.pipelineStageCount; i++) {
-            const auto &pipelineHeader{data.subspan(offset).as<PipelineBinaryDataHeader>()};
+            const auto &pipelineHeader{data.subspan(offset).as<const PipelineBinaryDataHeader>()};
             offset += sizeof(PipelineBinaryDataHeader);
 
             pipelineStages[i].binaryBaseOffset = pipelineHeader.binaryBaseOffset;
@@ -150,8 +146,6 @@ namespace skyline::gpu::interconnect {
             span(pipelineStages[i].binary).copy_from(data.subspan(offset, pipelineHeader.binarySize));
             offset += pipelineHeader.binarySize;
         }
-
-        return true;
     }
 
     void PipelineStateBundle::Serialise(std::ofstream &stream) {
@@ -105,7 +105,11 @@ namespace skyline::gpu::interconnect {
          */
         u32 LookupConstantBufferValue(u32 shaderStage, u32 index, u32 offset);
 
-        bool Deserialise(std::ifstream &stream);
+        /**
+         * @brief Deserialises the bundle from a single record written by Serialise
+         * @note An exception is thrown if the record is corrupted
+         */
+        void Deserialise(span<const u8> record);
 
         void Serialise(std::ofstream &stream);
     };
@@ -4,49 +4,73 @@
 #include "quads.h"
 
 namespace skyline::gpu::interconnect::conversion::quads {
-    void GenerateQuadListConversionBuffer(u32 *dest, u32 vertexCount) {
-        #pragma clang loop vectorize(enable) interleave(enable) unroll(enable)
-        for (u32 i{}; i < vertexCount; i += 4) {
-            // Given a quad ABCD, we want to generate triangles ABC & CDA
-            // Triangle ABC
-            *(dest++) = i + 0;
-            *(dest++) = i + 1;
-            *(dest++) = i + 2;
-
-            // Triangle CDA
-            *(dest++) = i + 2;
-            *(dest++) = i + 3;
-            *(dest++) = i + 0;
+    /**
+     * @brief Emits a triangle list for the supplied topology, with the vertex indices being transformed by the supplied functor
+     */
+    template<typename S, typename IndexFunc>
+    static void GenerateConversionBufferImpl(S *__restrict__ dest, u32 count, Topology topology, IndexFunc index) {
+        switch (topology) {
+            case Topology::Quads:
+                #pragma clang loop vectorize(enable) interleave(enable) unroll(enable)
+                for (u32 i{}; i + QuadVertexCount <= count; i += QuadVertexCount) {
+                    // Given a quad ABCD, we want to generate triangles ABC & CDA
+                    // Triangle ABC
+                    *(dest++) = index(i + 0);
+                    *(dest++) = index(i + 1);
+                    *(dest++) = index(i + 2);
+
+                    // Triangle CDA
+                    *(dest++) = index(i + 2);
+                    *(dest++) = index(i + 3);
+                    *(dest++) = index(i + 0);
+                }
+                break;
+
+            case Topology::QuadStrip:
+                #pragma clang loop vectorize(enable) interleave(enable) unroll(enable)
+                for (u32 i{}; i + QuadVertexCount <= count; i += 2) {
+                    // A quad strip shares the edge CD of every quad with the next quad as its BA, so the quad ABDC is emitted as triangles ABC & CDA
+                    *(dest++) = index(i + 0);
+                    *(dest++) = index(i + 1);
+                    *(dest++) = index(i + 3);
+
+                    *(dest++) = index(i + 3);
+                    *(dest++) = index(i + 2);
+                    *(dest++) = index(i + 0);
+                }
+                break;
+
+            case Topology::Polygon:
+                #pragma clang loop vectorize(enable) interleave(enable) unroll(enable)
+                for (u32 i{1}; i + 1 < count; i++) {
+                    // Polygons are drawn as a triangle fan around their first vertex
+                    *(dest++) = index(0);
+                    *(dest++) = index(i);
+                    *(dest++) = index(i + 1);
+                }
+                break;
         }
     }
 
+    void GenerateQuadListConversionBuffer(u32 *dest, u32 vertexCount, Topology topology) {
+        GenerateConversionBufferImpl(dest, vertexCount, topology, [](u32 i) { return i; });
+    }
+
     template<typename S>
-    static void GenerateQuadIndexConversionBufferImpl(S *__restrict__ dest, S *__restrict__ source, u32 indexCount) {
-        #pragma clang loop vectorize(enable) interleave(enable) unroll(enable)
-        for (size_t i{}; i < indexCount; i += 4, source += 4) {
-            // Given a quad ABCD, we want to generate triangles ABC & CDA
-            // Triangle ABC
-            *(dest++) = *(source + 0);
-            *(dest++) = *(source + 1);
-            *(dest++) = *(source + 2);
-
-            // Triangle CDA
-            *(dest++) = *(source + 2);
-            *(dest++) = *(source + 3);
-            *(dest++) = *(source + 0);
-        }
+    static void GenerateQuadIndexConversionBufferImpl(S *__restrict__ dest, S *__restrict__ source, u32 indexCount, Topology topology) {
+        GenerateConversionBufferImpl(dest, indexCount, topology, [source](u32 i) { return source[i]; });
     }
 
-    void GenerateIndexedQuadConversionBuffer(u8 *dest, u8 *source, u32 indexCount, vk::IndexType type) {
+    void GenerateIndexedQuadConversionBuffer(u8 *dest, u8 *source, u32 indexCount, vk::IndexType type, Topology topology) {
         switch (type) {
             case vk::IndexType::eUint32:
-                GenerateQuadIndexConversionBufferImpl(reinterpret_cast<u32 *>(dest), reinterpret_cast<u32 *>(source), indexCount);
+                GenerateQuadIndexConversionBufferImpl(reinterpret_cast<u32 *>(dest), reinterpret_cast<u32 *>(source), indexCount, topology);
                 break;
             case vk::IndexType::eUint16:
-                GenerateQuadIndexConversionBufferImpl(reinterpret_cast<u16 *>(dest), reinterpret_cast<u16 *>(source), indexCount);
+                GenerateQuadIndexConversionBufferImpl(reinterpret_cast<u16 *>(dest), reinterpret_cast<u16 *>(source), indexCount, topology);
                 break;
             case vk::IndexType::eUint8EXT:
-                GenerateQuadIndexConversionBufferImpl(dest, source, indexCount);
+                GenerateQuadIndexConversionBufferImpl(dest, source, indexCount, topology);
                 break;
             default:
                 break;
@@ -11,31 +11,48 @@
 namespace skyline::gpu::interconnect::conversion::quads {
     constexpr u32 EmittedIndexCount{6}; //!< The number of indices needed to draw a quad with two triangles
     constexpr u32 QuadVertexCount{4}; //!< The amount of vertices a quad is composed of
+    constexpr u32 PolygonEmittedIndexCount{3}; //!< The number of indices needed to draw a single triangle of a polygon
+
+    /**
+     * @brief The topologies which are emulated by converting them to a triangle list
+     */
+    enum class Topology : u8 {
+        Quads,
+        QuadStrip, //!< Every quad after the first shares its first edge with the last edge of the prior quad
+        Polygon, //!< A single convex polygon which is drawn as a triangle fan around its first vertex
+    };
+    constexpr size_t TopologyCount{3};
 
     /**
      * @return The amount of indices emitted converting a buffer with the supplied element count
      */
-    constexpr u32 GetIndexCount(u32 count) {
-        return (count * EmittedIndexCount) / QuadVertexCount;
+    constexpr u32 GetIndexCount(u32 count, Topology topology) {
+        if (topology == Topology::QuadStrip)
+            return count >= QuadVertexCount ? ((count - 2) / 2) * EmittedIndexCount : 0;
+        else if (topology == Topology::Polygon)
+            return count >= 3 ? (count - 2) * PolygonEmittedIndexCount : 0;
+        else
+            return (count / QuadVertexCount) * EmittedIndexCount;
     }
 
     /**
-     * @return The minimum size (in bytes) required to store the quad index buffer of the given type after conversion
+     * @return The minimum size (in bytes) required to store the index buffer of the given type after conversion
      * @param indexSize The size of an element in the index buffer in bytes
      */
-    constexpr size_t GetRequiredBufferSize(u32 count, size_t indexSize) {
-        return GetIndexCount(count) * indexSize;
+    constexpr size_t GetRequiredBufferSize(u32 count, size_t indexSize, Topology topology) {
+        return GetIndexCount(count, topology) * indexSize;
     }
 
     /**
-     * @brief Create an index buffer that repeats quad vertices to generate a triangle list
+     * @brief Create an index buffer that repeats vertices to generate a triangle list emulating the supplied topology
      * @note The size of the supplied buffer should be at least the size returned by GetRequiredBufferSize()
+     * @note The buffer for a smaller vertex count is always a prefix of the buffer for a larger one
      */
-    void GenerateQuadListConversionBuffer(u32 *dest, u32 vertexCount);
+    void GenerateQuadListConversionBuffer(u32 *dest, u32 vertexCount, Topology topology);
 
     /**
-     * @brief Create an index buffer that repeats quad vertices from the source buffer to generate a triangle list
+     * @brief Create an index buffer that repeats vertices from the source buffer to generate a triangle list emulating the supplied topology
      * @note The size of the destination buffer should be at least the size returned by GetRequiredBufferSize()
      */
-    void GenerateIndexedQuadConversionBuffer(u8 *dest, u8 *source, u32 indexCount, vk::IndexType type);
+    void GenerateIndexedQuadConversionBuffer(u8 *dest, u8 *source, u32 indexCount, vk::IndexType type, Topology topology);
 }
@@ -100,17 +100,17 @@ namespace skyline::gpu::interconnect::maxwell3d {
         }
     }
 
-    static BufferBinding GenerateQuadConversionIndexBuffer(InterconnectContext &ctx, engine::IndexBuffer::IndexSize indexType, BufferView &view, u32 firstIndex, u32 elementCount) {
+    static BufferBinding GenerateQuadConversionIndexBuffer(InterconnectContext &ctx, engine::IndexBuffer::IndexSize indexType, BufferView &view, u32 firstIndex, u32 elementCount, conversion::quads::Topology topology) {
         auto viewSpan{view.GetReadOnlyBackingSpan(false /* We attach above so always false */, []() {
             // TODO: see Read()
             LOGE("Dirty index buffer reads for attached buffers are unimplemented");
         })};
 
         size_t indexSize{1U << static_cast<u32>(indexType)};
-        vk::DeviceSize indexBufferSize{conversion::quads::GetRequiredBufferSize(elementCount, indexSize)};
+        vk::DeviceSize indexBufferSize{conversion::quads::GetRequiredBufferSize(elementCount, indexSize, topology)};
         auto quadConversionAllocation{ctx.gpu.megaBufferAllocator.Allocate(ctx.executor.cycle, indexBufferSize)};
 
-        conversion::quads::GenerateIndexedQuadConversionBuffer(quadConversionAllocation.region.data(), viewSpan.subspan(GetIndexBufferSize(indexType, firstIndex)).data(), elementCount, ConvertIndexType(indexType));
+        conversion::quads::GenerateIndexedQuadConversionBuffer(quadConversionAllocation.region.data(), viewSpan.subspan(GetIndexBufferSize(indexType, firstIndex)).data(), elementCount, ConvertIndexType(indexType), topology);
 
         return {quadConversionAllocation.buffer, quadConversionAllocation.offset, indexBufferSize};
     }
@@ -122,7 +122,7 @@ namespace skyline::gpu::interconnect::maxwell3d {
 
     IndexBufferState::IndexBufferState(dirty::Handle dirtyHandle, DirtyManager &manager, const EngineRegisters &engine) : engine{manager, dirtyHandle, engine} {}
 
-    void IndexBufferState::Flush(InterconnectContext &ctx, StateUpdateBuilder &builder, StageMask &srcStageMask, StageMask &dstStageMask, bool quadConversion, bool estimateSize, u32 firstIndex, u32 elementCount) {
+    void IndexBufferState::Flush(InterconnectContext &ctx, StateUpdateBuilder &builder, StageMask &srcStageMask, StageMask &dstStageMask, std::optional<conversion::quads::Topology> quadConversion, bool estimateSize, u32 firstIndex, u32 elementCount) {
         didEstimateSize = estimateSize;
         usedElementCount = elementCount;
         usedFirstIndex = firstIndex;
@@ -147,7 +147,7 @@ namespace skyline::gpu::interconnect::maxwell3d {
         indexType = ConvertIndexType(engine->indexBuffer.indexSize);
 
         if (quadConversion)
-            megaBufferBinding = GenerateQuadConversionIndexBuffer(ctx, engine->indexBuffer.indexSize, *view, firstIndex, elementCount);
+            megaBufferBinding = GenerateQuadConversionIndexBuffer(ctx, engine->indexBuffer.indexSize, *view, firstIndex, elementCount, *quadConversion);
         else
             megaBufferBinding = view->TryMegaBuffer(ctx.executor.cycle, ctx.gpu.megaBufferAllocator, ctx.executor.executionTag);
 
@@ -157,7 +157,7 @@ namespace skyline::gpu::interconnect::maxwell3d {
             builder.SetIndexBuffer(*view, indexType);
     }
 
-    bool IndexBufferState::Refresh(InterconnectContext &ctx, StateUpdateBuilder &builder, StageMask &srcStageMask, StageMask &dstStageMask, bool quadConversion, bool estimateSize, u32 firstIndex, u32 elementCount) {
+    bool IndexBufferState::Refresh(InterconnectContext &ctx, StateUpdateBuilder &builder, StageMask &srcStageMask, StageMask &dstStageMask, std::optional<conversion::quads::Topology> quadConversion, bool estimateSize, u32 firstIndex, u32 elementCount) {
         if (*view)
             view->GetBuffer()->PopulateReadBarrier(vk::PipelineStageFlagBits::eVertexInput, srcStageMask, dstStageMask);
 
@@ -166,7 +166,7 @@ namespace skyline::gpu::interconnect::maxwell3d {
 
         // TODO: optimise this to use buffer sequencing to avoid needing to regenerate the quad buffer every time. We can't use as it is rn though because sequences aren't globally unique and may conflict after buffer recreation
         if (usedQuadConversion) {
-            megaBufferBinding = GenerateQuadConversionIndexBuffer(ctx, engine->indexBuffer.indexSize, *view, firstIndex, elementCount);
+            megaBufferBinding = GenerateQuadConversionIndexBuffer(ctx, engine->indexBuffer.indexSize, *view, firstIndex, elementCount, *usedQuadConversion);
             builder.SetIndexBuffer(megaBufferBinding, indexType);
         } else if (megaBufferBinding) {
             if (auto newMegaBufferBinding{view->TryMegaBuffer(ctx.executor.cycle, ctx.gpu.megaBufferAllocator, ctx.executor.executionTag)};
@@ -188,6 +188,14 @@ namespace skyline::gpu::interconnect::maxwell3d {
         megaBufferBinding = {};
     }
 
+    BufferView IndexBufferState::GetView() {
+        return *view;
+    }
+
+    u32 IndexBufferState::GetIndexSize() const {
+        return 1U << static_cast<u32>(engine->indexBuffer.indexSize);
+    }
+
     /* Transform Feedback Buffer */
     void TransformFeedbackBufferState::EngineRegisters::DirtyBind(DirtyManager &manager, dirty::Handle handle) const {
         manager.Bind(handle, streamOutBuffer.address, streamOutBuffer.loadWritePointerStartOffset, streamOutBuffer.size, streamOutEnable);
@@ -447,7 +455,8 @@ namespace skyline::gpu::interconnect::maxwell3d {
         pipeline.Update(ctx, textures, constantBuffers, builder);
         ranges::for_each(vertexBuffers, updateFuncBuffer);
         if (indexed)
-            updateFuncBuffer(indexBuffer, directState.inputAssembly.NeedsQuadConversion(), estimateIndexBufferSize, drawFirstIndex, drawElementCount);
+            // Indirect draws don't have their index range available on the CPU so any conversion must be performed on the GPU by the caller
+            updateFuncBuffer(indexBuffer, estimateIndexBufferSize ? std::nullopt : directState.inputAssembly.GetQuadConversionTopology(), estimateIndexBufferSize, drawFirstIndex, drawElementCount);
         ranges::for_each(transformFeedbackBuffers, updateFuncBuffer);
         ranges::for_each(viewports, updateFunc);
         ranges::for_each(scissors, updateFunc);
@@ -470,6 +479,18 @@ namespace skyline::gpu::interconnect::maxwell3d {
         return pipeline.Get().depthAttachment;
     }
 
+    BufferView ActiveState::GetIndexBufferView() {
+        return indexBuffer.Get().GetView();
+    }
+
+    u32 ActiveState::GetIndexBufferIndexSize() {
+        return indexBuffer.Get().GetIndexSize();
+    }
+
+    void ActiveState::MarkIndexBufferDirty() {
+        indexBuffer.MarkDirty(false);
+    }
+
     std::shared_ptr<TextureView> ActiveState::GetColorRenderTargetForClear(InterconnectContext &ctx, size_t index) {
         return pipeline.Get().GetColorRenderTargetForClear(ctx, index);
     }
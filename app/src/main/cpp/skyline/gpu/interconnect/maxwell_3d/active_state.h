@@ -51,16 +51,26 @@ namespace skyline::gpu::interconnect::maxwell3d {
         bool didEstimateSize{};
         u32 usedElementCount{};
         u32 usedFirstIndex{};
-        bool usedQuadConversion{};
+        std::optional<conversion::quads::Topology> usedQuadConversion{};
 
       public:
         IndexBufferState(dirty::Handle dirtyHandle, DirtyManager &manager, const EngineRegisters &engine);
 
-        void Flush(InterconnectContext &ctx, StateUpdateBuilder &builder, StageMask &srcStageMask, StageMask &dstStageMask, bool quadConversion, bool estimateSize, u32 firstIndex, u32 elementCount);
+        void Flush(InterconnectContext &ctx, StateUpdateBuilder &builder, StageMask &srcStageMask, StageMask &dstStageMask, std::optional<conversion::quads::Topology> quadConversion, bool estimateSize, u32 firstIndex, u32 elementCount);
 
-        bool Refresh(InterconnectContext &ctx, StateUpdateBuilder &builder, StageMask &srcStageMask, StageMask &dstStageMask, bool quadConversion, bool estimateSize, u32 firstIndex, u32 elementCount);
+        bool Refresh(InterconnectContext &ctx, StateUpdateBuilder &builder, StageMask &srcStageMask, StageMask &dstStageMask, std::optional<conversion::quads::Topology> quadConversion, bool estimateSize, u32 firstIndex, u32 elementCount);
 
         void PurgeCaches();
+
+        /**
+         * @return A view of the guest index buffer, this is empty if the index buffer is unmapped
+         */
+        BufferView GetView();
+
+        /**
+         * @return The size of a single index in the guest index buffer in bytes
+         */
+        u32 GetIndexSize() const;
     };
 
     class TransformFeedbackBufferState : dirty::CachedManualDirty, dirty::RefreshableManualDirty {
@@ -273,6 +283,19 @@ namespace skyline::gpu::interconnect::maxwell3d {
 
         TextureView *GetDepthAttachment();
 
+        /**
+         * @note This must only be called after an indexed draw has updated the state
+         * @note See IndexBufferState::GetView
+         */
+        BufferView GetIndexBufferView();
+
+        u32 GetIndexBufferIndexSize();
+
+        /**
+         * @brief Forces the index buffer to be rebound by the next indexed draw, this is required after a draw binds its own index buffer
+         */
+        void MarkIndexBufferDirty();
+
         std::shared_ptr<TextureView> GetColorRenderTargetForClear(InterconnectContext &ctx, size_t index);
 
         std::shared_ptr<TextureView> GetDepthRenderTargetForClear(InterconnectContext &ctx);
@@ -39,7 +39,7 @@ namespace skyline::gpu::interconnect::maxwell3d {
             constantBuffers.MarkAllDirty();
             samplers.MarkAllDirty();
             textures.MarkAllDirty();
-            quadConversionBufferAttached = false;
+            quadConversionBuffersAttached.fill(false);
             constantBuffers.DisableQuickBind();
             queries.PurgeCaches(ctx);
         });
@@ -50,22 +50,24 @@ namespace skyline::gpu::interconnect::maxwell3d {
         });
     }
 
-    vk::DeviceSize Maxwell3D::UpdateQuadConversionBuffer(u32 count, u32 firstVertex) {
-        vk::DeviceSize offset{conversion::quads::GetRequiredBufferSize(firstVertex, sizeof(u32))};
-        vk::DeviceSize size{conversion::quads::GetRequiredBufferSize(count, sizeof(u32)) + offset};
+    BufferBinding Maxwell3D::UpdateQuadConversionBuffer(u32 vertexCount, conversion::quads::Topology topology) {
+        auto &buffer{quadConversionBuffers[static_cast<size_t>(topology)]};
+        auto &attached{quadConversionBuffersAttached[static_cast<size_t>(topology)]};
+        vk::DeviceSize size{conversion::quads::GetRequiredBufferSize(vertexCount, sizeof(u32), topology)};
 
-        if (!quadConversionBuffer || quadConversionBuffer->size_bytes() < size) {
-            quadConversionBuffer = std::make_shared<memory::Buffer>(ctx.gpu.memory.AllocateBuffer(util::AlignUp(size, getpagesize())));
-            conversion::quads::GenerateQuadListConversionBuffer(quadConversionBuffer->cast<u32>().data(), firstVertex + count);
-            quadConversionBufferAttached = false;
+        if (!buffer || buffer->size_bytes() < size) {
+            // The conversion for a smaller vertex count is a prefix of that of a larger one, so the buffer only needs to be regenerated when it grows
+            buffer = std::make_shared<memory::Buffer>(ctx.gpu.memory.AllocateBuffer(util::AlignUp(size, getpagesize())));
+            conversion::quads::GenerateQuadListConversionBuffer(buffer->cast<u32>().data(), vertexCount, topology);
+            attached = false;
         }
 
-        if (!quadConversionBufferAttached) {
-            ctx.executor.AttachDependency(quadConversionBuffer);
-            quadConversionBufferAttached = true;
+        if (!attached) {
+            ctx.executor.AttachDependency(buffer);
+            attached = true;
         }
 
-        return offset;
+        return BufferBinding{buffer->vkBuffer};
     }
 
     vk::Rect2D Maxwell3D::GetClearScissor() {
@@ -134,7 +136,7 @@ namespace skyline::gpu::interconnect::maxwell3d {
         return scissor;
     }
 
-     void Maxwell3D::PrepareDraw(StateUpdateBuilder &builder,
+     bool Maxwell3D::PrepareDraw(StateUpdateBuilder &builder,
                                  engine::DrawTopology topology, bool indexed, bool estimateIndexBufferSize, u32 firstIndex, u32 count,
                                  StageMask &srcStageMask, StageMask &dstStageMask) {
          Pipeline *oldPipeline{activeState.GetPipeline()};
@@ -144,6 +146,12 @@ namespace skyline::gpu::interconnect::maxwell3d {
                             indexed, topology, estimateIndexBufferSize, firstIndex, count,
                             srcStageMask, dstStageMask);
          Pipeline *pipeline{activeState.GetPipeline()};
+         if (pipeline->IsPending()) {
+             // The draw is skipped rather than stalling until the pipeline is compiled
+             DiscardPreparedDraw();
+             return false;
+         }
+
          activeDescriptorSetSampledImages.resize(pipeline->GetTotalSampledImageCount());
 
 
@@ -188,6 +196,8 @@ namespace skyline::gpu::interconnect::maxwell3d {
                  }
              }
          }
+
+         return true;
     }
 
     void Maxwell3D::LoadConstantBuffer(span<u32> data, u32 offset) {
@@ -299,22 +309,28 @@ namespace skyline::gpu::interconnect::maxwell3d {
     void Maxwell3D::Draw(engine::DrawTopology topology, bool transformFeedbackEnable, bool indexed, u32 count, u32 first, u32 instanceCount, u32 vertexOffset, u32 firstInstance) {
         TRACE_EVENT("gpu", "Draw", "indexed", indexed, "count", count, "instanceCount", instanceCount);
 
+        auto conversionTopology{InputAssemblyState::GetQuadConversionTopology(topology)};
+        if (conversionTopology && !conversion::quads::GetIndexCount(count, *conversionTopology))
+            return; // There aren't enough vertices to form a single primitive of the converted topology
+
         StateUpdateBuilder builder{*ctx.executor.allocator};
         
         StageMask srcStageMask{}, dstStageMask{};
 
-        PrepareDraw(builder, topology, indexed, false, first, count, srcStageMask, dstStageMask);
-
-        if (directState.inputAssembly.NeedsQuadConversion()) {
-            count = conversion::quads::GetIndexCount(count);
-            first = 0;
+        if (!PrepareDraw(builder, topology, indexed, false, first, count, srcStageMask, dstStageMask))
+            return;
 
+        if (conversionTopology) {
+            u32 convertedCount{conversion::quads::GetIndexCount(count, *conversionTopology)};
             if (!indexed) {
-                // Use an index buffer to emulate quad lists with a triangle list input topology
-                vk::DeviceSize offset{UpdateQuadConversionBuffer(count, first)};
-                builder.SetIndexBuffer(BufferBinding{quadConversionBuffer->vkBuffer, offset}, vk::IndexType::eUint32);
+                // Use an index buffer to emulate the topology with a triangle list input topology, the first vertex is applied as an offset to the generated indices
+                builder.SetIndexBuffer(UpdateQuadConversionBuffer(count, *conversionTopology), vk::IndexType::eUint32);
+                vertexOffset = first;
                 indexed = true;
             }
+
+            count = convertedCount;
+            first = 0;
         }
 
         auto stateUpdater{builder.Build()};
@@ -358,19 +374,168 @@ namespace skyline::gpu::interconnect::maxwell3d {
         ctx.executor.AddCheckpoint("After draw");
     }
 
-    void Maxwell3D::DrawIndirect(engine::DrawTopology topology, bool transformFeedbackEnable, bool indexed, span<u8> indirectBuffer, u32 count, u32 stride) {
-        if (!count)
+    void Maxwell3D::MultiDraw(engine::DrawTopology topology, bool indexed, span<const MultiDrawEntry> draws, u32 firstInstance) {
+        TRACE_EVENT("gpu", "MultiDraw", "indexed", indexed, "drawCount", draws.size());
+
+        // The index buffer needs to cover the ranges of all the merged draws
+        u32 minFirst{std::numeric_limits<u32>::max()}, maxEnd{};
+        for (const auto &draw : draws) {
+            minFirst = std::min(minFirst, draw.first);
+            maxEnd = std::max(maxEnd, draw.first + draw.count);
+        }
+
+        StateUpdateBuilder builder{*ctx.executor.allocator};
+        StageMask srcStageMask{}, dstStageMask{};
+
+        if (!PrepareDraw(builder, topology, indexed, false, minFirst, maxEnd - minFirst, srcStageMask, dstStageMask))
             return;
 
+        if (directState.inputAssembly.NeedsQuadConversion())
+            throw exception("Quad conversion is not supported for multi-draws!");
+
+        auto stateUpdater{builder.Build()};
+
+        /**
+         * @brief Struct that can be linearly allocated, holding all state for the draws to avoid a dynamic allocation with lambda captures
+         * @note The draw info arrays are laid out in the format expected by VK_EXT_multi_draw so they can be passed directly to the driver
+         */
+        struct DrawParams {
+            StateUpdater stateUpdater;
+            span<vk::MultiDrawInfoEXT> drawInfos;
+            span<vk::MultiDrawIndexedInfoEXT> indexedDrawInfos;
+            u32 firstInstance;
+            bool supportsMultiDraw;
+        };
+        auto *drawParams{ctx.executor.allocator->EmplaceUntracked<DrawParams>(DrawParams{stateUpdater, {}, {}, firstInstance, ctx.gpu.traits.supportsMultiDraw})};
+
+        if (indexed) {
+            drawParams->indexedDrawInfos = ctx.executor.allocator->AllocateUntracked<vk::MultiDrawIndexedInfoEXT>(draws.size());
+            for (size_t i{}; i < draws.size(); i++)
+                drawParams->indexedDrawInfos[i] = vk::MultiDrawIndexedInfoEXT{
+                    .firstIndex = draws[i].first,
+                    .indexCount = draws[i].count,
+                    .vertexOffset = static_cast<i32>(draws[i].vertexOffset),
+                };
+        } else {
+            drawParams->drawInfos = ctx.executor.allocator->AllocateUntracked<vk::MultiDrawInfoEXT>(draws.size());
+            for (size_t i{}; i < draws.size(); i++)
+                drawParams->drawInfos[i] = vk::MultiDrawInfoEXT{
+                    .firstVertex = draws[i].first,
+                    .vertexCount = draws[i].count,
+                };
+        }
+
+        vk::Rect2D scissor{GetDrawScissor()};
+
+        constantBuffers.ResetQuickBind();
+        ctx.executor.AddCheckpoint("Before multi-draw");
+        ctx.executor.AddSubpass([drawParams](vk::raii::CommandBuffer &commandBuffer, const std::shared_ptr<FenceCycle> &, GPU &gpu, vk::RenderPass, u32) {
+            drawParams->stateUpdater.RecordAll(gpu, commandBuffer);
+
+            if (drawParams->supportsMultiDraw) {
+                // The raw entrypoints are used as the Vulkan-Hpp signatures for these commands have changed between header versions
+                auto &dispatcher{*commandBuffer.getDispatcher()};
+                if (!drawParams->indexedDrawInfos.empty())
+                    dispatcher.vkCmdDrawMultiIndexedEXT(*commandBuffer, static_cast<u32>(drawParams->indexedDrawInfos.size()), reinterpret_cast<const VkMultiDrawIndexedInfoEXT *>(drawParams->indexedDrawInfos.data()), 1, drawParams->firstInstance, sizeof(vk::MultiDrawIndexedInfoEXT), nullptr);
+                else
+                    dispatcher.vkCmdDrawMultiEXT(*commandBuffer, static_cast<u32>(drawParams->drawInfos.size()), reinterpret_cast<const VkMultiDrawInfoEXT *>(drawParams->drawInfos.data()), 1, drawParams->firstInstance, sizeof(vk::MultiDrawInfoEXT));
+            } else {
+                // Without VK_EXT_multi_draw we still avoid redundant state updates and subpass tracking by recording all the draws back-to-back
+                for (const auto &drawInfo : drawParams->indexedDrawInfos)
+                    commandBuffer.drawIndexed(drawInfo.indexCount, 1, drawInfo.firstIndex, drawInfo.vertexOffset, drawParams->firstInstance);
+
+                for (const auto &drawInfo : drawParams->drawInfos)
+                    commandBuffer.draw(drawInfo.vertexCount, 1, drawInfo.firstVertex, drawParams->firstInstance);
+            }
+        }, scissor, activeDescriptorSetSampledImages, {}, activeState.GetColorAttachments(), activeState.GetDepthAttachment(), !ctx.gpu.traits.quirks.relaxedRenderPassCompatibility, srcStageMask, dstStageMask);
+        ctx.executor.AddCheckpoint("After multi-draw");
+    }
+
+    void Maxwell3D::DiscardPreparedDraw() {
+        activeState.MarkAllDirty();
+        activeDescriptorSet = nullptr;
+        constantBuffers.ResetQuickBind();
+    }
+
+    std::optional<IndirectConversionHelperShader::Mode> Maxwell3D::GetIndirectConversionMode(engine::DrawTopology topology) {
+        switch (topology) {
+            case engine::DrawTopology::Quads:
+                return IndirectConversionHelperShader::Mode::Quads;
+            case engine::DrawTopology::QuadStrip:
+                return IndirectConversionHelperShader::Mode::QuadStrip;
+            case engine::DrawTopology::Polygon:
+                return IndirectConversionHelperShader::Mode::Polygon;
+            default:
+                return std::nullopt;
+        }
+    }
+
+    BufferBinding Maxwell3D::ConvertIndirectDraw(IndirectConversionHelperShader::Mode mode) {
+        auto indexBufferView{activeState.GetIndexBufferView()};
+        if (!indexBufferView)
+            return {};
+
+        indexBufferView.GetBuffer()->BlockSequencedCpuBackingWrites();
+
+        // The amount of indices is only known on the GPU so the output is sized for the worst case of the entire index buffer being used, CanConvertIndirectDraw ensures this is bounded
+        u32 indexSize{activeState.GetIndexBufferIndexSize()};
+        u32 maxPrimitives{IndirectConversionHelperShader::GetMaxPrimitiveCount(mode, static_cast<u32>(std::min<vk::DeviceSize>(indexBufferView.size / indexSize, std::numeric_limits<u32>::max())))};
+        vk::DeviceSize outputSize{IndirectConversionHelperShader::CommandSize + static_cast<vk::DeviceSize>(maxPrimitives) * IndirectConversionHelperShader::GetIndicesPerPrimitive(mode) * sizeof(u32)};
+
+        // The output is bound as a storage buffer so it needs to be aligned beyond what the megabuffer guarantees
+        vk::DeviceSize alignment{ctx.gpu.traits.minimumStorageBufferAlignment};
+        auto allocation{ctx.gpu.megaBufferAllocator.Allocate(ctx.executor.cycle, outputSize + alignment)};
+        BufferBinding output{allocation.buffer, util::AlignUp(allocation.offset, alignment), outputSize};
+
+        auto descriptorSet{std::make_shared<DescriptorAllocator::ActiveDescriptorSet>(ctx.gpu.descriptor.AllocateSet(ctx.gpu.helperShaders.indirectConversionHelperShader.GetDescriptorSetLayout()))};
+        ctx.executor.AttachDependency(descriptorSet);
+
+        // The conversion can't be recorded inside the render pass so it's placed prior to it, this is correct as long as the draw parameters weren't written by the render pass itself which isn't the case for compute-generated draws
+        ctx.executor.InsertPreRpCommand([indirectBuffer = indirectBufferView, indexBuffer = indexBufferView, indexSize, output, maxPrimitives, mode, descriptorSet](vk::raii::CommandBuffer &commandBuffer, const std::shared_ptr<FenceCycle> &, GPU &gpu) {
+            auto commandBinding{indirectBuffer.GetBinding(gpu)};
+            commandBinding.size = sizeof(vk::DrawIndexedIndirectCommand);
+            gpu.helperShaders.indirectConversionHelperShader.RecordConversion(gpu, commandBuffer, **descriptorSet,
+                                                                             commandBinding, indexBuffer.GetBinding(gpu), indexSize, output,
+                                                                             maxPrimitives, mode);
+        });
+
+        // The converted indices are bound by the draw itself, so the guest index buffer needs to be rebound by the next indexed draw
+        activeState.MarkIndexBufferDirty();
+        return output;
+    }
+
+    bool Maxwell3D::CanConvertIndirectDraw(IndirectConversionHelperShader::Mode mode) {
+        auto indexBufferView{activeState.GetIndexBufferView()};
+        if (!indexBufferView)
+            return true;
+
+        u32 indexCount{static_cast<u32>(std::min<vk::DeviceSize>(indexBufferView.size / activeState.GetIndexBufferIndexSize(), std::numeric_limits<u32>::max()))};
+        return static_cast<u64>(IndirectConversionHelperShader::GetMaxPrimitiveCount(mode, indexCount)) * IndirectConversionHelperShader::GetIndicesPerPrimitive(mode) <= IndirectConversionHelperShader::MaxConvertedIndexCount;
+    }
+
+    bool Maxwell3D::DrawIndirect(engine::DrawTopology topology, bool transformFeedbackEnable, bool indexed, span<u8> indirectBuffer, u32 count, u32 stride) {
+        if (!count)
+            return true;
+
+        auto conversionMode{GetIndirectConversionMode(topology)};
+        // Topology conversion only supports a single indexed draw
+        if (conversionMode && (!indexed || count != 1))
+            return false;
+
         TRACE_EVENT("gpu", "Indirect Draw", "buffer", reinterpret_cast<uintptr_t>(indirectBuffer.data()));
 
         StateUpdateBuilder builder{*ctx.executor.allocator};
         StageMask srcStageMask{}, dstStageMask{};
 
-        PrepareDraw(builder, topology, indexed, true, 0, 0, srcStageMask, dstStageMask);
+        if (!PrepareDraw(builder, topology, indexed, true, 0, 0, srcStageMask, dstStageMask))
+            return true;
 
-        if (directState.inputAssembly.NeedsQuadConversion())
-            throw exception("Quad conversion is not supported for indirect draws!");
+        if (conversionMode && !CanConvertIndirectDraw(*conversionMode)) {
+            // The conversion output would need to be truncated, so the draw is converted on the CPU instead
+            LOGD("Indirect draw with topology {} exceeds the GPU conversion limit, falling back to CPU conversion", static_cast<u32>(topology));
+            DiscardPreparedDraw();
+            return false;
+        }
 
         if (indirectBufferView)
             indirectBufferView = indirectBufferView.GetBuffer()->TryGetView(indirectBuffer);
@@ -389,16 +554,20 @@ namespace skyline::gpu::interconnect::maxwell3d {
         struct DrawParams {
             StateUpdater stateUpdater;
             BufferView indirectBuffer;
+            BufferBinding convertedBuffer; //!< The output of the topology conversion pass, containing the converted draw command followed by its indices
             u32 count;
             u32 stride;
             bool indexed;
             bool transformFeedbackEnable;
         };
         auto *drawParams{ctx.executor.allocator->EmplaceUntracked<DrawParams>(DrawParams{stateUpdater,
-                                                                                         indirectBufferView,
+                                                                                         indirectBufferView, {},
                                                                                          count, stride, indexed,
                                                                                          ctx.gpu.traits.supportsTransformFeedback ? transformFeedbackEnable : false})};
 
+        if (conversionMode)
+            drawParams->convertedBuffer = ConvertIndirectDraw(*conversionMode);
+
         auto scissor{GetDrawScissor()};
         constantBuffers.ResetQuickBind();
 
@@ -409,16 +578,23 @@ namespace skyline::gpu::interconnect::maxwell3d {
             if (drawParams->transformFeedbackEnable)
                 commandBuffer.beginTransformFeedbackEXT(0, {}, {});
 
-            auto indirectBinding{drawParams->indirectBuffer.GetBinding(gpu)};
-            if (drawParams->indexed)
-                commandBuffer.drawIndexedIndirect(indirectBinding.buffer, indirectBinding.offset, drawParams->count, drawParams->stride);
-            else
-                commandBuffer.drawIndirect(indirectBinding.buffer,  indirectBinding.offset, drawParams->count, drawParams->stride);
+            if (drawParams->convertedBuffer) {
+                const auto &converted{drawParams->convertedBuffer};
+                commandBuffer.bindIndexBuffer(converted.buffer, converted.offset + IndirectConversionHelperShader::CommandSize, vk::IndexType::eUint32);
+                commandBuffer.drawIndexedIndirect(converted.buffer, converted.offset, 1, 0);
+            } else {
+                auto indirectBinding{drawParams->indirectBuffer.GetBinding(gpu)};
+                if (drawParams->indexed)
+                    commandBuffer.drawIndexedIndirect(indirectBinding.buffer, indirectBinding.offset, drawParams->count, drawParams->stride);
+                else
+                    commandBuffer.drawIndirect(indirectBinding.buffer,  indirectBinding.offset, drawParams->count, drawParams->stride);
+            }
 
             if (drawParams->transformFeedbackEnable)
                 commandBuffer.endTransformFeedbackEXT(0, {}, {});
         }, scissor, activeDescriptorSetSampledImages, {}, activeState.GetColorAttachments(), activeState.GetDepthAttachment(), !ctx.gpu.traits.quirks.relaxedRenderPassCompatibility, srcStageMask, dstStageMask);
         ctx.executor.AddCheckpoint("After indirect draw");
+        return true;
     }
 
     void Maxwell3D::Query(soc::gm20b::IOVA address, engine::SemaphoreInfo::CounterType type, std::optional<u64> timestamp) {
@@ -4,6 +4,7 @@
 #pragma once
 
 #include <gpu/descriptor_allocator.h>
+#include <gpu/shaders/helper_shaders.h>
 #include <gpu/interconnect/common/samplers.h>
 #include <gpu/interconnect/common/textures.h>
 #include <soc/gm20b/gmmu.h>
@@ -42,6 +43,15 @@ namespace skyline::gpu::interconnect::maxwell3d {
             TexturePoolState::EngineRegisters texturePoolRegisters;
         };
 
+        /**
+         * @brief The parameters of a single draw within a multi-draw, all draws share the same state and instance parameters
+         */
+        struct MultiDrawEntry {
+            u32 count; //!< indexed ? indexCount : vertexCount
+            u32 first; //!< indexed ? firstIndex : firstVertex
+            u32 vertexOffset; //!< Only applicable to indexed draws
+        };
+
       private:
         InterconnectContext ctx;
         ActiveState activeState;
@@ -50,8 +60,8 @@ namespace skyline::gpu::interconnect::maxwell3d {
         Samplers samplers;
         const engine::SamplerBinding &samplerBinding;
         Textures textures;
-        std::shared_ptr<memory::Buffer> quadConversionBuffer{};
-        bool quadConversionBufferAttached{};
+        std::array<std::shared_ptr<memory::Buffer>, conversion::quads::TopologyCount> quadConversionBuffers{}; //!< Index buffers used to convert non-indexed draws, indexed by the converted topology
+        std::array<bool, conversion::quads::TopologyCount> quadConversionBuffersAttached{};
         BufferView indirectBufferView;
         Queries queries;
 
@@ -60,7 +70,10 @@ namespace skyline::gpu::interconnect::maxwell3d {
         DescriptorAllocator::ActiveDescriptorSet *activeDescriptorSet{};
         std::vector<TextureView *> activeDescriptorSetSampledImages{};
 
-        size_t UpdateQuadConversionBuffer(u32 count, u32 firstVertex);
+        /**
+         * @return A binding to an index buffer converting the supplied amount of vertices of the topology to a triangle list
+         */
+        BufferBinding UpdateQuadConversionBuffer(u32 vertexCount, conversion::quads::Topology topology);
 
         /**
          * @brief A scissor derived from the current clear register state
@@ -74,11 +87,35 @@ namespace skyline::gpu::interconnect::maxwell3d {
 
         /**
          * @brief Performs operations common across indirect and regular draws
+         * @return If the draw should be performed, this is false if its pipeline is still being compiled asynchronously in which case the draw must be skipped
          */
-        void PrepareDraw(StateUpdateBuilder &builder,
+        bool PrepareDraw(StateUpdateBuilder &builder,
                          engine::DrawTopology topology, bool indexed, bool estimateIndexBufferSize, u32 firstIndex, u32 count,
                          StageMask &srcStageMask, StageMask &dstStageMask);
 
+        /**
+         * @brief Abandons a draw after PrepareDraw has been called for it, all state is marked dirty so it's rebound in full by the next draw as none of the state updates for the draw are recorded
+         */
+        void DiscardPreparedDraw();
+
+        /**
+         * @return The mode of the GPU topology conversion pass required to draw the supplied topology indirectly, if any
+         */
+        static std::optional<IndirectConversionHelperShader::Mode> GetIndirectConversionMode(engine::DrawTopology topology);
+
+        /**
+         * @brief Records a GPU pass converting the current indirect draw command and the index buffer it references into a triangle list, so draws with GPU-written parameters don't need to be read back
+         * @return A binding to the converted draw command followed by its indices, this is empty if the index buffer is unmapped
+         * @note The indirect buffer view and the index buffer state must be updated for the current draw prior to calling this
+         */
+        BufferBinding ConvertIndirectDraw(IndirectConversionHelperShader::Mode mode);
+
+        /**
+         * @return If the output of a conversion of the current index buffer fits within IndirectConversionHelperShader::MaxConvertedIndexCount
+         * @note The index buffer state must be updated for the current draw prior to calling this
+         */
+        bool CanConvertIndirectDraw(IndirectConversionHelperShader::Mode mode);
+
       public:
         DirectPipelineState &directState;
 
@@ -108,7 +145,16 @@ namespace skyline::gpu::interconnect::maxwell3d {
 
         void Draw(engine::DrawTopology topology, bool transformFeedbackEnable, bool indexed, u32 count, u32 first, u32 instanceCount, u32 vertexOffset, u32 firstInstance);
 
-        void DrawIndirect(engine::DrawTopology topology, bool transformFeedbackEnable, bool indexed, span<u8> indirectBuffer, u32 count, u32 stride);
+        /**
+         * @brief Records a sequence of non-instanced draws sharing the same state with a single state update and subpass, using VK_EXT_multi_draw when it is supported
+         * @note Quad topologies and transform feedback are not supported, such draws must go through Draw()
+         */
+        void MultiDraw(engine::DrawTopology topology, bool indexed, span<const MultiDrawEntry> draws, u32 firstInstance);
+
+        /**
+         * @return If the draw was handled, if this is false the draw can't be performed with GPU-side parameters and needs to be read back and performed directly by the caller
+         */
+        bool DrawIndirect(engine::DrawTopology topology, bool transformFeedbackEnable, bool indexed, span<u8> indirectBuffer, u32 count, u32 stride);
 
         void Query(soc::gm20b::IOVA address, engine::SemaphoreInfo::CounterType type, std::optional<u64> timestamp);
 
@@ -3,6 +3,8 @@
 // Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
 
 #include <fstream>
+#include <boost/functional/hash.hpp>
+#include <common/settings.h>
 #include <gpu/texture/texture.h>
 #include <gpu/interconnect/command_executor.h>
 #include <gpu/interconnect/common/pipeline.inc>
@@ -19,10 +21,22 @@
 namespace skyline::gpu::interconnect::maxwell3d {
     struct ShaderStage {
         vk::ShaderStageFlagBits stage;
-        vk::ShaderModule module;
         Shader::Info info;
     };
 
+    /**
+     * @brief The translated programs of all stages in a pipeline alongside all other state required to compile them
+     * @note This is shared with deferred shader compilation so it must not reference any state that's only valid during pipeline creation
+     */
+    struct PipelinePrograms {
+        std::array<ShaderStage, engine::ShaderStageCount> shaderStages{};
+        std::array<Shader::IR::Program, engine::PipelineCount> programs;
+        std::array<std::optional<Shader::RuntimeInfo>, engine::PipelineCount> runtimeInfos; //!< The runtime info of every program which needs to be compiled, programs must be compiled in order as bindings are allocated sequentially
+        std::array<u64, engine::PipelineCount> shaderHashes{};
+        std::array<size_t, engine::PipelineCount> programHashes{}; //!< Hashes of all inputs other than the guest binary which affected the translation of each program, these key the shader module cache
+        std::shared_ptr<const void> pools; //!< Keeps the object pools backing the programs valid
+    };
+
     static constexpr Shader::Stage ConvertCompilerShaderStage(engine::Pipeline::Shader::Type stage) {
         switch (stage) {
             case engine::Pipeline::Shader::Type::VertexCullBeforeFetch:
@@ -196,25 +210,46 @@ namespace skyline::gpu::interconnect::maxwell3d {
         return info;
     }
 
-    static std::array<ShaderStage, engine::ShaderStageCount> MakePipelineShaders(GPU &gpu, const PipelineStateAccessor &accessor, const PackedPipelineState &packedState) {
+    /**
+     * @brief Translates all shaders in a pipeline, this reads all state from the accessor that's required for compiling them
+     */
+    static std::shared_ptr<PipelinePrograms> TranslatePipelineShaders(GPU &gpu, const PipelineStateAccessor &accessor, const PackedPipelineState &packedState) {
         gpu.shader->ResetPools();
 
         using PipelineStage = engine::Pipeline::Shader::Type;
         auto pipelineStage{[](u32 i) { return static_cast<PipelineStage>(i); }};
         auto stageIdx{[](PipelineStage stage) { return static_cast<u8>(stage); }};
 
-        std::array<Shader::IR::Program, engine::PipelineCount> programs;
+        auto pipelinePrograms{std::make_shared<PipelinePrograms>()};
+        pipelinePrograms->pools = gpu.shader->RetainPools();
+        pipelinePrograms->shaderHashes = packedState.shaderHashes;
+        auto &programs{pipelinePrograms->programs};
+        auto &programHashes{pipelinePrograms->programHashes};
         Shader::IR::Program *layerConversionSourceProgram{};
+        size_t layerConversionSourceHash{};
         bool ignoreVertexCullBeforeFetch{};
 
         for (u32 i{}; i < engine::PipelineCount; i++) {
             if (!packedState.shaderHashes[i]) {
-                if (i == stageIdx(PipelineStage::Geometry) && layerConversionSourceProgram)
-                    programs[i] = gpu.shader->GenerateGeometryPassthroughShader(*layerConversionSourceProgram, ConvertShaderOutputTopology(packedState.topology));
+                if (i == stageIdx(PipelineStage::Geometry) && layerConversionSourceProgram) {
+                    auto outputTopology{ConvertShaderOutputTopology(packedState.topology)};
+                    programs[i] = gpu.shader->GenerateGeometryPassthroughShader(*layerConversionSourceProgram, outputTopology);
+
+                    programHashes[i] = layerConversionSourceHash;
+                    boost::hash_combine(programHashes[i], i);
+                    boost::hash_combine(programHashes[i], static_cast<u32>(outputTopology));
+                }
 
                 continue;
             }
 
+            size_t &programHash{programHashes[i]};
+            boost::hash_combine(programHash, i);
+            boost::hash_combine(programHash, boost::hash_range(packedState.postVtgShaderAttributeSkipMask.begin(), packedState.postVtgShaderAttributeSkipMask.end()));
+            boost::hash_combine(programHash, static_cast<u32>(packedState.bindlessTextureConstantBufferSlotSelect));
+            boost::hash_combine(programHash, static_cast<bool>(packedState.viewportTransformEnable));
+
+            // Every value read from the environment during translation can affect the resulting program, so they're all folded into the program's hash as they're read
             auto binary{accessor.GetShaderBinary(i)};
             auto program{gpu.shader->ParseGraphicsShader(
                 packedState.postVtgShaderAttributeSkipMask,
@@ -224,40 +259,65 @@ namespace skyline::gpu::interconnect::maxwell3d {
                 packedState.viewportTransformEnable,
                 [&](u32 index, u32 offset) {
                     u32 shaderStage{i > 0 ? (i - 1) : 0};
-                    return accessor.GetConstantBufferValue(shaderStage, index, offset);
+                    u32 value{accessor.GetConstantBufferValue(shaderStage, index, offset)};
+                    boost::hash_combine(programHash, index);
+                    boost::hash_combine(programHash, offset);
+                    boost::hash_combine(programHash, value);
+                    return value;
                 }, [&](u32 index) {
-                    return accessor.GetTextureType(BindlessHandle{ .raw = index }.textureIndex);
+                    auto type{accessor.GetTextureType(BindlessHandle{ .raw = index }.textureIndex)};
+                    boost::hash_combine(programHash, index);
+                    boost::hash_combine(programHash, static_cast<u32>(type));
+                    return type;
                 })};
             if (i == stageIdx(PipelineStage::Vertex) && packedState.shaderHashes[stageIdx(PipelineStage::VertexCullBeforeFetch)]) {
                 ignoreVertexCullBeforeFetch = true;
                 programs[i] = gpu.shader->CombineVertexShaders(programs[stageIdx(PipelineStage::VertexCullBeforeFetch)], program, binary.binary);
+
+                boost::hash_combine(programHash, packedState.shaderHashes[stageIdx(PipelineStage::VertexCullBeforeFetch)]);
+                boost::hash_combine(programHash, programHashes[stageIdx(PipelineStage::VertexCullBeforeFetch)]);
             } else {
                 programs[i] = program;
             }
 
-            if (programs[i].info.requires_layer_emulation)
+            if (programs[i].info.requires_layer_emulation) {
                 layerConversionSourceProgram = &programs[i];
+                layerConversionSourceHash = programHash;
+                boost::hash_combine(layerConversionSourceHash, packedState.shaderHashes[i]);
+            }
         }
 
         bool hasGeometry{packedState.shaderHashes[stageIdx(PipelineStage::Geometry)] && !programs[stageIdx(PipelineStage::Geometry)].is_geometry_passthrough};
-        Shader::Backend::Bindings bindings{};
         Shader::IR::Program *lastProgram{};
 
-        std::array<ShaderStage, engine::ShaderStageCount> shaderStages{};
-
         for (u32 i{stageIdx(ignoreVertexCullBeforeFetch ? PipelineStage::Vertex : PipelineStage::VertexCullBeforeFetch)}; i < engine::PipelineCount; i++) {
             if (!packedState.shaderHashes[i] && !(i == stageIdx(PipelineStage::Geometry) && layerConversionSourceProgram))
                 continue;
 
-            auto runtimeInfo{MakeRuntimeInfo(packedState, programs[i], lastProgram, hasGeometry)};
-            shaderStages[i - (i >= 1 ? 1 : 0)] = {ConvertVkShaderStage(pipelineStage(i)),
-                                                  gpu.shader->CompileShader(runtimeInfo, programs[i], bindings, packedState.shaderHashes[i]),
-                                                  programs[i].info};
+            // The runtime info of each stage depends on the finalised info of the previous stage, so every program is prepared here even if compilation is deferred
+            auto &runtimeInfo{pipelinePrograms->runtimeInfos[i].emplace(MakeRuntimeInfo(packedState, programs[i], lastProgram, hasGeometry))};
+            gpu.shader->PrepareShader(runtimeInfo, programs[i]);
+            pipelinePrograms->shaderStages[i - (i >= 1 ? 1 : 0)] = {ConvertVkShaderStage(pipelineStage(i)), programs[i].info};
 
             lastProgram = &programs[i];
         }
 
-        return shaderStages;
+        return pipelinePrograms;
+    }
+
+    /**
+     * @brief Compiles all translated shaders in a pipeline
+     * @param shaderStageInfos The create info for each active shader stage in order, the modules of these are filled in
+     */
+    static void CompilePipelineShaders(GPU &gpu, PipelinePrograms &pipelinePrograms, span<vk::PipelineShaderStageCreateInfo> shaderStageInfos) {
+        Shader::Backend::Bindings bindings{};
+        auto stageInfoIt{shaderStageInfos.begin()};
+        for (u32 i{}; i < engine::PipelineCount; i++) {
+            if (!pipelinePrograms.runtimeInfos[i])
+                continue;
+
+            (stageInfoIt++)->module = gpu.shader->CompileShader(*pipelinePrograms.runtimeInfos[i], pipelinePrograms.programs[i], bindings, pipelinePrograms.shaderHashes[i], pipelinePrograms.programHashes[i]);
+        }
     }
 
     static vk::PipelineStageFlagBits ConvertShaderToPipelineStage(vk::ShaderStageFlagBits stage) {
@@ -282,7 +342,7 @@ namespace skyline::gpu::interconnect::maxwell3d {
 
         for (size_t i{}; i < engine::ShaderStageCount; i++) {
             const auto &stage{shaderStages[i]};
-            if (!stage.module)
+            if (stage.stage == vk::ShaderStageFlagBits{})
                 continue;
 
             auto &stageDescInfo{descriptorInfo.stages[i]};
@@ -459,7 +519,9 @@ namespace skyline::gpu::interconnect::maxwell3d {
             case engine::DrawTopology::TriangleFan:
                 return vk::PrimitiveTopology::eTriangleFan;
             case engine::DrawTopology::Quads:
-                return vk::PrimitiveTopology::eTriangleList; // Uses quad conversion
+            case engine::DrawTopology::QuadStrip:
+            case engine::DrawTopology::Polygon:
+                return vk::PrimitiveTopology::eTriangleList; // Uses quad conversion, on the CPU for direct draws and on the GPU for indirect draws
             case engine::DrawTopology::LineListAdjcy:
                 return vk::PrimitiveTopology::eLineListWithAdjacency;
             case engine::DrawTopology::LineStripAdjcy:
@@ -485,19 +547,31 @@ namespace skyline::gpu::interconnect::maxwell3d {
         }
     }
 
+    /**
+     * @param deferShaders If the shaders should be compiled by the pipeline assembler alongside the pipeline rather than prior to returning
+     */
     static GraphicsPipelineAssembler::CompiledPipeline MakeCompiledPipeline(GPU &gpu,
                                                                                  const PackedPipelineState &packedState,
-                                                                                 const std::array<ShaderStage, engine::ShaderStageCount> &shaderStages,
-                                                                                 span<vk::DescriptorSetLayoutBinding> layoutBindings) {
+                                                                                 const std::shared_ptr<PipelinePrograms> &pipelinePrograms,
+                                                                                 span<vk::DescriptorSetLayoutBinding> layoutBindings,
+                                                                                 bool deferShaders) {
+        const auto &shaderStages{pipelinePrograms->shaderStages};
         boost::container::static_vector<vk::PipelineShaderStageCreateInfo, engine::ShaderStageCount> shaderStageInfos;
         for (const auto &stage : shaderStages)
-            if (stage.module)
+            if (stage.stage != vk::ShaderStageFlagBits{})
                 shaderStageInfos.push_back(vk::PipelineShaderStageCreateInfo{
                     .stage = stage.stage,
-                    .module = &*stage.module,
                     .pName = "main"
                 });
 
+        GraphicsPipelineAssembler::ShaderStageCompiler compileShaders{[&gpu, pipelinePrograms](span<vk::PipelineShaderStageCreateInfo> stageInfos) {
+            CompilePipelineShaders(gpu, *pipelinePrograms, stageInfos);
+        }};
+        if (!deferShaders) {
+            compileShaders(shaderStageInfos);
+            compileShaders = {};
+        }
+
         boost::container::static_vector<vk::VertexInputBindingDescription, engine::VertexStreamCount> bindingDescs;
         boost::container::static_vector<vk::VertexInputBindingDivisorDescriptionEXT, engine::VertexStreamCount> bindingDivisorDescs;
         boost::container::static_vector<vk::VertexInputAttributeDescription, engine::VertexAttributeCount> attributeDescs;
@@ -659,14 +733,19 @@ namespace skyline::gpu::interconnect::maxwell3d {
             .depthStencilFormat = depthStencilFormat ? depthStencilFormat->vkFormat : vk::Format::eUndefined,
             .sampleCount = vk::SampleCountFlagBits::e1, //TODO: fix after MSAA support
             .destroyShaderModules = true
-        }, layoutBindings);
+        }, layoutBindings, {}, false, std::move(compileShaders));
     }
 
     Pipeline::Pipeline(GPU &gpu, PipelineStateAccessor &accessor, const PackedPipelineState &packedState)
         : sourcePackedState{packedState} {
-        auto shaderStages{MakePipelineShaders(gpu, accessor, sourcePackedState)};
+        auto pipelinePrograms{TranslatePipelineShaders(gpu, accessor, sourcePackedState)};
+        const auto &shaderStages{pipelinePrograms->shaderStages};
         descriptorInfo = MakePipelineDescriptorInfo(shaderStages, gpu.traits.quirks.needsIndividualTextureBindingWrites);
-        compiledPipeline = MakeCompiledPipeline(gpu, sourcePackedState, shaderStages, descriptorInfo.descriptorSetLayoutBindings);
+
+        // With async shaders, SPIR-V emission is deferred to the pipeline assembler's workers and the pipeline can't be used until they're done
+        // Dedicated compilation workers are already running off the GPFIFO thread and compile everything directly instead
+        pending = *gpu.getState().settings->useAsyncShaders && !ShaderManager::IsCompilationWorker();
+        compiledPipeline = MakeCompiledPipeline(gpu, sourcePackedState, pipelinePrograms, descriptorInfo.descriptorSetLayoutBindings, pending);
 
         for (u32 i{}; i < engine::ShaderStageCount; i++)
             if (shaderStages[i].stage != vk::ShaderStageFlagBits{})
@@ -676,6 +755,12 @@ namespace skyline::gpu::interconnect::maxwell3d {
         accessor.MarkComplete();
     }
 
+    bool Pipeline::IsPending() {
+        if (pending && compiledPipeline.IsCompiled())
+            pending = false;
+        return pending;
+    }
+
     void Pipeline::SyncCachedStorageBufferViews(ContextTag executionTag) {
         if (lastExecutionTag != executionTag) {
             for (auto &view : storageBufferViews)
@@ -944,82 +1029,203 @@ namespace skyline::gpu::interconnect::maxwell3d {
         });
     }
 
+    PipelineManager::BackgroundCompilation::BackgroundCompilation(u32 threadCount) : pool{threadCount} {}
+
+    PipelineManager::BackgroundCompilation::~BackgroundCompilation() {
+        // Any remaining queued workers will return immediately as there's nothing left for them to claim
+        std::scoped_lock lock{mutex};
+        pending.clear();
+        stopping = true;
+    }
+
+    Pipeline *PipelineManager::Insert(std::unique_ptr<Pipeline> pipeline) {
+        auto *pipelinePtr{map.emplace(pipeline->sourcePackedState, std::move(pipeline)).first.value().get()};
+
+        #ifdef PIPELINE_STATS
+        auto sharedIt{sharedPipelines.find(pipelinePtr->sourcePackedState.shaderHashes)};
+        if (sharedIt == sharedPipelines.end())
+            sharedPipelines.emplace(pipelinePtr->sourcePackedState.shaderHashes, std::list<Pipeline *>{pipelinePtr});
+        else
+            sharedIt->second.push_back(pipelinePtr);
+        #endif
+
+        return pipelinePtr;
+    }
+
+    std::unique_ptr<Pipeline> PipelineManager::CompileCached(GPU &gpu, const PipelineCacheManager::IndexEntry &entry) {
+        auto &cache{*gpu.graphicsPipelineCacheManager};
+        try {
+            PipelineStateBundle bundle;
+            cache.Read(entry, bundle);
+            auto accessor{FilePipelineStateAccessor{bundle}};
+            return std::make_unique<Pipeline>(gpu, accessor, bundle.GetKey<PackedPipelineState>());
+        } catch (const exception &e) {
+            // Only the invalid record is removed from the cache as every other record is independent of it
+            LOGW("Pipeline cache record corrupted at: 0x{:X}, error: {}", entry.offset, e.what());
+            cache.Invalidate(entry.keyHash);
+            return nullptr;
+        }
+    }
+
     PipelineManager::PipelineManager(GPU &gpu, JvmManager &jvm) {
         if (!gpu.graphicsPipelineCacheManager)
             return;
 
-        std::atomic<u32> compiledCount{};
-        auto [stream, totalPipelineCount]{gpu.graphicsPipelineCacheManager->OpenReadStream()};
-        i64 lastKnownGoodOffset{stream.tellg()};
+        auto &cache{*gpu.graphicsPipelineCacheManager};
+        auto index{cache.GetIndex()};
 
-        jvm.ShowPipelineLoadingScreen(totalPipelineCount);
-        gpu.graphicsPipelineAssembler->RegisterCompilationCallback([&]() {
-            jvm.UpdatePipelineLoadingProgress(++compiledCount);
-        });
+        if (*gpu.getState().settings->lazyPipelineLoading) {
+            // Pipelines which were used most recently and then most frequently are compiled first as they're the most likely to be required soon after boot
+            std::stable_sort(index.begin(), index.end(), [](const auto &a, const auto &b) {
+                return a.lastUsed != b.lastUsed ? a.lastUsed > b.lastUsed : a.useCount > b.useCount;
+            });
+
+            // Only half of the cores are used so that emulation isn't starved, any pipelines that are required before they've been compiled are compiled on demand in FindOrCreate
+            background = std::make_unique<BackgroundCompilation>(gpu.traits.quirks.brokenMultithreadedPipelineCompilation ? 1U : std::max(std::thread::hardware_concurrency() / 2, 1U));
+            for (const auto &entry : index)
+                background->pending.emplace(entry.keyHash, entry);
+            background->remainingTasks = index.size();
 
-        try {
             auto startTime{util::GetTimeNs()};
-            PipelineStateBundle bundle;
+            for (const auto &entry : index) {
+                std::ignore = background->pool.submit_task([&gpu, &state = *background, keyHash = entry.keyHash, startTime]() {
+                    std::unique_lock lock{state.mutex};
+                    // If the pipeline isn't pending then it has already been compiled on demand or the manager is being destroyed
+                    if (auto it{state.pending.find(keyHash)}; it != state.pending.end()) {
+                        auto claimed{it->second};
+                        state.pending.erase(it);
+                        state.compiling.emplace(keyHash);
+                        lock.unlock();
+
+                        ShaderManager::MarkCompilationWorker();
+                        auto pipeline{CompileCached(gpu, claimed)};
+
+                        lock.lock();
+                        state.compiling.erase(keyHash);
+                        if (pipeline)
+                            state.compiled.emplace_back(std::move(pipeline));
+                        state.compiledCondition.notify_all();
+                    }
 
-            while (bundle.Deserialise(stream)) {
-                lastKnownGoodOffset = stream.tellg();
-                auto accessor{FilePipelineStateAccessor{bundle}};
-                auto *pipeline{map.emplace(bundle.GetKey<PackedPipelineState>(), std::make_unique<Pipeline>(gpu, accessor, bundle.GetKey<PackedPipelineState>())).first.value().get()};
-                #ifdef PIPELINE_STATS
-                auto sharedIt{sharedPipelines.find(pipeline->sourcePackedState.shaderHashes)};
-                if (sharedIt == sharedPipelines.end())
-                    sharedPipelines.emplace(pipeline->sourcePackedState.shaderHashes, std::list<Pipeline *>{pipeline});
-                else
-                    sharedIt->second.push_back(pipeline);
-                #else
-                (void)pipeline;
-                #endif
+                    // The Vulkan pipeline cache is only saved once all cached pipelines have been compiled as it'd otherwise be missing most of them
+                    if (--state.remainingTasks == 0 && !state.stopping) {
+                        LOGI("Compiled all cached graphics pipelines in the background in {}ms", (util::GetTimeNs() - startTime) / constant::NsInMillisecond);
+                        gpu.graphicsPipelineAssembler->SavePipelineCache();
+                    }
+                });
             }
 
-            gpu.graphicsPipelineAssembler->WaitIdle();
-            LOGI("Loaded {} graphics pipelines in {}ms", map.size(), (util::GetTimeNs() - startTime) / constant::NsInMillisecond);
+            LOGI("Queued {} cached graphics pipelines for background compilation", index.size());
+            return;
+        }
+
+        std::atomic<u32> compiledCount{};
+        jvm.ShowPipelineLoadingScreen(static_cast<u32>(index.size()));
+        gpu.graphicsPipelineAssembler->RegisterCompilationCallback([&]() {
+            jvm.UpdatePipelineLoadingProgress(++compiledCount);
+        });
+
+        auto startTime{util::GetTimeNs()};
 
-            gpu.graphicsPipelineAssembler->SavePipelineCache();
+        {
+            // Records can be read in any order from the mapped cache, so deserialisation, shader translation, SPIR-V emission and pipeline assembly are all done independently for every pipeline across all cores
+            // The shader manager uses separate object pools for each worker so they don't contend on anything
+            BS::thread_pool<BS::tp::none> compilationPool{gpu.traits.quirks.brokenMultithreadedPipelineCompilation ? 1U : 0U};
+            std::vector<std::future<std::unique_ptr<Pipeline>>> pipelineFutures;
+            pipelineFutures.reserve(index.size());
 
-            #ifdef PIPELINE_STATS
-            for (auto &[key, list] : sharedPipelines) {
-                sortedSharedPipelines.push_back(&list);
+            for (const auto &entry : index) {
+                pipelineFutures.emplace_back(compilationPool.submit_task([&gpu, &entry]() {
+                    ShaderManager::MarkCompilationWorker();
+                    return CompileCached(gpu, entry);
+                }));
             }
-            std::sort(sortedSharedPipelines.begin(), sortedSharedPipelines.end(), [](const auto &a, const auto &b) {
-                return a->size() > b->size();
-            });
 
-            raise(SIGTRAP);
-            #endif
+            for (auto &future : pipelineFutures)
+                if (auto pipeline{future.get()})
+                    Insert(std::move(pipeline));
+        }
+
+        gpu.graphicsPipelineAssembler->WaitIdle();
+        LOGI("Loaded {} graphics pipelines in {}ms", map.size(), (util::GetTimeNs() - startTime) / constant::NsInMillisecond);
 
-        } catch (const exception &e) {
-            LOGW("Pipeline cache corrupted at: 0x{:X}, error: {}", lastKnownGoodOffset, e.what());
-            gpu.graphicsPipelineCacheManager->InvalidateAllAfter(static_cast<u64>(lastKnownGoodOffset));
+        gpu.graphicsPipelineAssembler->SavePipelineCache();
+
+        #ifdef PIPELINE_STATS
+        for (auto &[key, list] : sharedPipelines) {
+            sortedSharedPipelines.push_back(&list);
         }
+        std::sort(sortedSharedPipelines.begin(), sortedSharedPipelines.end(), [](const auto &a, const auto &b) {
+            return a->size() > b->size();
+        });
+
+        raise(SIGTRAP);
+        #endif
 
         gpu.graphicsPipelineAssembler->UnregisterCompilationCallback();
         jvm.HidePipelineLoadingScreen();
     }
 
+    Pipeline *PipelineManager::FindLazy(GPU &gpu, const PackedPipelineState &packedState) {
+        u64 keyHash{PipelineCacheManager::HashKey(packedState)};
+        PipelineCacheManager::IndexEntry claimed;
+        {
+            std::unique_lock lock{background->mutex};
+            while (true) {
+                // Insert any pipelines that workers have finished compiling since the last lookup
+                for (auto &pipeline : background->compiled)
+                    Insert(std::move(pipeline));
+                background->compiled.clear();
+
+                auto it{map.find(packedState)};
+                if (it != map.end())
+                    return it->second.get();
+
+                // If a worker is already compiling the pipeline then waiting on it is cheaper than compiling it again
+                if (!background->compiling.contains(keyHash))
+                    break;
+                background->compiledCondition.wait(lock);
+            }
+
+            auto it{background->pending.find(keyHash)};
+            if (it == background->pending.end())
+                return nullptr;
+
+            claimed = it->second;
+            background->pending.erase(it);
+        }
+
+        // The pipeline is claimed from the pending set so it jumps ahead of all queued background compilation
+        auto pipeline{CompileCached(gpu, claimed)};
+        if (!pipeline)
+            return nullptr;
+
+        // The key hash could collide with that of another pipeline, in which case this pipeline is still inserted but the requested one has to be created at runtime
+        auto *pipelinePtr{Insert(std::move(pipeline))};
+        return pipelinePtr->sourcePackedState == packedState ? pipelinePtr : nullptr;
+    }
+
     Pipeline *PipelineManager::FindOrCreate(InterconnectContext &ctx, Textures &textures, ConstantBufferSet &constantBuffers, const PackedPipelineState &packedState, const std::array<ShaderBinary, engine::PipelineCount> &shaderBinaries) {
-        auto it{map.find(packedState)};
-        if (it != map.end())
-            return it->second.get();
+        Pipeline *pipeline{};
+        if (auto it{map.find(packedState)}; it != map.end())
+            pipeline = it->second.get();
+        else if (background)
+            pipeline = FindLazy(ctx.gpu, packedState);
+
+        if (pipeline) {
+            // Usage is only recorded for pipelines that were loaded from the cache, it's implied for any pipelines that are created at runtime when they're merged into the cache
+            if (!pipeline->usageRecorded && ctx.gpu.graphicsPipelineCacheManager) {
+                ctx.gpu.graphicsPipelineCacheManager->MarkUsed(PipelineCacheManager::HashKey(packedState));
+                pipeline->usageRecorded = true;
+            }
+            return pipeline;
+        }
 
         auto bundle{std::make_unique<PipelineStateBundle>()};
         bundle->Reset(packedState);
         auto accessor{RuntimeGraphicsPipelineStateAccessor{std::move(bundle), ctx, textures, constantBuffers, shaderBinaries}};
-        auto *pipeline{map.emplace(packedState, std::make_unique<Pipeline>(ctx.gpu, accessor, packedState)).first->second.get()};
-
-        #ifdef PIPELINE_STATS
-        auto sharedIt{sharedPipelines.find(pipeline->sourcePackedState.shaderHashes)};
-        if (sharedIt == sharedPipelines.end())
-            sharedPipelines.emplace(pipeline->sourcePackedState.shaderHashes, std::list<Pipeline *>{pipeline});
-        else
-            sharedIt->second.push_back(pipeline);
-        #endif
-
+        pipeline = Insert(std::make_unique<Pipeline>(ctx.gpu, accessor, packedState));
+        pipeline->usageRecorded = true;
         return pipeline;
     }
 }
-
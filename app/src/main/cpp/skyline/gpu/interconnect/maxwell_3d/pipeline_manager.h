@@ -8,6 +8,7 @@
 #include <tsl/robin_map.h>
 #include <shader_compiler/frontend/ir/program.h>
 #include <gpu/graphics_pipeline_assembler.h>
+#include <gpu/pipeline_cache_manager.h>
 #include <gpu/interconnect/common/samplers.h>
 #include <gpu/interconnect/common/textures.h>
 #include <gpu/interconnect/common/pipeline_state_accessor.h>
@@ -213,6 +214,7 @@ namespace skyline::gpu::interconnect::maxwell3d {
         };
 
         PackedPipelineState sourcePackedState;
+        bool usageRecorded{}; //!< If the use of this pipeline during this run has been recorded in the pipeline cache
 
       private:
         std::vector<CachedMappedBufferView> storageBufferViews;
@@ -221,6 +223,7 @@ namespace skyline::gpu::interconnect::maxwell3d {
         u8 transitionCacheNextIdx{}; //!< The next index to insert into the transition cache
         u8 stageMask{}; //!< Bitmask of active shader stages
         u16 sampledImageCount{};
+        bool pending{}; //!< If the shaders and pipeline are still being compiled asynchronously, this is only updated by IsPending
 
         std::array<Pipeline *, 6> transitionCache{};
 
@@ -233,6 +236,11 @@ namespace skyline::gpu::interconnect::maxwell3d {
 
         Pipeline(GPU &gpu, PipelineStateAccessor &accessor, const PackedPipelineState &packedState);
 
+        /**
+         * @return If the pipeline is still being compiled asynchronously, draws must not use the pipeline until this returns false
+         */
+        bool IsPending();
+
         /**
          * @brief Returns the pipeline in the transition cache (if present) that matches the given state
          */
@@ -267,12 +275,49 @@ namespace skyline::gpu::interconnect::maxwell3d {
       private:
         tsl::robin_map<PackedPipelineState, std::unique_ptr<Pipeline>, PackedPipelineStateHash> map;
 
+        /**
+         * @brief State for compiling cached pipelines in the background when they're loaded lazily
+         */
+        struct BackgroundCompilation {
+            std::mutex mutex; //!< Protects all members other than the pool
+            std::condition_variable compiledCondition; //!< Signalled whenever a worker finishes compiling a pipeline
+            std::unordered_map<u64, PipelineCacheManager::IndexEntry> pending; //!< Cached pipelines which haven't been claimed for compilation yet, keyed by their key hash
+            std::unordered_set<u64> compiling; //!< Key hashes of the pipelines which are currently being compiled by workers
+            std::vector<std::unique_ptr<Pipeline>> compiled; //!< Pipelines which were compiled by workers but are yet to be inserted into the map
+            size_t remainingTasks{}; //!< The amount of worker tasks which haven't finished yet, including those that have nothing left to claim
+            bool stopping{}; //!< If the manager is being destroyed and workers should exit without doing anything
+            BS::thread_pool<BS::tp::none> pool; //!< This is declared last so that all workers are joined prior to the rest of the state being destroyed
+
+            BackgroundCompilation(u32 threadCount);
+
+            ~BackgroundCompilation();
+        };
+
+        std::unique_ptr<BackgroundCompilation> background; //!< This is only created when cached pipelines are loaded lazily
+
         #ifdef PIPELINE_STATS
         std::unordered_map<std::array<u64, engine::PipelineCount>, std::list<Pipeline*>, util::ObjectHash<std::array<u64, engine::PipelineCount>>> sharedPipelines; //!< Maps a shader set to all pipelines sharing that same set
         std::vector<std::list<Pipeline*>*> sortedSharedPipelines; //!< Sorted list of shared pipelines
         #endif
 
+        Pipeline *Insert(std::unique_ptr<Pipeline> pipeline);
+
+        /**
+         * @brief Compiles the pipeline for an entry in the pipeline cache, any corrupted records are invalidated
+         * @return The compiled pipeline or nullptr if the record was corrupted
+         */
+        static std::unique_ptr<Pipeline> CompileCached(GPU &gpu, const PipelineCacheManager::IndexEntry &entry);
+
+        /**
+         * @brief Attempts to find the pipeline for the given state amongst the cached pipelines that are being loaded lazily, if it hasn't been compiled yet then it's compiled immediately on the calling thread
+         * @return The pipeline or nullptr if the state isn't in the pipeline cache
+         */
+        Pipeline *FindLazy(GPU &gpu, const PackedPipelineState &packedState);
+
       public:
+        /**
+         * @note If lazy pipeline loading is enabled then only the index of the pipeline cache is loaded here and all cached pipelines are compiled in the background in the order of how recently and frequently they were used
+         */
         PipelineManager(GPU &gpu, JvmManager &jvm);
 
         Pipeline *FindOrCreate(InterconnectContext &ctx, Textures &textures, ConstantBufferSet &constantBuffers, const PackedPipelineState &packedState, const std::array<ShaderBinary, engine::PipelineCount> &shaderBinaries);
@@ -209,8 +209,25 @@ namespace skyline::gpu::interconnect::maxwell3d {
         return currentEngineTopology;
     }
 
+    std::optional<conversion::quads::Topology> InputAssemblyState::GetQuadConversionTopology(engine::DrawTopology topology) {
+        switch (topology) {
+            case engine::DrawTopology::Quads:
+                return conversion::quads::Topology::Quads;
+            case engine::DrawTopology::QuadStrip:
+                return conversion::quads::Topology::QuadStrip;
+            case engine::DrawTopology::Polygon:
+                return conversion::quads::Topology::Polygon;
+            default:
+                return std::nullopt;
+        }
+    }
+
+    std::optional<conversion::quads::Topology> InputAssemblyState::GetQuadConversionTopology() const {
+        return GetQuadConversionTopology(currentEngineTopology);
+    }
+
     bool InputAssemblyState::NeedsQuadConversion() const {
-        return currentEngineTopology == engine::DrawTopology::Quads;
+        return GetQuadConversionTopology().has_value();
     }
 
     /* Tessellation State */
@@ -6,6 +6,7 @@
 #include <boost/container/static_vector.hpp>
 #include <gpu/texture/texture.h>
 #include <gpu/interconnect/common/shader_cache.h>
+#include <gpu/interconnect/conversion/quads.h>
 #include "common.h"
 #include "packed_pipeline_state.h"
 #include "pipeline_manager.h"
@@ -132,6 +133,13 @@ namespace skyline::gpu::interconnect::maxwell3d {
 
         engine::DrawTopology GetPrimitiveTopology() const;
 
+        /**
+         * @return The conversion to a triangle list needed to emulate the supplied topology, if any
+         */
+        static std::optional<conversion::quads::Topology> GetQuadConversionTopology(engine::DrawTopology topology);
+
+        std::optional<conversion::quads::Topology> GetQuadConversionTopology() const;
+
         bool NeedsQuadConversion() const;
     };
 
@@ -128,8 +128,9 @@ namespace skyline::gpu::memory {
 
         /**
          * @brief Creates a buffer which is optimized for staging (Transfer Source)
+         * @param usage Any usage flags required in addition to transfer source and destination, such as for the buffer to be accessed by a shader
          */
-        std::shared_ptr<StagingBuffer> AllocateStagingBuffer(vk::DeviceSize size);
+        std::shared_ptr<StagingBuffer> AllocateStagingBuffer(vk::DeviceSize size, vk::BufferUsageFlags usage = {});
 
         /**
          * @brief Creates a buffer with a CPU mapping and all usage flags
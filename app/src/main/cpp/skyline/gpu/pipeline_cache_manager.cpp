@@ -2,17 +2,35 @@
 // Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
 
 #include <fstream>
+#include <range/v3/algorithm.hpp>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include <os.h>
 #include "pipeline_cache_manager.h"
 
 namespace skyline::gpu {
+    /*  File format pseudocode:
+        PipelineCacheFileHeader header;
+
+        struct Record {
+            u64 keyHash;
+            u8 bundle[]; // A serialised PipelineStateBundle, this is what index entries point to
+        } records[]; // Records are only ever appended and each key is present at most once in the main file
+
+        PipelineCacheManager::IndexEntry index[footer.count];
+        PipelineCacheFileFooter footer;
+
+        The staging file has the same format but without the index and footer, records in it are validated and merged into the main file on the next boot
+        The index is rewritten on every boot and periodically at runtime to update the usage statistics of each pipeline, the records themselves are never modified
+    */
+
     struct PipelineCacheFileHeader {
         static constexpr u32 Magic{util::MakeMagic<u32>("PCHE")}; //!< The magic value used to identify a pipeline cache file
-        static constexpr u32 Version{3}; //!< The version of the pipeline cache file format, MUST be incremented for any format changes
+        static constexpr u32 Version{5}; //!< The version of the pipeline cache file format, MUST be incremented for any format changes
 
         u32 magic{Magic};
         u32 version{Version};
-        u32 count{0}; //!< The total number of pipeline cache bundles in the file
 
         auto operator<=>(const PipelineCacheFileHeader &) const = default;
 
@@ -24,65 +42,194 @@ namespace skyline::gpu {
         }
     };
 
+    struct PipelineCacheFileFooter {
+        static constexpr u32 Magic{util::MakeMagic<u32>("PIDX")}; //!< The magic value used to identify a valid pipeline cache index
+
+        u64 indexOffset; //!< The offset of the index in the file, this is also the end of the last record
+        u32 count; //!< The amount of entries in the index
+        u32 bootCount; //!< The amount of times the cache has been loaded
+        u32 _pad_{};
+        u32 magic{Magic};
+
+        bool IsValid() {
+            return magic == Magic;
+        }
+    };
+    static_assert(sizeof(PipelineCacheFileFooter) == 0x18);
+
+    constexpr size_t RecordPrefixSize{sizeof(u64) + sizeof(u64) + sizeof(u32)}; //!< The size of the key hash and the bundle's hash and size which prefix the data of every record
+    constexpr auto UsageWriteInterval{std::chrono::seconds(30)}; //!< The minimum interval between writes of the index to update the usage statistics at runtime
+
+    u64 PipelineCacheManager::HashKey(span<const u8> key) {
+        return XXH3_64bits(key.data(), key.size());
+    }
+
     void PipelineCacheManager::Run() {
         std::ofstream stream{stagingPath, std::ios::binary | std::ios::trunc};
         PipelineCacheFileHeader header{};
         stream.write(reinterpret_cast<const char *>(&header), sizeof(PipelineCacheFileHeader));
+        stream.flush();
 
+        auto lastIndexWrite{std::chrono::steady_clock::now()};
         while (true) {
             std::unique_lock lock(writeMutex);
-            if (writeQueue.empty())
-                stream.flush();
-
-            writeCondition.wait(lock, [this] { return !writeQueue.empty(); });
-            auto bundle{std::move(writeQueue.front())};
-            writeQueue.pop();
+            writeCondition.wait_for(lock, UsageWriteInterval, [this] { return !writeQueue.empty() || stopWriter; });
+            auto batch{std::move(writeQueue)};
+            writeQueue = {};
+            bool stop{stopWriter};
             lock.unlock();
 
-            bundle->Serialise(stream);
+            // All bundles queued since the last commit are written out together and committed with a single flush, records are self-validating so there's no header to update
+            while (!batch.empty()) {
+                auto &bundle{batch.front()};
+                u64 keyHash{HashKey(bundle->GetKey())};
+                stream.write(reinterpret_cast<const char *>(&keyHash), sizeof(keyHash));
+                bundle->Serialise(stream);
+                batch.pop();
+            }
+            stream.flush();
+
+            // Usage statistics are only written out at an interval as they aren't critical and don't need to be committed immediately
+            if (stop || std::chrono::steady_clock::now() - lastIndexWrite >= UsageWriteInterval) {
+                std::scoped_lock indexLock{indexMutex};
+                if (usageDirty) {
+                    WriteIndex();
+                    usageDirty = false;
+                }
+                lastIndexWrite = std::chrono::steady_clock::now();
+            }
 
-            header.count++;
-            // Rewrite the header with the updated count
-            auto savedPosition{stream.tellp()};
-            stream.seekp(0, std::ios_base::beg);
-            stream.write(reinterpret_cast<const char *>(&header), sizeof(PipelineCacheFileHeader));
-            stream.seekp(savedPosition);
+            if (stop)
+                return;
         }
     }
 
-    bool PipelineCacheManager::ValidateHeader(std::ifstream &stream) {
-        if (stream.fail())
-            return false;
+    void PipelineCacheManager::ReadIndex() {
+        std::ifstream stream{mainPath, std::ios::binary | std::ios::ate};
+        u64 size{static_cast<u64>(stream.tellg())};
 
-        PipelineCacheFileHeader header{};
-        stream.read(reinterpret_cast<char *>(&header), sizeof(PipelineCacheFileHeader));
-        return header.IsValid();
+        if (size >= sizeof(PipelineCacheFileHeader) + sizeof(PipelineCacheFileFooter)) {
+            PipelineCacheFileFooter footer{};
+            stream.seekg(static_cast<std::streamoff>(size - sizeof(PipelineCacheFileFooter)));
+            stream.read(reinterpret_cast<char *>(&footer), sizeof(PipelineCacheFileFooter));
+
+            if (footer.IsValid() && footer.indexOffset >= sizeof(PipelineCacheFileHeader) && footer.indexOffset + footer.count * sizeof(IndexEntry) + sizeof(PipelineCacheFileFooter) == size) {
+                index.resize(footer.count);
+                stream.seekg(static_cast<std::streamoff>(footer.indexOffset));
+                stream.read(reinterpret_cast<char *>(index.data()), static_cast<std::streamsize>(footer.count * sizeof(IndexEntry)));
+
+                bool valid{!stream.fail()};
+                for (size_t i{}; valid && i < index.size(); i++) {
+                    const auto &entry{index[i]};
+                    valid = entry.offset >= sizeof(PipelineCacheFileHeader) && entry.offset + entry.size <= footer.indexOffset && indexMap.try_emplace(entry.keyHash, i).second;
+                }
+
+                if (valid) {
+                    recordsEnd = footer.indexOffset;
+                    bootCount = footer.bootCount;
+                    return;
+                }
+            }
+
+            LOGW("Rebuilding invalid pipeline cache index");
+        }
+
+        // The index is missing or invalid, this occurs when the emulator exits while the index is being written, it's rebuilt from the records which are all prefixed with their key hash
+        // Usage statistics are stored solely in the index and are lost when it's rebuilt
+        index.clear();
+        indexMap.clear();
+        stream.clear();
+
+        std::vector<u8> bundle;
+        u64 offset{sizeof(PipelineCacheFileHeader)};
+        while (offset + RecordPrefixSize <= size) {
+            u64 keyHash{}, bundleHash{};
+            u32 bundleSize{};
+            stream.seekg(static_cast<std::streamoff>(offset));
+            stream.read(reinterpret_cast<char *>(&keyHash), sizeof(keyHash));
+            stream.read(reinterpret_cast<char *>(&bundleHash), sizeof(bundleHash));
+            stream.read(reinterpret_cast<char *>(&bundleSize), sizeof(bundleSize));
+
+            u64 recordSize{RecordPrefixSize + bundleSize};
+            if (stream.fail() || offset + recordSize > size)
+                break;
+
+            // Records are validated in the same way as when merging staging records, a mismatch means that the remainder of the file can't be trusted to be a sequence of records
+            bundle.resize(bundleSize);
+            stream.read(reinterpret_cast<char *>(bundle.data()), static_cast<std::streamsize>(bundleSize));
+            if (stream.fail() || XXH64(bundle.data(), bundleSize, 0) != bundleHash) {
+                LOGW("Discarding invalid pipeline cache records at 0x{:X}", offset);
+                break;
+            }
+
+            // Any duplicate records are skipped, only the first record for a key is indexed
+            if (indexMap.try_emplace(keyHash, index.size()).second)
+                index.push_back({keyHash, offset + sizeof(u64), static_cast<u32>(recordSize - sizeof(u64)), 0, 0});
+            offset += recordSize;
+        }
+
+        recordsEnd = offset;
+    }
+
+    void PipelineCacheManager::WriteIndex() {
+        {
+            std::fstream stream{mainPath, std::ios::binary | std::ios::in | std::ios::out};
+            stream.seekp(static_cast<std::streamoff>(recordsEnd));
+            stream.write(reinterpret_cast<const char *>(index.data()), static_cast<std::streamsize>(index.size() * sizeof(IndexEntry)));
+
+            PipelineCacheFileFooter footer{
+                .indexOffset = recordsEnd,
+                .count = static_cast<u32>(index.size()),
+                .bootCount = bootCount,
+            };
+            stream.write(reinterpret_cast<const char *>(&footer), sizeof(PipelineCacheFileFooter));
+        }
+
+        std::filesystem::resize_file(mainPath, recordsEnd + index.size() * sizeof(IndexEntry) + sizeof(PipelineCacheFileFooter));
     }
 
     void PipelineCacheManager::MergeStaging() {
-        std::ifstream stagingStream{stagingPath, std::ios::binary};
+        std::ifstream stagingStream{stagingPath, std::ios::binary | std::ios::ate};
         if (stagingStream.fail())
             return; // If the staging file doesn't exist then there's nothing to merge
 
-        PipelineCacheFileHeader stagingHeader{};
-        stagingStream.read(reinterpret_cast<char *>(&stagingHeader), sizeof(PipelineCacheFileHeader));
-        if (!stagingHeader.IsValid()) {
+        std::vector<u8> staging(static_cast<size_t>(stagingStream.tellg()));
+        stagingStream.seekg(0, std::ios_base::beg);
+        stagingStream.read(reinterpret_cast<char *>(staging.data()), static_cast<std::streamsize>(staging.size()));
+
+        auto data{span(staging)};
+        if (stagingStream.fail() || data.size() < sizeof(PipelineCacheFileHeader) || !data.as<PipelineCacheFileHeader>().IsValid()) {
             LOGW("Discarding invalid pipeline cache staging file");
             return;
         }
 
         std::fstream mainStream{mainPath, std::ios::binary | std::ios::in | std::ios::out};
-        PipelineCacheFileHeader mainHeader{};
-        mainStream.seekg(0, std::ios_base::beg);
-        mainStream.read(reinterpret_cast<char *>(&mainHeader), sizeof(PipelineCacheFileHeader));
+        mainStream.seekp(static_cast<std::streamoff>(recordsEnd));
 
-        // Update the main header with the new count
-        mainHeader.count += stagingHeader.count;
-        mainStream.seekp(0, std::ios_base::beg);
-        mainStream.write(reinterpret_cast<const char *>(&mainHeader), sizeof(PipelineCacheFileHeader));
+        size_t offset{sizeof(PipelineCacheFileHeader)};
+        while (offset + RecordPrefixSize <= data.size()) {
+            u64 keyHash{data.subspan(offset).as<u64>()};
+            u64 bundleHash{data.subspan(offset + sizeof(u64)).as<u64>()};
+            u32 bundleSize{data.subspan(offset + sizeof(u64) * 2).as<u32>()};
+            size_t recordSize{RecordPrefixSize + bundleSize};
 
-        mainStream.seekp(0, std::ios::end);
-        mainStream << stagingStream.rdbuf();
+            // This occurs when the emulator exits while a batch is being written, only the records prior to that are merged
+            if (offset + recordSize > data.size() || XXH64(data.data() + offset + RecordPrefixSize, bundleSize, 0) != bundleHash) {
+                LOGW("Discarding invalid pipeline cache staging records at 0x{:X}", offset);
+                break;
+            }
+
+            if (!indexMap.contains(keyHash)) {
+                mainStream.write(reinterpret_cast<const char *>(data.data() + offset), static_cast<std::streamsize>(recordSize));
+
+                // Staged pipelines were all created and used during the previous run
+                indexMap.emplace(keyHash, index.size());
+                index.push_back({keyHash, recordsEnd + sizeof(u64), static_cast<u32>(recordSize - sizeof(u64)), 1, bootCount});
+                recordsEnd += recordSize;
+            }
+
+            offset += recordSize;
+        }
     }
 
     PipelineCacheManager::PipelineCacheManager(const DeviceState &state, const std::string &path)
@@ -90,45 +237,108 @@ namespace skyline::gpu {
         bool didExist{std::filesystem::exists(mainPath)};
         if (didExist) { // If the main file exists then we need to validate it
             std::ifstream mainStream{mainPath, std::ios::binary};
-            if (!ValidateHeader(mainStream)) { // Force a recreation of the file if it's invalid
+            PipelineCacheFileHeader header{};
+            mainStream.read(reinterpret_cast<char *>(&header), sizeof(PipelineCacheFileHeader));
+            if (mainStream.fail() || !header.IsValid()) { // Force a recreation of the file if it's invalid
                 LOGW("Discarding invalid pipeline cache main file");
                 std::filesystem::remove(mainPath);
                 didExist = false;
             }
         }
 
-        if (!didExist) { // If the main file didn't exist we need to write the header
+        if (!didExist) { // If the main file didn't exist we need to write the header, the index is written below
             std::filesystem::create_directories(std::filesystem::path{mainPath}.parent_path());
             std::ofstream mainStream{mainPath, std::ios::binary | std::ios::app};
             PipelineCacheFileHeader header{};
             mainStream.write(reinterpret_cast<const char *>(&header), sizeof(PipelineCacheFileHeader));
         }
 
-        // Merge any staging changes into the main file before starting the writer thread
+        // Merge any staging changes into the main file before mapping it and starting the writer thread, the index is always rewritten to update the boot count
+        ReadIndex();
         MergeStaging();
+        bootCount++;
+        WriteIndex();
+
+        int fd{open(mainPath.c_str(), O_RDONLY | O_CLOEXEC)};
+        if (fd < 0)
+            throw exception("Failed to open pipeline cache: {}", strerror(errno));
+
+        // Only the records are mapped as the index is rewritten in-place on any invalidations
+        auto pointer{static_cast<u8 *>(mmap(nullptr, recordsEnd, PROT_READ, MAP_SHARED, fd, 0))};
+        close(fd); // The mapping holds a reference to the file
+        if (pointer == MAP_FAILED) [[unlikely]]
+            throw exception("Failed to map pipeline cache: {}", strerror(errno));
+        mapping = span<u8>{pointer, recordsEnd};
+
         writerThread = std::thread(&PipelineCacheManager::Run, this);
     }
 
+    PipelineCacheManager::~PipelineCacheManager() {
+        {
+            std::scoped_lock lock{writeMutex};
+            stopWriter = true;
+            writeCondition.notify_one();
+        }
+        writerThread.join();
+
+        if (mapping.valid())
+            munmap(mapping.data(), mapping.size());
+    }
+
     void PipelineCacheManager::QueueWrite(std::unique_ptr<interconnect::PipelineStateBundle> bundle) {
+        u64 keyHash{HashKey(bundle->GetKey())};
+        {
+            std::scoped_lock lock{indexMutex};
+            if (indexMap.contains(keyHash))
+                return;
+        }
+
         std::scoped_lock lock{writeMutex};
+        if (!queuedKeys.insert(keyHash).second)
+            return;
+
         writeQueue.emplace(std::move(bundle));
         writeCondition.notify_one();
     }
 
-    std::pair<std::ifstream, u32> PipelineCacheManager::OpenReadStream() {
-        auto mainStream{std::ifstream{mainPath, std::ios::binary}};
-        if (mainStream.fail())
-            throw exception("Pipeline cache main file missing at runtime!");
+    std::vector<PipelineCacheManager::IndexEntry> PipelineCacheManager::GetIndex() {
+        std::scoped_lock lock{indexMutex};
+        return index;
+    }
 
-        PipelineCacheFileHeader header{};
-        mainStream.read(reinterpret_cast<char *>(&header), sizeof(PipelineCacheFileHeader));
-        if (!header.IsValid())
-            throw exception("Pipeline cache main file corrupted at runtime!");
+    void PipelineCacheManager::Read(const IndexEntry &entry, interconnect::PipelineStateBundle &bundle) {
+        if (entry.offset + entry.size > mapping.size())
+            throw exception("Pipeline cache record out of bounds: 0x{:X}-0x{:X}", entry.offset, entry.offset + entry.size);
 
-        return {std::move(mainStream), header.count};
+        bundle.Deserialise(mapping.subspan(entry.offset, entry.size));
     }
 
-    void PipelineCacheManager::InvalidateAllAfter(u64 offset) {
-        std::filesystem::resize_file(mainPath, offset);
+    void PipelineCacheManager::Invalidate(u64 keyHash) {
+        std::scoped_lock lock{indexMutex};
+        auto it{indexMap.find(keyHash)};
+        if (it == indexMap.end())
+            return;
+
+        index.erase(index.begin() + static_cast<ssize_t>(it->second));
+        indexMap.clear();
+        for (size_t i{}; i < index.size(); i++)
+            indexMap.emplace(index[i].keyHash, i);
+
+        // The record itself is left in the file as it's unreferenced, only the index is rewritten
+        WriteIndex();
+    }
+
+    void PipelineCacheManager::MarkUsed(u64 keyHash) {
+        std::scoped_lock lock{indexMutex};
+        auto it{indexMap.find(keyHash)};
+        if (it == indexMap.end())
+            return;
+
+        auto &entry{index[it->second]};
+        if (entry.lastUsed != bootCount) {
+            entry.useCount++;
+            entry.lastUsed = bootCount;
+            usageDirty = true;
+        }
     }
 }
@@ -4,45 +4,105 @@
 #pragma once
 
 #include <queue>
+#include <unordered_set>
 #include <common.h>
 #include "interconnect/common/pipeline_state_bundle.h"
 
 namespace skyline::gpu {
     /**
      * @brief Manages access and validation of the underlying pipeline cache files
+     * @note The main cache file is indexed by a footer which maps the hash of each pipeline key to its record, the file is memory-mapped so records can be read in any order and only when they're required
+     * @note New pipelines are written to a staging file by a writer thread, they're only available for lookup after being merged into the main file on the next boot
+     * @note The index tracks when and how often each pipeline was used across boots, this is used to prioritise compilation of cached pipelines when they're loaded lazily
      */
     class PipelineCacheManager {
+      public:
+        /**
+         * @brief The location of a single pipeline state bundle record in the main cache file
+         * @note This struct *MUST* not be modified without a pipeline cache version bump
+         */
+        struct IndexEntry {
+            u64 keyHash; //!< An XXH3 hash of the pipeline key
+            u64 offset; //!< The offset of the serialised bundle in the file
+            u32 size; //!< The size of the serialised bundle
+            u32 useCount; //!< The amount of boots during which the pipeline was used
+            u32 lastUsed; //!< The boot count at which the pipeline was last used
+            u32 _pad_{};
+        };
+        static_assert(sizeof(IndexEntry) == 0x20);
+
       private:
         std::thread writerThread;
         std::queue<std::unique_ptr<interconnect::PipelineStateBundle>> writeQueue; //!< The queue of pipeline state bundles to be written to the cache
+        std::unordered_set<u64> queuedKeys; //!< Hashes of all keys that have been queued for writing during this run, used to avoid duplicate records
         std::mutex writeMutex; //!< Protects access to the write queue
         std::condition_variable writeCondition; //!< Notifies the writer thread when the write queue is not empty
+        bool stopWriter{}; //!< If the writer thread should exit after writing out the queue, this is protected by `writeMutex`
         std::string stagingPath; //!< The path to the staging pipeline cache file, which will be actively written to at runtime
         std::string mainPath; //!< The path to the main pipeline cache file
 
+        span<u8> mapping; //!< A read-only mapping of the records in the main cache file
+        std::vector<IndexEntry> index; //!< The index of all records in the main cache file in the order they're stored in
+        std::unordered_map<u64, size_t> indexMap; //!< A map from the hash of a key to its entry in `index`
+        u64 recordsEnd{}; //!< The offset of the end of the last record in the main cache file, the index follows this
+        u32 bootCount{}; //!< The amount of times the cache has been loaded including this run, this is used as a timestamp for pipeline usage
+        bool usageDirty{}; //!< If the usage statistics in the index have been updated since it was last written
+        std::mutex indexMutex; //!< Protects access to the index and the members above it
+
         void Run();
 
-        bool ValidateHeader(std::ifstream &stream);
+        /**
+         * @brief Reads the index of the main file, if the index is missing or invalid then it's rebuilt by scanning all records
+         */
+        void ReadIndex();
 
+        /**
+         * @brief Rewrites the index of the main file based on `index` and truncates the file after it
+         */
+        void WriteIndex();
+
+        /**
+         * @brief Appends the records in the staging file that aren't already in the main file to it
+         */
         void MergeStaging();
 
       public:
         PipelineCacheManager(const DeviceState &state, const std::string &path);
 
+        ~PipelineCacheManager();
+
+        static u64 HashKey(span<const u8> key);
+
+        template<typename T> requires std::is_trivially_copyable_v<T> && (!requires (T t){ t.size(); })
+        static u64 HashKey(const T &key) {
+            return HashKey(span<const u8>{reinterpret_cast<const u8 *>(&key), sizeof(T)});
+        }
+
         /**
-         * @brief Queues a pipeline state bundle to be written to the cache
+         * @brief Queues a pipeline state bundle to be written to the cache, this is a no-op if a bundle with the same key is already cached
          */
         void QueueWrite(std::unique_ptr<interconnect::PipelineStateBundle> bundle);
 
         /**
-         * @brief Opens the main pipeline cache file for reading
-         * @return A pair containing the stream and the total pipeline count
+         * @return A copy of the index of all pipelines in the main cache file in the order they're stored in
+         */
+        std::vector<IndexEntry> GetIndex();
+
+        /**
+         * @brief Deserialises the bundle for an index entry from the main cache file
+         * @note An exception is thrown if the record is corrupted, Invalidate should be used to remove it from the cache
+         */
+        void Read(const IndexEntry &entry, interconnect::PipelineStateBundle &bundle);
+
+        /**
+         * @brief Removes the (potentially invalid) record with the supplied key hash from the cache
          */
-        std::pair<std::ifstream, u32> OpenReadStream();
+        void Invalidate(u64 keyHash);
 
         /**
-         * @brief Shrinks the pipeline cache file to `offset` bytes, removing any (potentially invalid) data after that point
+         * @brief Records that the pipeline with the supplied key hash was used during this run, this is a no-op if it isn't in the main cache file
+         * @note The updated usage statistics are written out periodically by the writer thread rather than immediately
          */
-        void InvalidateAllAfter(u64 offset);
+        void MarkUsed(u64 keyHash);
     };
 }
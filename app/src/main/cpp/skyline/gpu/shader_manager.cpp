@@ -80,7 +80,7 @@ namespace skyline::gpu {
         return binary;
     }
 
-    ShaderManager::ShaderManager(const DeviceState &state, GPU &gpu, std::string_view replacementDir, std::string_view dumpDir) : gpu{gpu}, dumpPath{dumpDir}, pool{1U}, state{state} {
+    ShaderManager::ShaderManager(const DeviceState &state, GPU &gpu, std::string_view replacementDir, std::string_view dumpDir) : gpu{gpu}, dumpPath{dumpDir}, state{state} {
         LoadShaderReplacements(replacementDir);
 
         if constexpr (DumpShaders) {
@@ -152,8 +152,115 @@ namespace skyline::gpu {
                 .active = false,
             },
         };
+
+        HashHostState();
+    }
+
+    #define HASH(x) boost::hash_combine(hash, x)
+
+    void ShaderManager::HashHostState() {
+        size_t hash{};
+
+        HASH(hostTranslateInfo.support_float16);
+        HASH(hostTranslateInfo.support_float64);
+        HASH(hostTranslateInfo.support_int64);
+        HASH(hostTranslateInfo.needs_demote_reorder);
+        HASH(hostTranslateInfo.support_snorm_render_buffer);
+        HASH(hostTranslateInfo.support_viewport_index_layer);
+        HASH(hostTranslateInfo.min_ssbo_alignment);
+        HASH(hostTranslateInfo.support_geometry_shader_passthrough);
+
+        HASH(profile.supported_spirv);
+        HASH(profile.unified_descriptor_binding);
+        HASH(profile.support_descriptor_aliasing);
+        HASH(profile.support_int8);
+        HASH(profile.support_int16);
+        HASH(profile.support_int64);
+        HASH(profile.support_vertex_instance_id);
+        HASH(profile.support_float_controls);
+        HASH(profile.support_separate_denorm_behavior);
+        HASH(profile.support_separate_rounding_mode);
+        HASH(profile.support_fp16_denorm_preserve);
+        HASH(profile.support_fp32_denorm_preserve);
+        HASH(profile.support_fp16_denorm_flush);
+        HASH(profile.support_fp32_denorm_flush);
+        HASH(profile.support_fp16_signed_zero_nan_preserve);
+        HASH(profile.support_fp32_signed_zero_nan_preserve);
+        HASH(profile.support_fp64_signed_zero_nan_preserve);
+        HASH(profile.support_explicit_workgroup_layout);
+        HASH(profile.support_vote);
+        HASH(profile.support_viewport_index_layer_non_geometry);
+        HASH(profile.support_viewport_mask);
+        HASH(profile.support_typeless_image_loads);
+        HASH(profile.support_demote_to_helper_invocation);
+        HASH(profile.support_int64_atomics);
+        HASH(profile.support_derivative_control);
+        HASH(profile.support_geometry_shader_passthrough);
+        HASH(profile.support_native_ndc);
+        HASH(profile.warp_size_potentially_larger_than_guest);
+        HASH(profile.lower_left_origin_mode);
+        HASH(profile.need_declared_frag_colors);
+        HASH(profile.has_broken_spirv_position_input);
+        HASH(profile.has_broken_spirv_subgroup_mask_vector_extract_dynamic);
+        HASH(profile.has_broken_spirv_subgroup_shuffle);
+        HASH(profile.max_subgroup_size);
+        HASH(profile.has_broken_spirv_vector_access_chain);
+        HASH(profile.disable_subgroup_shuffle);
+
+        HASH(Shader::Settings::values.renderer_debug);
+        HASH(Shader::Settings::values.disable_shader_loop_safety_checks);
+
+        // Guest shader replacements change the translated program without changing the guest hash, their contents are hashed in a stable order so any change to them invalidates the cache
+        std::vector<std::pair<u64, u64>> replacementHashes;
+        for (const auto &[replacementHash, binary] : guestShaderReplacements)
+            replacementHashes.emplace_back(replacementHash, XXH3_64bits(binary.data(), binary.size()));
+        std::sort(replacementHashes.begin(), replacementHashes.end());
+        for (const auto &[replacementHash, contentHash] : replacementHashes) {
+            HASH(replacementHash);
+            HASH(contentHash);
+        }
+
+        hostHash = hash;
     }
 
+    static u64 HashRuntimeInfo(const Shader::RuntimeInfo &runtimeInfo) {
+        size_t hash{};
+
+        HASH(std::hash<decltype(runtimeInfo.previous_stage_stores.mask)>{}(runtimeInfo.previous_stage_stores.mask));
+        for (auto type : runtimeInfo.generic_input_types)
+            HASH(static_cast<u32>(type));
+
+        HASH(runtimeInfo.convert_depth_mode);
+        HASH(runtimeInfo.force_early_z);
+        HASH(static_cast<u32>(runtimeInfo.tess_primitive));
+        HASH(static_cast<u32>(runtimeInfo.tess_spacing));
+        HASH(runtimeInfo.tess_clockwise);
+        HASH(static_cast<u32>(runtimeInfo.input_topology));
+
+        HASH(runtimeInfo.fixed_state_point_size.has_value());
+        if (runtimeInfo.fixed_state_point_size)
+            HASH(*runtimeInfo.fixed_state_point_size);
+
+        HASH(runtimeInfo.alpha_test_func.has_value());
+        if (runtimeInfo.alpha_test_func)
+            HASH(static_cast<u32>(*runtimeInfo.alpha_test_func));
+        HASH(runtimeInfo.alpha_test_reference);
+
+        HASH(runtimeInfo.y_negate);
+
+        HASH(runtimeInfo.xfb_varyings.size());
+        for (const auto &varying : runtimeInfo.xfb_varyings) {
+            HASH(varying.buffer);
+            HASH(varying.stride);
+            HASH(varying.offset);
+            HASH(varying.components);
+        }
+
+        return hash;
+    }
+
+    #undef HASH
+
     /**
      * @brief A shader environment for all graphics pipeline stages
      */
@@ -397,24 +504,20 @@ namespace skyline::gpu {
                                                            const ConstantBufferRead &constantBufferRead, const GetTextureType &getTextureType) {
         binary = ProcessShaderBinary(false, hash, binary);
 
-        std::scoped_lock lock{poolMutex};
-
+        auto &threadPools{*pools->current};
         GraphicsEnvironment environment{postVtgShaderAttributeSkipMask, stage, binary, baseOffset, textureConstantBufferIndex, viewportTransformEnabled, constantBufferRead, getTextureType};
-        Shader::Maxwell::Flow::CFG cfg{environment, flowBlockPool, Shader::Maxwell::Location{static_cast<u32>(baseOffset + sizeof(Shader::ProgramHeader))}};
-        return  Shader::Maxwell::TranslateProgram(instructionPool, blockPool, environment, cfg, hostTranslateInfo);
+        Shader::Maxwell::Flow::CFG cfg{environment, threadPools.flowBlockPool, Shader::Maxwell::Location{static_cast<u32>(baseOffset + sizeof(Shader::ProgramHeader))}};
+        return  Shader::Maxwell::TranslateProgram(threadPools.instructionPool, threadPools.blockPool, environment, cfg, hostTranslateInfo);
     }
 
     Shader::IR::Program ShaderManager::CombineVertexShaders(Shader::IR::Program &vertexA, Shader::IR::Program &vertexB, span<u8> vertexBBinary) {
-        std::scoped_lock lock{poolMutex};
-
         VertexBEnvironment env{vertexBBinary};
         return Shader::Maxwell::MergeDualVertexPrograms(vertexA, vertexB, env);
     }
 
     Shader::IR::Program ShaderManager::GenerateGeometryPassthroughShader(Shader::IR::Program &layerSource, Shader::OutputTopology topology) {
-        std::scoped_lock lock{poolMutex};
-
-        return Shader::Maxwell::GenerateGeometryPassthrough(instructionPool, blockPool, hostTranslateInfo, layerSource, topology);
+        auto &threadPools{*pools->current};
+        return Shader::Maxwell::GenerateGeometryPassthrough(threadPools.instructionPool, threadPools.blockPool, hostTranslateInfo, layerSource, topology);
     }
 
     Shader::IR::Program ShaderManager::ParseComputeShader(u64 hash, span<u8> binary, u32 baseOffset,
@@ -424,44 +527,69 @@ namespace skyline::gpu {
                                                           const ConstantBufferRead &constantBufferRead, const GetTextureType &getTextureType) {
         binary = ProcessShaderBinary(false, hash, binary);
 
-        std::scoped_lock lock{poolMutex};
-
+        auto &threadPools{*pools->current};
         ComputeEnvironment environment{binary, baseOffset, textureConstantBufferIndex, localMemorySize, sharedMemorySize, workgroupDimensions, constantBufferRead, getTextureType};
-        Shader::Maxwell::Flow::CFG cfg{environment, flowBlockPool, Shader::Maxwell::Location{static_cast<u32>(baseOffset)}};
-        return Shader::Maxwell::TranslateProgram(instructionPool, blockPool, environment, cfg, hostTranslateInfo);
+        Shader::Maxwell::Flow::CFG cfg{environment, threadPools.flowBlockPool, Shader::Maxwell::Location{static_cast<u32>(baseOffset)}};
+        return Shader::Maxwell::TranslateProgram(threadPools.instructionPool, threadPools.blockPool, environment, cfg, hostTranslateInfo);
     }
 
-    vk::ShaderModule ShaderManager::CompileShader(const Shader::RuntimeInfo &runtimeInfo, Shader::IR::Program &program, Shader::Backend::Bindings &bindings, u64 hash) {
-        std::scoped_lock lock{poolMutex};
-
-        if (program.info.loads.Legacy() || program.info.stores.Legacy()) {
+    void ShaderManager::PrepareShader(const Shader::RuntimeInfo &runtimeInfo, Shader::IR::Program &program) {
+        if (program.info.loads.Legacy() || program.info.stores.Legacy())
             Shader::Maxwell::ConvertLegacyToGeneric(program, runtimeInfo);
+    }
+
+    vk::ShaderModule ShaderManager::CompileShader(const Shader::RuntimeInfo &runtimeInfo, Shader::IR::Program &program, Shader::Backend::Bindings &bindings, u64 hash, u64 programHash) {
+        PrepareShader(runtimeInfo, program);
+
+        std::vector<u32> spirvEmitted;
+        auto &cache{gpu.shaderModuleCacheManager};
+        if (cache && programHash) {
+            ShaderModuleCacheManager::Key key{
+                .guestHash = hash,
+                .programHash = programHash,
+                .runtimeInfoHash = HashRuntimeInfo(runtimeInfo),
+                .bindingsHash = XXH3_64bits(&bindings, sizeof(Shader::Backend::Bindings)),
+                .hostHash = hostHash,
+            };
+
+            if (!cache->Lookup(key, spirvEmitted, bindings)) {
+                spirvEmitted = Shader::Backend::SPIRV::EmitSPIRV(profile, runtimeInfo, program, bindings);
+                cache->QueueWrite(key, bindings, spirvEmitted);
+            }
+        } else {
+            spirvEmitted = Shader::Backend::SPIRV::EmitSPIRV(profile, runtimeInfo, program, bindings);
         }
 
-        auto compileShader = [this, &runtimeInfo, &program, &bindings, hash]() {
-            auto spirvEmitted{Shader::Backend::SPIRV::EmitSPIRV(profile, runtimeInfo, program, bindings)};
-            auto spirv{ProcessShaderBinary(true, hash, span<u32>{spirvEmitted}.cast<u8>()).cast<u32>()};
+        auto spirv{ProcessShaderBinary(true, hash, span<u32>{spirvEmitted}.cast<u8>()).cast<u32>()};
 
-            vk::ShaderModuleCreateInfo createInfo{
-                .pCode = spirv.data(),
-                .codeSize = spirv.size_bytes(),
-            };
-            return (*gpu.vkDevice).createShaderModule(createInfo, nullptr, *gpu.vkDevice.getDispatcher());
+        vk::ShaderModuleCreateInfo createInfo{
+            .pCode = spirv.data(),
+            .codeSize = spirv.size_bytes(),
         };
-        
-        if (*state.settings->useAsyncShaders) {
-            auto future = pool.submit_task(compileShader);
-            return future.get();
+        return (*gpu.vkDevice).createShaderModule(createInfo, nullptr, *gpu.vkDevice.getDispatcher());
+    }
+
+    void ShaderManager::ResetPools() {
+        auto &current{pools->current};
+        if (current.use_count() == 1) {
+            current->instructionPool.ReleaseContents();
+            current->blockPool.ReleaseContents();
+            current->flowBlockPool.ReleaseContents();
         } else {
-            return compileShader();
+            // Programs created from the current pools are still required by deferred compilation, so a new set of pools is used instead and the old ones are freed once that completes
+            current = std::make_shared<ObjectPools>();
         }
     }
 
-    void ShaderManager::ResetPools() {
-        std::scoped_lock lock{poolMutex};
+    std::shared_ptr<const void> ShaderManager::RetainPools() {
+        return pools->current;
+    }
+
+    void ShaderManager::MarkCompilationWorker() {
+        isCompilationWorker = true;
+    }
 
-        instructionPool.ReleaseContents();
-        blockPool.ReleaseContents();
-        flowBlockPool.ReleaseContents();
+    bool ShaderManager::IsCompilationWorker() {
+        return isCompilationWorker;
     }
 }
@@ -5,7 +5,6 @@
 
 #include <unordered_map>
 #include <vulkan/vulkan.hpp>
-#include <BS_thread_pool.hpp>
 #include <shader_compiler/object_pool.h>
 #include <shader_compiler/frontend/maxwell/control_flow.h>
 #include <shader_compiler/frontend/ir/value.h>
@@ -16,6 +15,7 @@
 #include <shader_compiler/runtime_info.h>
 #include <shader_compiler/backend/bindings.h>
 #include <common.h>
+#include <common/thread_local.h>
 
 namespace skyline::gpu {
     /**
@@ -27,14 +27,29 @@ namespace skyline::gpu {
         GPU &gpu;
         Shader::HostTranslateInfo hostTranslateInfo;
         Shader::Profile profile;
-        Shader::ObjectPool<Shader::Maxwell::Flow::Block> flowBlockPool;
-        Shader::ObjectPool<Shader::IR::Inst> instructionPool;
-        Shader::ObjectPool<Shader::IR::Block> blockPool;
+        u64 hostHash{}; //!< A hash of all host state which affects translation or SPIR-V emission, this is used to key the shader module cache
+
+        /**
+         * @brief The object pools which back the IR of all shader programs, a program must not outlive the contents of the pools it was created from
+         */
+        struct ObjectPools {
+            Shader::ObjectPool<Shader::Maxwell::Flow::Block> flowBlockPool;
+            Shader::ObjectPool<Shader::IR::Inst> instructionPool;
+            Shader::ObjectPool<Shader::IR::Block> blockPool;
+        };
+
+        /**
+         * @brief The object pools currently used by a thread, these are shared with any deferred compilation that still requires programs created from them
+         */
+        struct ThreadPools {
+            std::shared_ptr<ObjectPools> current{std::make_shared<ObjectPools>()};
+        };
+        ThreadLocal<ThreadPools> pools; //!< Every thread translating shaders has its own set of pools so translation can run concurrently without any locking
+
         std::unordered_map<u64, std::vector<u8>> guestShaderReplacements; //!< Map of guest shader hash -> replacement guest shader binary, populated at init time and must not be modified after
         std::unordered_map<u64, std::vector<u8>> hostShaderReplacements; //!< ^^ same as above but for host
 
-        BS::thread_pool<BS::tp::none> pool;
-        std::mutex poolMutex;
+        static thread_local inline bool isCompilationWorker{}; //!< If the current thread is a dedicated compilation worker, pipelines created on such threads always compile their shaders directly rather than deferring them
         std::filesystem::path dumpPath;
         std::mutex dumpMutex;
         std::mutex replacementMapMutex;
@@ -50,6 +65,11 @@ namespace skyline::gpu {
          */
         span<u8> ProcessShaderBinary(bool spv, u64 hash, span<u8> binary);
 
+        /**
+         * @brief Calculates `hostHash` from the profile, host translation info and any guest shader replacements
+         */
+        void HashHostState();
+
       public:
         using ConstantBufferRead = std::function<u32(u32 index, u32 offset)>; //!< A function which reads a constant buffer at the specified offset and returns the value
         using GetTextureType = std::function<Shader::TextureType(u32 handle)>; //!< A function which determines the type of a texture from its handle by checking the corresponding TIC
@@ -74,8 +94,35 @@ namespace skyline::gpu {
 
         Shader::IR::Program ParseComputeShader(u64 hash, span<u8> binary, u32 baseOffset, u32 textureConstantBufferIndex, u32 localMemorySize, u32 sharedMemorySize, std::array<u32, 3> workgroupDimensions, const ConstantBufferRead &constantBufferRead, const GetTextureType &getTextureType);
 
-        vk::ShaderModule CompileShader(const Shader::RuntimeInfo &runtimeInfo, Shader::IR::Program &program, Shader::Backend::Bindings &bindings, u64 hash = 0);
+        /**
+         * @brief Applies any transformations to the program that depend on the runtime info, this finalises the program's info which the next stage's runtime info depends on
+         * @note This is done implicitly by CompileShader, it only needs to be called explicitly when compilation of the program is deferred
+         */
+        void PrepareShader(const Shader::RuntimeInfo &runtimeInfo, Shader::IR::Program &program);
+
+        /**
+         * @param hash The hash of the guest shader binary, this is used for dumping and replacing the emitted SPIR-V
+         * @param programHash A hash of all inputs (other than the guest binary) which affected translation of the program, the SPIR-V is only looked up in and written to the shader module cache when this is non-zero
+         * @note This is thread-safe and may be called on any thread as long as the program's object pools are retained
+         */
+        vk::ShaderModule CompileShader(const Shader::RuntimeInfo &runtimeInfo, Shader::IR::Program &program, Shader::Backend::Bindings &bindings, u64 hash = 0, u64 programHash = 0);
 
+        /**
+         * @brief Releases the contents of the calling thread's object pools, all programs previously created on this thread are invalidated unless their pools were retained
+         */
         void ResetPools();
+
+        /**
+         * @return A reference to the calling thread's current object pools, this keeps all programs created from them valid until it's destroyed regardless of any calls to ResetPools
+         */
+        std::shared_ptr<const void> RetainPools();
+
+        /**
+         * @brief Marks the calling thread as a dedicated compilation worker, all pipelines created on it from then onwards will compile their shaders directly on it
+         * @note This is used by bulk compilation (such as pipeline cache warm-up) which is already parallelised and shouldn't defer any work
+         */
+        static void MarkCompilationWorker();
+
+        static bool IsCompilationWorker();
     };
 }
@@ -0,0 +1,243 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2024 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include <fstream>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "shader_module_cache_manager.h"
+
+namespace skyline::gpu {
+    /*  File format pseudocode:
+        ShaderModuleCacheFileHeader header;
+
+        struct Record {
+            ShaderModuleCacheRecordPrefix prefix;
+            ShaderModuleCacheEntryHeader entryHeader;
+            u32 spirv[entryHeader.wordCount];
+        } records[]; // Records are only ever appended, the end of the file is determined by the first record that fails validation
+
+        The staging file has the same format, records in it are validated and merged into the main file on the next boot
+    */
+
+    struct ShaderModuleCacheFileHeader {
+        static constexpr u32 Magic{util::MakeMagic<u32>("SPVC")}; //!< The magic value used to identify a shader module cache file
+        static constexpr u32 Version{2}; //!< The version of the shader module cache file format, MUST be incremented for any format changes (including changes to the shader compiler which alter its output)
+
+        u32 magic{Magic};
+        u32 version{Version};
+
+        /**
+         * @brief Checks if the header is valid
+         */
+        bool IsValid() {
+            return magic == Magic && version == Version;
+        }
+    };
+
+    /**
+     * @brief The header of each entry in the cache file, it's immediately followed by the SPIR-V words
+     */
+    struct ShaderModuleCacheEntryHeader {
+        ShaderModuleCacheManager::Key key;
+        Shader::Backend::Bindings bindings; //!< The bindings after compilation of the shader
+        u32 wordCount; //!< The amount of SPIR-V words following this header
+    };
+
+    /**
+     * @brief The prefix of each record in the cache file, this allows validating a record without any other state so records can be committed without updating a header
+     */
+    struct ShaderModuleCacheRecordPrefix {
+        u64 hash; //!< An XXH64 hash of the record data following the prefix
+        u32 size; //!< The size of the record data following the prefix
+        u32 _pad_{};
+    };
+    static_assert(sizeof(ShaderModuleCacheRecordPrefix) == 0x10);
+
+    /**
+     * @return The size of the record at the supplied offset including its prefix, or 0 if it's truncated or corrupted
+     */
+    static size_t ValidateRecord(span<const u8> data, size_t offset) {
+        if (offset + sizeof(ShaderModuleCacheRecordPrefix) > data.size())
+            return 0;
+
+        auto prefix{data.subspan(offset).as<const ShaderModuleCacheRecordPrefix>()};
+        size_t dataOffset{offset + sizeof(ShaderModuleCacheRecordPrefix)};
+        if (prefix.size < sizeof(ShaderModuleCacheEntryHeader) || dataOffset + prefix.size > data.size())
+            return 0;
+
+        auto entryHeader{data.subspan(dataOffset).as<const ShaderModuleCacheEntryHeader>()};
+        if (sizeof(ShaderModuleCacheEntryHeader) + entryHeader.wordCount * sizeof(u32) != prefix.size || XXH64(data.data() + dataOffset, prefix.size, 0) != prefix.hash)
+            return 0;
+
+        return sizeof(ShaderModuleCacheRecordPrefix) + prefix.size;
+    }
+
+    u64 ShaderModuleCacheManager::HashKey(const Key &key) {
+        return XXH3_64bits(&key, sizeof(Key));
+    }
+
+    void ShaderModuleCacheManager::Run() {
+        std::ofstream stream{stagingPath, std::ios::binary | std::ios::trunc};
+        ShaderModuleCacheFileHeader header{};
+        stream.write(reinterpret_cast<const char *>(&header), sizeof(ShaderModuleCacheFileHeader));
+        stream.flush();
+
+        std::vector<u8> record; //!< A reusable buffer for the data of each record, the hash in the prefix is calculated over it
+        while (true) {
+            std::unique_lock lock(writeMutex);
+            writeCondition.wait(lock, [this] { return !writeQueue.empty() || stopWriter; });
+            if (stopWriter)
+                return; // Any entries that are still queued are dropped to avoid delaying exiting
+
+            auto batch{std::move(writeQueue)};
+            writeQueue = {};
+            lock.unlock();
+
+            // All entries queued since the last commit are written out together and committed with a single flush, records are self-validating so there's no header to update
+            while (!batch.empty()) {
+                auto &[key, bindings, spirv]{batch.front()};
+                ShaderModuleCacheEntryHeader entryHeader{
+                    .key = key,
+                    .bindings = bindings,
+                    .wordCount = static_cast<u32>(spirv.size()),
+                };
+
+                record.resize(sizeof(ShaderModuleCacheEntryHeader) + spirv.size() * sizeof(u32));
+                std::memcpy(record.data(), &entryHeader, sizeof(ShaderModuleCacheEntryHeader));
+                std::memcpy(record.data() + sizeof(ShaderModuleCacheEntryHeader), spirv.data(), spirv.size() * sizeof(u32));
+
+                ShaderModuleCacheRecordPrefix prefix{
+                    .hash = XXH64(record.data(), record.size(), 0),
+                    .size = static_cast<u32>(record.size()),
+                };
+                stream.write(reinterpret_cast<const char *>(&prefix), sizeof(ShaderModuleCacheRecordPrefix));
+                stream.write(reinterpret_cast<const char *>(record.data()), static_cast<std::streamsize>(record.size()));
+                batch.pop();
+            }
+            stream.flush();
+        }
+    }
+
+    void ShaderModuleCacheManager::MergeStaging() {
+        std::ifstream stagingStream{stagingPath, std::ios::binary | std::ios::ate};
+        if (stagingStream.fail())
+            return; // If the staging file doesn't exist then there's nothing to merge
+
+        std::vector<u8> staging(static_cast<size_t>(stagingStream.tellg()));
+        stagingStream.seekg(0, std::ios_base::beg);
+        stagingStream.read(reinterpret_cast<char *>(staging.data()), static_cast<std::streamsize>(staging.size()));
+
+        auto data{span(staging)};
+        if (stagingStream.fail() || data.size() < sizeof(ShaderModuleCacheFileHeader) || !data.as<ShaderModuleCacheFileHeader>().IsValid()) {
+            LOGW("Discarding invalid shader module cache staging file");
+            return;
+        }
+
+        size_t offset{sizeof(ShaderModuleCacheFileHeader)};
+        while (size_t recordSize{ValidateRecord(data, offset)})
+            offset += recordSize;
+
+        // This occurs when the emulator exits while a batch is being written, only the records prior to that are merged
+        if (offset != data.size())
+            LOGW("Discarding invalid shader module cache staging records at 0x{:X}", offset);
+
+        std::ofstream mainStream{mainPath, std::ios::binary | std::ios::app};
+        mainStream.write(reinterpret_cast<const char *>(data.data() + sizeof(ShaderModuleCacheFileHeader)), static_cast<std::streamsize>(offset - sizeof(ShaderModuleCacheFileHeader)));
+    }
+
+    void ShaderModuleCacheManager::LoadMain() {
+        int fd{open(mainPath.c_str(), O_RDONLY | O_CLOEXEC)};
+        if (fd < 0)
+            throw exception("Failed to open shader module cache: {}", strerror(errno));
+
+        size_t size{static_cast<size_t>(lseek(fd, 0, SEEK_END))};
+        auto pointer{static_cast<u8 *>(mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0))};
+        close(fd); // The mapping holds a reference to the file
+        if (pointer == MAP_FAILED) [[unlikely]]
+            throw exception("Failed to map shader module cache: {}", strerror(errno));
+        mapping = span<u8>{pointer, size};
+
+        size_t offset{sizeof(ShaderModuleCacheFileHeader)}; //!< The offset of the end of the last valid record
+        while (size_t recordSize{ValidateRecord(mapping, offset)}) {
+            size_t entryOffset{offset + sizeof(ShaderModuleCacheRecordPrefix)};
+            auto entryHeader{mapping.subspan(entryOffset).as<ShaderModuleCacheEntryHeader>()};
+            size_t dataOffset{entryOffset + sizeof(ShaderModuleCacheEntryHeader)};
+            entries.try_emplace(HashKey(entryHeader.key), Entry{entryHeader.key, entryHeader.bindings, mapping.subspan(dataOffset, entryHeader.wordCount * sizeof(u32)).cast<const u32>()});
+            offset += recordSize;
+        }
+
+        if (offset != mapping.size()) {
+            // This occurs when the emulator exits while records are being merged, only the records prior to the first invalid one are kept and any data after them is truncated
+            LOGW("Discarding invalid shader module cache records at 0x{:X}", offset);
+            std::filesystem::resize_file(mainPath, offset); // The mapping past the end of the file is never accessed as it's not referenced by any entries
+        }
+
+        cacheSize = offset;
+    }
+
+    ShaderModuleCacheManager::ShaderModuleCacheManager(const std::string &path)
+        : stagingPath{path + ".staging"}, mainPath{path} {
+        bool didExist{std::filesystem::exists(mainPath)};
+        if (didExist) { // If the main file exists then we need to validate it
+            std::ifstream mainStream{mainPath, std::ios::binary};
+            ShaderModuleCacheFileHeader header{};
+            mainStream.read(reinterpret_cast<char *>(&header), sizeof(ShaderModuleCacheFileHeader));
+            if (mainStream.fail() || !header.IsValid()) { // Force a recreation of the file if it's invalid, this also occurs when the shader compiler is changed
+                LOGW("Discarding invalid shader module cache main file");
+                std::filesystem::remove(mainPath);
+                didExist = false;
+            }
+        }
+
+        if (!didExist) { // If the main file didn't exist we need to write the header
+            std::filesystem::create_directories(std::filesystem::path{mainPath}.parent_path());
+            std::ofstream mainStream{mainPath, std::ios::binary | std::ios::app};
+            ShaderModuleCacheFileHeader header{};
+            mainStream.write(reinterpret_cast<const char *>(&header), sizeof(ShaderModuleCacheFileHeader));
+        }
+
+        // Merge any staging changes into the main file before mapping it and starting the writer thread
+        MergeStaging();
+        LoadMain();
+        writerThread = std::thread(&ShaderModuleCacheManager::Run, this);
+    }
+
+    ShaderModuleCacheManager::~ShaderModuleCacheManager() {
+        {
+            std::scoped_lock lock{writeMutex};
+            stopWriter = true;
+            writeCondition.notify_one();
+        }
+        writerThread.join();
+
+        if (mapping.valid())
+            munmap(mapping.data(), mapping.size());
+    }
+
+    bool ShaderModuleCacheManager::Lookup(const Key &key, std::vector<u32> &spirv, Shader::Backend::Bindings &bindings) {
+        auto it{entries.find(HashKey(key))};
+        if (it == entries.end() || it->second.key != key)
+            return false;
+
+        const auto &entry{it->second};
+        spirv.assign(entry.spirv.begin(), entry.spirv.end());
+        bindings = entry.bindings;
+        return true;
+    }
+
+    void ShaderModuleCacheManager::QueueWrite(const Key &key, const Shader::Backend::Bindings &bindings, span<const u32> spirv) {
+        u64 hash{HashKey(key)};
+        if (entries.contains(hash))
+            return;
+
+        std::scoped_lock lock{writeMutex};
+        size_t entrySize{sizeof(ShaderModuleCacheRecordPrefix) + sizeof(ShaderModuleCacheEntryHeader) + spirv.size_bytes()};
+        if (cacheSize + entrySize > MaxCacheSize || !queuedKeys.insert(hash).second)
+            return;
+
+        cacheSize += entrySize;
+        writeQueue.emplace(key, bindings, std::vector<u32>(spirv.begin(), spirv.end()));
+        writeCondition.notify_one();
+    }
+}
@@ -0,0 +1,88 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2024 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include <queue>
+#include <unordered_set>
+#include <shader_compiler/backend/bindings.h>
+#include <common.h>
+
+namespace skyline::gpu {
+    /**
+     * @brief Manages a persistent content-addressed cache of SPIR-V emitted for guest shaders, this avoids redoing SPIR-V emission for every cached pipeline on each boot
+     * @note The main cache file is memory-mapped on construction while new entries are written to a staging file by a writer thread, they're only available for lookup after being merged into the main file on the next boot
+     */
+    class ShaderModuleCacheManager {
+      public:
+        /**
+         * @brief All inputs which determine the SPIR-V emitted for a shader
+         */
+        struct Key {
+            u64 guestHash; //!< The hash of the guest shader binary, this is zero for shaders generated on the host
+            u64 programHash; //!< A hash of all inputs (other than the guest binary) which affected translation of the program
+            u64 runtimeInfoHash; //!< A hash of the Shader::RuntimeInfo the shader was compiled with
+            u64 bindingsHash; //!< A hash of the bindings prior to compilation, they determine the binding indices used by the shader
+            u64 hostHash; //!< A hash of the host profile and any other host state which affects translation or SPIR-V emission
+
+            bool operator==(const Key &) const = default;
+        };
+        static_assert(std::has_unique_object_representations_v<Key>, "Key is hashed and serialised as raw bytes and must not contain any implicit padding");
+        static_assert(std::has_unique_object_representations_v<Shader::Backend::Bindings>, "Bindings are hashed and serialised as raw bytes and must not contain any implicit padding");
+
+      private:
+        static constexpr size_t MaxCacheSize{0x10000000}; //!< The maximum size of the cache files in bytes, no new entries are written once this is exceeded
+
+        /**
+         * @brief The location of the SPIR-V for a cache entry in the memory-mapped main file
+         */
+        struct Entry {
+            Key key;
+            Shader::Backend::Bindings bindings; //!< The bindings after compilation of the shader
+            span<const u32> spirv;
+        };
+
+        std::string stagingPath; //!< The path to the staging cache file, which will be actively written to at runtime
+        std::string mainPath; //!< The path to the main cache file
+        span<u8> mapping; //!< A read-only mapping of the main cache file
+        std::unordered_map<u64, Entry> entries; //!< A map from the hash of a key to its entry, this is immutable after construction
+        size_t cacheSize{}; //!< The total size of the cache files in bytes
+
+        std::thread writerThread;
+        std::queue<std::tuple<Key, Shader::Backend::Bindings, std::vector<u32>>> writeQueue; //!< The queue of shaders to be written to the cache
+        std::unordered_set<u64> queuedKeys; //!< Hashes of all keys that have been queued for writing during this run, used to avoid duplicate entries
+        std::mutex writeMutex; //!< Protects access to the write queue
+        std::condition_variable writeCondition; //!< Notifies the writer thread when the write queue is not empty
+        bool stopWriter{}; //!< If the writer thread should exit, this is protected by `writeMutex`
+
+        void Run();
+
+        void MergeStaging();
+
+        /**
+         * @brief Maps the main cache file and indexes all records in it, the file is truncated at the first record which fails validation
+         */
+        void LoadMain();
+
+        static u64 HashKey(const Key &key);
+
+      public:
+        ShaderModuleCacheManager(const std::string &path);
+
+        ~ShaderModuleCacheManager();
+
+        /**
+         * @brief Copies the SPIR-V corresponding to the key into the output vector if it's present in the cache
+         * @param bindings The bindings prior to compilation, these are advanced in the same way as compiling the shader would if it's present
+         * @return If the shader was found in the cache
+         * @note This is thread-safe and may be called concurrently with itself and QueueWrite
+         */
+        bool Lookup(const Key &key, std::vector<u32> &spirv, Shader::Backend::Bindings &bindings);
+
+        /**
+         * @brief Queues the SPIR-V for a shader to be written to the cache, this is a no-op if it's already cached or the cache is full
+         * @param bindings The bindings after compilation of the shader
+         */
+        void QueueWrite(const Key &key, const Shader::Backend::Bindings &bindings, span<const u32> spirv);
+    };
+}
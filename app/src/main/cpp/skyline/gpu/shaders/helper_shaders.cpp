@@ -3,6 +3,7 @@
 
 #include <gpu.h>
 #include <gpu/descriptor_allocator.h>
+#include <gpu/buffer.h>
 #include <gpu/texture/texture.h>
 #include <gpu/graphics_pipeline_assembler.h>
 #include <vfs/filesystem.h>
@@ -392,8 +393,308 @@ namespace skyline::gpu {
         });
     }
 
+    namespace texture_decode {
+        struct ComputePushConstantLayout {
+            u32 srcOffset; //!< The offset of the subresource in the input buffer in words
+            u32 dstOffset; //!< The offset of the subresource in the output buffer in words
+            u32 width, height, depth; //!< The dimensions of the subresource in format blocks
+            u32 texelWidth, texelHeight; //!< The dimensions of the subresource in texels
+            u32 blockWords; //!< The size of a format block in words
+            u32 gobBlockHeight, gobBlockDepth;
+            TextureDecodeHelperShader::Mode mode;
+            glsl::Bool isSigned;
+        };
+
+        constexpr static vk::PushConstantRange PushConstantRange{
+            .stageFlags = vk::ShaderStageFlagBits::eCompute,
+            .size = sizeof(ComputePushConstantLayout),
+            .offset = 0
+        };
+
+        constexpr static std::array<vk::DescriptorSetLayoutBinding, 2> LayoutBindings{
+            vk::DescriptorSetLayoutBinding{
+                .binding = 0,
+                .descriptorType = vk::DescriptorType::eStorageBuffer,
+                .descriptorCount = 1,
+                .stageFlags = vk::ShaderStageFlagBits::eCompute
+            }, vk::DescriptorSetLayoutBinding{
+                .binding = 1,
+                .descriptorType = vk::DescriptorType::eStorageBuffer,
+                .descriptorCount = 1,
+                .stageFlags = vk::ShaderStageFlagBits::eCompute
+            }
+        };
+
+        constexpr u32 WorkgroupSize{8}; //!< The X and Y dimensions of a workgroup in the shader
+    }
+
+    TextureDecodeHelperShader::DecodeState::DecodeState(GPU &gpu, vk::DescriptorSetLayout descriptorSetLayout, std::shared_ptr<memory::StagingBuffer> input, Mode mode, bool isSigned, const texture::FormatBase &guestFormat)
+        : input{std::move(input)},
+          descriptorSet{gpu.descriptor.AllocateSet(descriptorSetLayout)},
+          mode{mode},
+          isSigned{isSigned},
+          formatBlockWidth{guestFormat.blockWidth},
+          formatBlockHeight{guestFormat.blockHeight},
+          formatBpb{guestFormat.bpb} {}
+
+    TextureDecodeHelperShader::TextureDecodeHelperShader(GPU &gpu, std::shared_ptr<vfs::FileSystem> shaderFileSystem)
+        : shaderModule{CreateShaderModule(gpu, *shaderFileSystem->OpenFile("shaders/texture_decode.comp.spv"))},
+          descriptorSetLayout{gpu.vkDevice, vk::DescriptorSetLayoutCreateInfo{
+              .pBindings = texture_decode::LayoutBindings.data(),
+              .bindingCount = static_cast<u32>(texture_decode::LayoutBindings.size()),
+          }},
+          pipelineLayout{gpu.vkDevice, vk::PipelineLayoutCreateInfo{
+              .pSetLayouts = &*descriptorSetLayout,
+              .setLayoutCount = 1,
+              .pPushConstantRanges = &texture_decode::PushConstantRange,
+              .pushConstantRangeCount = 1,
+          }},
+          pipeline{gpu.vkDevice, nullptr, vk::ComputePipelineCreateInfo{
+              .stage = vk::PipelineShaderStageCreateInfo{
+                  .stage = vk::ShaderStageFlagBits::eCompute,
+                  .module = *shaderModule,
+                  .pName = "main"
+              },
+              .layout = *pipelineLayout,
+          }} {}
+
+    std::optional<TextureDecodeHelperShader::Mode> TextureDecodeHelperShader::GetMode(const texture::FormatBase &guestFormat, const texture::FormatBase &hostFormat) {
+        if (guestFormat == hostFormat) {
+            if (guestFormat.bpb == 4 || guestFormat.bpb == 8 || guestFormat.bpb == 16)
+                return Mode::Copy;
+            return std::nullopt;
+        }
+
+        if (hostFormat.IsCompressed())
+            return std::nullopt; // Transcoding between compressed formats is only done on the CPU
+
+        switch (guestFormat.vkFormat) {
+            case vk::Format::eBc1RgbaUnormBlock:
+            case vk::Format::eBc1RgbaSrgbBlock:
+                return Mode::Bc1;
+
+            case vk::Format::eBc2UnormBlock:
+            case vk::Format::eBc2SrgbBlock:
+                return Mode::Bc2;
+
+            case vk::Format::eBc3UnormBlock:
+            case vk::Format::eBc3SrgbBlock:
+                return Mode::Bc3;
+
+            case vk::Format::eBc4UnormBlock:
+            case vk::Format::eBc4SnormBlock:
+                return Mode::Bc4;
+
+            case vk::Format::eBc5UnormBlock:
+            case vk::Format::eBc5SnormBlock:
+                return Mode::Bc5;
+
+            default:
+                return std::nullopt; // BC6H, BC7 and ASTC are only decoded on the CPU
+        }
+    }
+
+    std::shared_ptr<TextureDecodeHelperShader::DecodeState> TextureDecodeHelperShader::CreateDecode(GPU &gpu, Mode mode, bool isSigned, const texture::FormatBase &guestFormat,
+                                                                                                     std::shared_ptr<memory::StagingBuffer> input, const std::shared_ptr<memory::StagingBuffer> &output) {
+        auto state{std::make_shared<DecodeState>(gpu, *descriptorSetLayout, std::move(input), mode, isSigned, guestFormat)};
+
+        std::array<vk::DescriptorBufferInfo, 2> bufferInfos{
+            vk::DescriptorBufferInfo{
+                .buffer = state->input->vkBuffer,
+                .offset = 0,
+                .range = state->input->size(),
+            }, vk::DescriptorBufferInfo{
+                .buffer = output->vkBuffer,
+                .offset = 0,
+                .range = output->size(),
+            }
+        };
+
+        std::array<vk::WriteDescriptorSet, 2> writes{
+            vk::WriteDescriptorSet{
+                .dstBinding = 0,
+                .descriptorType = vk::DescriptorType::eStorageBuffer,
+                .descriptorCount = 1,
+                .dstSet = *state->descriptorSet,
+                .pBufferInfo = &bufferInfos[0]
+            }, vk::WriteDescriptorSet{
+                .dstBinding = 1,
+                .descriptorType = vk::DescriptorType::eStorageBuffer,
+                .descriptorCount = 1,
+                .dstSet = *state->descriptorSet,
+                .pBufferInfo = &bufferInfos[1]
+            }
+        };
+
+        gpu.vkDevice.updateDescriptorSets(writes, nullptr);
+        return state;
+    }
+
+    void TextureDecodeHelperShader::RecordDecode(const vk::raii::CommandBuffer &commandBuffer, const DecodeState &state) {
+        // The input buffer is written on the CPU prior to submission so it doesn't need a barrier
+        commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, *pipeline);
+        commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute, *pipelineLayout, 0, *state.descriptorSet, nullptr);
+
+        for (const auto &subresource : state.subresources) {
+            texture_decode::ComputePushConstantLayout pushConstants{
+                .srcOffset = subresource.srcOffset / sizeof(u32),
+                .dstOffset = subresource.dstOffset / sizeof(u32),
+                .width = util::DivideCeil(subresource.width, state.formatBlockWidth),
+                .height = util::DivideCeil(subresource.height, state.formatBlockHeight),
+                .depth = subresource.depth,
+                .texelWidth = subresource.width,
+                .texelHeight = subresource.height,
+                .blockWords = state.formatBpb / static_cast<u32>(sizeof(u32)),
+                .gobBlockHeight = subresource.gobBlockHeight,
+                .gobBlockDepth = subresource.gobBlockDepth,
+                .mode = state.mode,
+                .isSigned = state.isSigned,
+            };
+
+            commandBuffer.pushConstants(*pipelineLayout, vk::ShaderStageFlagBits::eCompute, 0, vk::ArrayProxy<const texture_decode::ComputePushConstantLayout>{pushConstants});
+            commandBuffer.dispatch(util::DivideCeil(pushConstants.width, texture_decode::WorkgroupSize), util::DivideCeil(pushConstants.height, texture_decode::WorkgroupSize), pushConstants.depth);
+        }
+
+        commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eTransfer, {}, {vk::MemoryBarrier{
+            .srcAccessMask = vk::AccessFlagBits::eShaderWrite,
+            .dstAccessMask = vk::AccessFlagBits::eTransferRead,
+        }}, {}, {});
+    }
+
+    namespace indirect_conversion {
+        struct ComputePushConstantLayout {
+            u32 cmdOffset; //!< The offset of the guest draw command in the command buffer in words
+            u32 srcOffset; //!< The offset of the guest index buffer in the input buffer in bytes
+            u32 indexSize; //!< The size of a single guest index in bytes
+            u32 maxPrimitives;
+            IndirectConversionHelperShader::Mode mode;
+        };
+
+        constexpr static vk::PushConstantRange PushConstantRange{
+            .stageFlags = vk::ShaderStageFlagBits::eCompute,
+            .size = sizeof(ComputePushConstantLayout),
+            .offset = 0
+        };
+
+        constexpr static std::array<vk::DescriptorSetLayoutBinding, 3> LayoutBindings{
+            vk::DescriptorSetLayoutBinding{
+                .binding = 0,
+                .descriptorType = vk::DescriptorType::eStorageBuffer,
+                .descriptorCount = 1,
+                .stageFlags = vk::ShaderStageFlagBits::eCompute
+            }, vk::DescriptorSetLayoutBinding{
+                .binding = 1,
+                .descriptorType = vk::DescriptorType::eStorageBuffer,
+                .descriptorCount = 1,
+                .stageFlags = vk::ShaderStageFlagBits::eCompute
+            }, vk::DescriptorSetLayoutBinding{
+                .binding = 2,
+                .descriptorType = vk::DescriptorType::eStorageBuffer,
+                .descriptorCount = 1,
+                .stageFlags = vk::ShaderStageFlagBits::eCompute
+            }
+        };
+
+        constexpr u32 WorkgroupSize{64}; //!< The X dimension of a workgroup in the shader, every invocation converts a single primitive
+    }
+
+    IndirectConversionHelperShader::IndirectConversionHelperShader(GPU &gpu, std::shared_ptr<vfs::FileSystem> shaderFileSystem)
+        : shaderModule{CreateShaderModule(gpu, *shaderFileSystem->OpenFile("shaders/indirect_conversion.comp.spv"))},
+          descriptorSetLayout{gpu.vkDevice, vk::DescriptorSetLayoutCreateInfo{
+              .pBindings = indirect_conversion::LayoutBindings.data(),
+              .bindingCount = static_cast<u32>(indirect_conversion::LayoutBindings.size()),
+          }},
+          pipelineLayout{gpu.vkDevice, vk::PipelineLayoutCreateInfo{
+              .pSetLayouts = &*descriptorSetLayout,
+              .setLayoutCount = 1,
+              .pPushConstantRanges = &indirect_conversion::PushConstantRange,
+              .pushConstantRangeCount = 1,
+          }},
+          pipeline{gpu.vkDevice, nullptr, vk::ComputePipelineCreateInfo{
+              .stage = vk::PipelineShaderStageCreateInfo{
+                  .stage = vk::ShaderStageFlagBits::eCompute,
+                  .module = *shaderModule,
+                  .pName = "main"
+              },
+              .layout = *pipelineLayout,
+          }} {}
+
+    u32 IndirectConversionHelperShader::GetMaxPrimitiveCount(Mode mode, u32 indexCount) {
+        switch (mode) {
+            case Mode::Quads:
+                return indexCount / 4;
+            case Mode::QuadStrip:
+                return indexCount >= 4 ? (indexCount - 2) / 2 : 0;
+            case Mode::Polygon:
+                return indexCount >= 3 ? indexCount - 2 : 0;
+        }
+    }
+
+    void IndirectConversionHelperShader::RecordConversion(GPU &gpu, const vk::raii::CommandBuffer &commandBuffer, vk::DescriptorSet descriptorSet,
+                                                          const BufferBinding &command, const BufferBinding &indices, u32 indexSize, const BufferBinding &output,
+                                                          u32 maxPrimitives, Mode mode) {
+        // Guest bindings aren't necessarily aligned to the minimum storage buffer alignment so they're bound from an aligned offset with the remainder being applied in the shader
+        vk::DeviceSize alignment{gpu.traits.minimumStorageBufferAlignment};
+        vk::DeviceSize commandAlignedOffset{util::AlignDown(command.offset, alignment)}, indicesAlignedOffset{util::AlignDown(indices.offset, alignment)};
+
+        std::array<vk::DescriptorBufferInfo, 3> bufferInfos{
+            vk::DescriptorBufferInfo{
+                .buffer = command.buffer,
+                .offset = commandAlignedOffset,
+                .range = command.size + (command.offset - commandAlignedOffset),
+            }, vk::DescriptorBufferInfo{
+                .buffer = indices.buffer,
+                .offset = indicesAlignedOffset,
+                .range = VK_WHOLE_SIZE, // The guest index buffer size isn't necessarily a multiple of a word, the shader only reads indices within the draw's bounds regardless
+            }, vk::DescriptorBufferInfo{
+                .buffer = output.buffer,
+                .offset = output.offset,
+                .range = output.size,
+            }
+        };
+
+        std::array<vk::WriteDescriptorSet, 3> writes{};
+        for (u32 i{}; i < writes.size(); i++)
+            writes[i] = vk::WriteDescriptorSet{
+                .dstBinding = i,
+                .descriptorType = vk::DescriptorType::eStorageBuffer,
+                .descriptorCount = 1,
+                .dstSet = descriptorSet,
+                .pBufferInfo = &bufferInfos[i]
+            };
+
+        gpu.vkDevice.updateDescriptorSets(writes, nullptr);
+
+        // The guest command and indices may have been written by any prior GPU work
+        commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eAllCommands, vk::PipelineStageFlagBits::eComputeShader, {}, {vk::MemoryBarrier{
+            .srcAccessMask = vk::AccessFlagBits::eMemoryWrite,
+            .dstAccessMask = vk::AccessFlagBits::eShaderRead,
+        }}, {}, {});
+
+        indirect_conversion::ComputePushConstantLayout pushConstants{
+            .cmdOffset = static_cast<u32>((command.offset - commandAlignedOffset) / sizeof(u32)),
+            .srcOffset = static_cast<u32>(indices.offset - indicesAlignedOffset),
+            .indexSize = indexSize,
+            .maxPrimitives = maxPrimitives,
+            .mode = mode,
+        };
+
+        commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, *pipeline);
+        commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute, *pipelineLayout, 0, descriptorSet, nullptr);
+        commandBuffer.pushConstants(*pipelineLayout, vk::ShaderStageFlagBits::eCompute, 0, vk::ArrayProxy<const indirect_conversion::ComputePushConstantLayout>{pushConstants});
+        // At least a single invocation is always required to write the draw command
+        commandBuffer.dispatch(util::DivideCeil(std::max(maxPrimitives, 1U), indirect_conversion::WorkgroupSize), 1, 1);
+
+        commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eDrawIndirect | vk::PipelineStageFlagBits::eVertexInput, {}, {vk::MemoryBarrier{
+            .srcAccessMask = vk::AccessFlagBits::eShaderWrite,
+            .dstAccessMask = vk::AccessFlagBits::eIndirectCommandRead | vk::AccessFlagBits::eIndexRead,
+        }}, {}, {});
+    }
+
     HelperShaders::HelperShaders(GPU &gpu, std::shared_ptr<vfs::FileSystem> shaderFileSystem)
         : blitHelperShader(gpu, shaderFileSystem),
-          clearHelperShader(gpu, shaderFileSystem) {}
+          clearHelperShader(gpu, shaderFileSystem),
+          textureDecodeHelperShader(gpu, shaderFileSystem),
+          indirectConversionHelperShader(gpu, shaderFileSystem) {}
 
 }
@@ -14,6 +14,15 @@ namespace skyline::vfs {
 namespace skyline::gpu {
     class TextureView;
     class GPU;
+    struct BufferBinding;
+
+    namespace memory {
+        class StagingBuffer;
+    }
+
+    namespace texture {
+        struct FormatBase;
+    }
 
     extern bool isSampleShadingEnabled;
 
@@ -110,12 +119,140 @@ namespace skyline::gpu {
                   std::function<void(std::function<void(vk::raii::CommandBuffer &, const std::shared_ptr<FenceCycle> &, GPU &, vk::RenderPass, u32)> &&)> &&recordCb);
     };
 
+    /**
+     * @brief Helper compute shader for deswizzling block-linear guest textures and decoding BC1-5 textures on the GPU
+     * @note The shader writes a linear image into a buffer which is then copied into the texture as compressed formats cannot be used as storage images
+     */
+    class TextureDecodeHelperShader {
+      private:
+        vk::raii::ShaderModule shaderModule;
+        vk::raii::DescriptorSetLayout descriptorSetLayout;
+        vk::raii::PipelineLayout pipelineLayout;
+        vk::raii::Pipeline pipeline;
+
+      public:
+        /**
+         * @brief The operation performed by the shader on every block of the subresource, this must match the mode constants in the shader
+         */
+        enum class Mode : u32 {
+            Copy, //!< The format blocks are deswizzled without any conversion
+            Bc1,
+            Bc2,
+            Bc3,
+            Bc4,
+            Bc5,
+        };
+
+        /**
+         * @brief A single block-linear subresource (a layer of a mip level) to decode
+         * @note All offsets and sizes must be aligned to 4 bytes
+         */
+        struct Subresource {
+            u32 srcOffset; //!< The offset of the subresource in the input buffer in bytes
+            u32 dstOffset; //!< The offset of the subresource in the output buffer in bytes
+            u32 width, height, depth; //!< The dimensions of the subresource in texels
+            u32 gobBlockHeight, gobBlockDepth;
+        };
+
+        /**
+         * @brief The state of a decode which must be kept alive till the GPU has finished executing it
+         */
+        struct DecodeState {
+            std::shared_ptr<memory::StagingBuffer> input; //!< A buffer containing the raw guest texture
+            DescriptorAllocator::ActiveDescriptorSet descriptorSet;
+            Mode mode;
+            bool isSigned;
+            u32 formatBlockWidth, formatBlockHeight, formatBpb;
+            std::vector<Subresource> subresources;
+
+            DecodeState(GPU &gpu, vk::DescriptorSetLayout descriptorSetLayout, std::shared_ptr<memory::StagingBuffer> input, Mode mode, bool isSigned, const texture::FormatBase &guestFormat);
+        };
+
+        TextureDecodeHelperShader(GPU &gpu, std::shared_ptr<vfs::FileSystem> shaderFileSystem);
+
+        /**
+         * @return The mode required to convert textures in the guest format into the host format on the GPU, if it's supported
+         * @note Only formats with blocks that are a multiple of 4 bytes in size can be deswizzled as the shader operates on words
+         */
+        static std::optional<Mode> GetMode(const texture::FormatBase &guestFormat, const texture::FormatBase &hostFormat);
+
+        /**
+         * @brief Creates the state for a decode of the supplied guest texture data into the output buffer, subresources must be added to it prior to recording
+         * @param output A buffer which will be filled with the linear texture data in the host format
+         */
+        std::shared_ptr<DecodeState> CreateDecode(GPU &gpu, Mode mode, bool isSigned, const texture::FormatBase &guestFormat,
+                                                  std::shared_ptr<memory::StagingBuffer> input, const std::shared_ptr<memory::StagingBuffer> &output);
+
+        /**
+         * @brief Records a dispatch for every subresource in the decode followed by a barrier for transfers from the output buffer
+         * @note The decode state must be attached to the fence cycle of the command buffer
+         */
+        void RecordDecode(const vk::raii::CommandBuffer &commandBuffer, const DecodeState &state);
+    };
+
+    /**
+     * @brief Helper compute shader for converting the indices of GPU-generated indexed indirect draws with topologies that have no host equivalent into triangle lists on the GPU
+     * @note The shader writes a new indirect draw command followed by the converted 32-bit indices into the output buffer, the command is always at the start of it
+     */
+    class IndirectConversionHelperShader {
+      private:
+        vk::raii::ShaderModule shaderModule;
+        vk::raii::DescriptorSetLayout descriptorSetLayout;
+        vk::raii::PipelineLayout pipelineLayout;
+        vk::raii::Pipeline pipeline;
+
+      public:
+        /**
+         * @brief The guest topology being converted, this must match the mode constants in the shader
+         */
+        enum class Mode : u32 {
+            Quads,
+            QuadStrip,
+            Polygon,
+        };
+
+        static constexpr vk::DeviceSize CommandSize{0x20}; //!< The size of the converted draw command at the start of the output buffer, this is padded so the indices following it are suitably aligned
+        static constexpr u32 MaxConvertedIndexCount{0x100000}; //!< The maximum amount of indices that can be emitted by a single conversion, this bounds the size of the output buffer as the amount of indices is only known on the GPU so larger draws need to be converted on the CPU
+
+        IndirectConversionHelperShader(GPU &gpu, std::shared_ptr<vfs::FileSystem> shaderFileSystem);
+
+        /**
+         * @return The amount of indices emitted for every primitive in the supplied mode
+         */
+        static constexpr u32 GetIndicesPerPrimitive(Mode mode) {
+            return mode == Mode::Polygon ? 3 : 6;
+        }
+
+        /**
+         * @return The maximum amount of primitives that can be generated from an index buffer with the supplied amount of indices
+         * @note This isn't limited by MaxConvertedIndexCount, conversions exceeding it must not be recorded
+         */
+        static u32 GetMaxPrimitiveCount(Mode mode, u32 indexCount);
+
+        vk::DescriptorSetLayout GetDescriptorSetLayout() const {
+            return *descriptorSetLayout;
+        }
+
+        /**
+         * @brief Records a conversion of the guest draw command and the indices it references, followed by a barrier for reading the output as an indirect draw
+         * @param descriptorSet A descriptor set with the layout from GetDescriptorSetLayout(), it is written to while recording so it must not be in use
+         * @param command A binding of the guest VkDrawIndexedIndirectCommand
+         * @param indices A binding of the guest index buffer
+         * @param output A binding of the output buffer, this must be aligned to the minimum storage buffer alignment and have space for the command and `maxPrimitives` primitives
+         */
+        void RecordConversion(GPU &gpu, const vk::raii::CommandBuffer &commandBuffer, vk::DescriptorSet descriptorSet,
+                              const BufferBinding &command, const BufferBinding &indices, u32 indexSize, const BufferBinding &output,
+                              u32 maxPrimitives, Mode mode);
+    };
+
     /**
      * @brief Holds all helper shaders to avoid redundantly recreating them on each usage
      */
     struct HelperShaders {
         BlitHelperShader blitHelperShader;
         ClearHelperShader clearHelperShader;
+        TextureDecodeHelperShader textureDecodeHelperShader;
+        IndirectConversionHelperShader indirectConversionHelperShader;
 
         HelperShaders(GPU &gpu, std::shared_ptr<vfs::FileSystem> shaderFileSystem);
     };
@@ -0,0 +1,1064 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2024 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include <array>
+#include <algorithm>
+#include <cstring>
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#elif defined(__x86_64__)
+#include <emmintrin.h>
+#endif
+#include "astc_decoder.h"
+
+/**
+ * @brief An ASTC LDR decoder implementing the decoding process described in the Khronos Data Format Specification (Section 23)
+ * @note Blocks are decoded to RGBA8 in a per-block scratch buffer, value unquantization and endpoint interpolation have explicit NEON/SSE2 paths which process 8 values or texels at once with a scalar fallback
+ */
+namespace astc {
+    namespace {
+        constexpr size_t MaxBlockDimension{12}; //!< The largest block footprint dimension for 2D ASTC
+        constexpr size_t MaxBlockTexels{MaxBlockDimension * MaxBlockDimension};
+        constexpr size_t MaxWeightCount{64}; //!< The maximum amount of weights in a single block, including both planes
+        constexpr size_t MaxColorValues{18}; //!< The maximum amount of color endpoint values in a single block
+        constexpr size_t Rgba8Bpp{4};
+        constexpr std::array<uint8_t, 4> ErrorColor{0xFF, 0x00, 0xFF, 0xFF}; //!< The color which illegal/HDR blocks decode to, this is opaque magenta
+
+        /**
+         * @brief The encoding of a quantization range in the Integer Sequence Encoding, values consist of an optional trit or quint and a number of bits
+         */
+        struct IseEncoding {
+            uint8_t bits;
+            bool trit;
+            bool quint;
+
+            constexpr size_t GetBitCount(size_t count) const {
+                return (count * bits) + (trit ? ((8 * count) + 4) / 5 : 0) + (quint ? ((7 * count) + 2) / 3 : 0);
+            }
+        };
+
+        /**
+         * @brief All quantization ranges in ascending order, weights can only use the first 12 of these
+         */
+        constexpr std::array<IseEncoding, 21> IseEncodings{{
+            {1, false, false}, // 2
+            {0, true, false}, // 3
+            {2, false, false}, // 4
+            {0, false, true}, // 5
+            {1, true, false}, // 6
+            {3, false, false}, // 8
+            {1, false, true}, // 10
+            {2, true, false}, // 12
+            {4, false, false}, // 16
+            {2, false, true}, // 20
+            {3, true, false}, // 24
+            {5, false, false}, // 32
+            {3, false, true}, // 40
+            {4, true, false}, // 48
+            {6, false, false}, // 64
+            {4, false, true}, // 80
+            {5, true, false}, // 96
+            {7, false, false}, // 128
+            {5, false, true}, // 160
+            {6, true, false}, // 192
+            {8, false, false}, // 256
+        }};
+        constexpr size_t WeightRangeCount{12};
+
+        constexpr uint32_t ReplicateBits(uint32_t value, uint32_t bits, uint32_t targetBits) {
+            if (bits == 0)
+                return 0;
+            uint32_t result{};
+            for (int shift{static_cast<int>(targetBits)}; shift > 0;) {
+                shift -= static_cast<int>(bits);
+                result |= shift >= 0 ? value << shift : value >> -shift;
+            }
+            return result & ((1U << targetBits) - 1);
+        }
+
+        /**
+         * @brief Unquantizes a color endpoint value to the range [0, 255] (Section 23.13)
+         */
+        constexpr uint8_t UnquantizeColorValue(uint32_t value, IseEncoding encoding) {
+            if (!encoding.trit && !encoding.quint)
+                return static_cast<uint8_t>(ReplicateBits(value, encoding.bits, 8));
+
+            if (encoding.bits == 0) {
+                constexpr std::array<uint8_t, 3> TritValues{0, 128, 255};
+                constexpr std::array<uint8_t, 5> QuintValues{0, 64, 128, 191, 255};
+                return encoding.trit ? TritValues[std::min<uint32_t>(value, 2)] : QuintValues[std::min<uint32_t>(value, 4)];
+            }
+
+            uint32_t bits{value & ((1U << encoding.bits) - 1)}, digit{value >> encoding.bits};
+            uint32_t a{(bits & 1) ? 0x1FFU : 0U}, b{}, c{};
+            uint32_t x{bits >> 1};
+            if (encoding.trit) {
+                switch (encoding.bits) {
+                    case 1: c = 204; break;
+                    case 2: b = (x << 8) | (x << 4) | (x << 2) | (x << 1); c = 93; break;
+                    case 3: b = (x << 7) | (x << 2) | x; c = 44; break;
+                    case 4: b = (x << 6) | x; c = 22; break;
+                    case 5: b = (x << 5) | (x >> 2); c = 11; break;
+                    case 6: b = (x << 4) | (x >> 4); c = 5; break;
+                    default: break;
+                }
+            } else {
+                switch (encoding.bits) {
+                    case 1: c = 113; break;
+                    case 2: b = (x << 8) | (x << 3) | (x << 2); c = 54; break;
+                    case 3: b = (x << 7) | (x << 1) | (x >> 1); c = 26; break;
+                    case 4: b = (x << 6) | (x >> 1); c = 13; break;
+                    case 5: b = (x << 5) | (x >> 3); c = 6; break;
+                    default: break;
+                }
+            }
+
+            uint32_t t{((digit * c) + b) ^ a};
+            return static_cast<uint8_t>((a & 0x80) | (t >> 2));
+        }
+
+        /**
+         * @brief Unquantizes a weight value to the range [0, 64] (Section 23.18)
+         */
+        constexpr uint8_t UnquantizeWeightValue(uint32_t value, IseEncoding encoding) {
+            uint32_t result{};
+            if (!encoding.trit && !encoding.quint) {
+                result = ReplicateBits(value, encoding.bits, 6);
+            } else if (encoding.bits == 0) {
+                constexpr std::array<uint8_t, 3> TritValues{0, 32, 63};
+                constexpr std::array<uint8_t, 5> QuintValues{0, 16, 32, 47, 63};
+                result = encoding.trit ? TritValues[std::min<uint32_t>(value, 2)] : QuintValues[std::min<uint32_t>(value, 4)];
+            } else {
+                uint32_t bits{value & ((1U << encoding.bits) - 1)}, digit{value >> encoding.bits};
+                uint32_t a{(bits & 1) ? 0x7FU : 0U}, b{}, c{};
+                uint32_t x{bits >> 1};
+                if (encoding.trit) {
+                    switch (encoding.bits) {
+                        case 1: c = 50; break;
+                        case 2: b = (x << 6) | (x << 2) | x; c = 23; break;
+                        case 3: b = (x << 5) | x; c = 11; break;
+                        default: break;
+                    }
+                } else {
+                    switch (encoding.bits) {
+                        case 1: c = 28; break;
+                        case 2: b = (x << 6) | (x << 1); c = 13; break;
+                        default: break;
+                    }
+                }
+
+                uint32_t t{((digit * c) + b) ^ a};
+                result = (a & 0x20) | (t >> 2);
+            }
+            return static_cast<uint8_t>(result > 32 ? result + 1 : result);
+        }
+
+        /**
+         * @brief The parameters of an arithmetic form of unquantization which can be evaluated for many values at once
+         * @note Bit-only ranges replicate bits with a multiply and shift, trit/quint ranges without bits round the digit to the target range in the same way
+         * @note Trit/quint ranges with bits use the bit manipulation of the specification where every OR of shifted values is disjoint and can be an addition
+         */
+        struct UnquantizationParameters {
+            bool direct; //!< If the value is unquantized as ((value * multiplier) + bias) >> shift
+            uint16_t multiplier, bias, shift;
+            uint16_t bits; //!< The amount of bits alongside the trit/quint digit
+            uint16_t c; //!< The multiplier of the trit/quint digit
+            uint16_t bMultiplier, bShift; //!< The bit manipulation of the value bits excluding the lowest bit: (x * bMultiplier) + (x >> bShift)
+            uint16_t aMask, aBit; //!< The mask applied when the lowest bit is set and the bit of it which is transferred to the result
+            bool isWeight; //!< If values above 32 are incremented to expand the range to [0, 64]
+
+            /**
+             * @brief Unquantizes a single value with the same arithmetic as the vectorised path
+             */
+            constexpr uint8_t operator()(uint32_t value) const {
+                uint32_t result;
+                if (direct) {
+                    result = ((value * multiplier) + bias) >> shift;
+                } else {
+                    uint32_t low{value & ((1U << bits) - 1)}, digit{value >> bits};
+                    uint32_t a{(low & 1) ? aMask : 0U}, x{low >> 1};
+                    uint32_t t{((digit * c) + (x * bMultiplier) + (x >> bShift)) ^ a};
+                    result = (a & aBit) | (t >> 2);
+                }
+                return static_cast<uint8_t>((isWeight && result > 32) ? result + 1 : result);
+            }
+        };
+
+        constexpr UnquantizationParameters GetUnquantizationParameters(IseEncoding encoding, bool isWeight) {
+            uint16_t targetBits{static_cast<uint16_t>(isWeight ? 6 : 8)};
+            UnquantizationParameters result{.bShift = 16, .isWeight = isWeight};
+            if (!encoding.trit && !encoding.quint) {
+                // Replicating the bits is multiplying by 1 at every multiple of the bit count then discarding the excess low bits
+                uint16_t replications{static_cast<uint16_t>((targetBits + encoding.bits - 1) / encoding.bits)};
+                result.direct = true;
+                for (uint16_t replication{}; replication < replications; replication++)
+                    result.multiplier |= 1U << (replication * encoding.bits);
+                result.shift = (replications * encoding.bits) - targetBits;
+            } else if (encoding.bits == 0) {
+                // The values are evenly distributed over the target range, rounded to the nearest value
+                result.direct = true;
+                result.multiplier = (1U << targetBits) - 1;
+                result.bias = encoding.trit ? 1 : 2;
+                result.shift = encoding.trit ? 1 : 2;
+            } else {
+                result.bits = encoding.bits;
+                result.aMask = isWeight ? 0x7F : 0x1FF;
+                result.aBit = isWeight ? 0x20 : 0x80;
+
+                struct Manipulation {
+                    uint16_t c, bMultiplier, bShift{16};
+                };
+                Manipulation manipulation{};
+                if (isWeight) {
+                    if (encoding.trit) {
+                        switch (encoding.bits) {
+                            case 1: manipulation = {50, 0}; break;
+                            case 2: manipulation = {23, 0b1000101}; break; // (x << 6) | (x << 2) | x
+                            case 3: manipulation = {11, 0b100001}; break; // (x << 5) | x
+                            default: break;
+                        }
+                    } else {
+                        switch (encoding.bits) {
+                            case 1: manipulation = {28, 0}; break;
+                            case 2: manipulation = {13, 0b1000010}; break; // (x << 6) | (x << 1)
+                            default: break;
+                        }
+                    }
+                } else {
+                    if (encoding.trit) {
+                        switch (encoding.bits) {
+                            case 1: manipulation = {204, 0}; break;
+                            case 2: manipulation = {93, 0b100010110}; break; // (x << 8) | (x << 4) | (x << 2) | (x << 1)
+                            case 3: manipulation = {44, 0b10000101}; break; // (x << 7) | (x << 2) | x
+                            case 4: manipulation = {22, 0b1000001}; break; // (x << 6) | x
+                            case 5: manipulation = {11, 0b100000, 2}; break; // (x << 5) | (x >> 2)
+                            case 6: manipulation = {5, 0b10000, 4}; break; // (x << 4) | (x >> 4)
+                            default: break;
+                        }
+                    } else {
+                        switch (encoding.bits) {
+                            case 1: manipulation = {113, 0}; break;
+                            case 2: manipulation = {54, 0b100001100}; break; // (x << 8) | (x << 3) | (x << 2)
+                            case 3: manipulation = {26, 0b10000010, 1}; break; // (x << 7) | (x << 1) | (x >> 1)
+                            case 4: manipulation = {13, 0b1000000, 1}; break; // (x << 6) | (x >> 1)
+                            case 5: manipulation = {6, 0b100000, 3}; break; // (x << 5) | (x >> 3)
+                            default: break;
+                        }
+                    }
+                }
+                result.c = manipulation.c;
+                result.bMultiplier = manipulation.bMultiplier;
+                result.bShift = manipulation.bShift;
+            }
+            return result;
+        }
+
+        /**
+         * @brief The unquantization parameters of every range for color endpoints and weights
+         */
+        struct UnquantizationTables {
+            std::array<UnquantizationParameters, IseEncodings.size()> color{};
+            std::array<UnquantizationParameters, WeightRangeCount> weight{};
+
+            constexpr UnquantizationTables() {
+                for (size_t range{}; range < IseEncodings.size(); range++) {
+                    color[range] = GetUnquantizationParameters(IseEncodings[range], false);
+                    if (range < WeightRangeCount)
+                        weight[range] = GetUnquantizationParameters(IseEncodings[range], true);
+                }
+            }
+
+            /**
+             * @return If the arithmetic unquantization of every value in every range matches the unquantization procedure in the specification
+             */
+            constexpr bool Verify() const {
+                for (size_t range{}; range < IseEncodings.size(); range++) {
+                    auto encoding{IseEncodings[range]};
+                    uint32_t digits{encoding.trit ? 3U : (encoding.quint ? 5U : 1U)};
+                    uint32_t valueCount{digits << encoding.bits};
+                    for (uint32_t value{}; value < valueCount; value++) {
+                        if (color[range](value) != UnquantizeColorValue(value, encoding))
+                            return false;
+                        if (range < WeightRangeCount && weight[range](value) != UnquantizeWeightValue(value, encoding))
+                            return false;
+                    }
+                }
+                return true;
+            }
+        };
+
+        constexpr UnquantizationTables Unquantization{};
+        static_assert(Unquantization.Verify(), "Arithmetic unquantization must match the specification");
+
+        constexpr size_t UnquantizationBatch{8}; //!< The amount of values unquantized at once
+
+        /**
+         * @brief Unquantizes a group of UnquantizationBatch ISE values in place
+         */
+        inline void UnquantizeBatch(const UnquantizationParameters &params, uint8_t *values) {
+#if defined(__aarch64__)
+            uint16x8_t value{vmovl_u8(vld1_u8(values))}, result;
+            if (params.direct) {
+                result = vshlq_u16(vmlaq_n_u16(vdupq_n_u16(params.bias), value, params.multiplier), vdupq_n_s16(static_cast<int16_t>(-params.shift)));
+            } else {
+                uint16x8_t low{vandq_u16(value, vdupq_n_u16(static_cast<uint16_t>((1U << params.bits) - 1)))};
+                uint16x8_t digit{vshlq_u16(value, vdupq_n_s16(static_cast<int16_t>(-params.bits)))};
+                uint16x8_t a{vandq_u16(vtstq_u16(low, vdupq_n_u16(1)), vdupq_n_u16(params.aMask))};
+                uint16x8_t x{vshrq_n_u16(low, 1)};
+                uint16x8_t b{vmlaq_n_u16(vshlq_u16(x, vdupq_n_s16(static_cast<int16_t>(-params.bShift))), x, params.bMultiplier)};
+                uint16x8_t t{veorq_u16(vmlaq_n_u16(b, digit, params.c), a)};
+                result = vorrq_u16(vandq_u16(a, vdupq_n_u16(params.aBit)), vshrq_n_u16(t, 2));
+            }
+            if (params.isWeight)
+                result = vsubq_u16(result, vcgtq_u16(result, vdupq_n_u16(32)));
+            vst1_u8(values, vmovn_u16(result));
+#elif defined(__x86_64__)
+            auto splat{[](uint32_t value) { return _mm_set1_epi16(static_cast<short>(value)); }};
+            auto shiftCount{[](uint32_t value) { return _mm_cvtsi32_si128(static_cast<int>(value)); }};
+            __m128i zero{_mm_setzero_si128()};
+            __m128i value{_mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(values)), zero)}, result;
+            if (params.direct) {
+                result = _mm_srl_epi16(_mm_add_epi16(_mm_mullo_epi16(value, splat(params.multiplier)), splat(params.bias)), shiftCount(params.shift));
+            } else {
+                __m128i one{splat(1)};
+                __m128i low{_mm_and_si128(value, splat((1U << params.bits) - 1))};
+                __m128i digit{_mm_srl_epi16(value, shiftCount(params.bits))};
+                __m128i a{_mm_and_si128(_mm_cmpeq_epi16(_mm_and_si128(low, one), one), splat(params.aMask))};
+                __m128i x{_mm_srli_epi16(low, 1)};
+                __m128i b{_mm_add_epi16(_mm_mullo_epi16(x, splat(params.bMultiplier)), _mm_srl_epi16(x, shiftCount(params.bShift)))};
+                __m128i t{_mm_xor_si128(_mm_add_epi16(_mm_mullo_epi16(digit, splat(params.c)), b), a)};
+                result = _mm_or_si128(_mm_and_si128(a, splat(params.aBit)), _mm_srli_epi16(t, 2));
+            }
+            if (params.isWeight)
+                result = _mm_sub_epi16(result, _mm_cmpgt_epi16(result, splat(32)));
+            _mm_storel_epi64(reinterpret_cast<__m128i *>(values), _mm_packus_epi16(result, zero));
+#else
+            for (size_t i{}; i < UnquantizationBatch; i++)
+                values[i] = params(values[i]);
+#endif
+        }
+
+        /**
+         * @brief Unquantizes the supplied amount of ISE values in place
+         */
+        void UnquantizeValues(const UnquantizationParameters &params, uint8_t *values, size_t count) {
+            size_t index{};
+            for (; index + UnquantizationBatch <= count; index += UnquantizationBatch)
+                UnquantizeBatch(params, values + index);
+
+            if (index < count) {
+                std::array<uint8_t, UnquantizationBatch> tail{};
+                std::memcpy(tail.data(), values + index, count - index);
+                UnquantizeBatch(params, tail.data());
+                std::memcpy(values + index, tail.data(), count - index);
+            }
+        }
+
+        /**
+         * @brief A 128-bit ASTC block which bits are read from in little-endian bit order
+         */
+        struct Block {
+            uint64_t low, high;
+
+            uint32_t GetBits(size_t offset, size_t count) const {
+                if (count == 0)
+                    return 0;
+                uint64_t value;
+                if (offset >= 64)
+                    value = high >> (offset - 64);
+                else if (offset == 0)
+                    value = low;
+                else
+                    value = (low >> offset) | (high << (64 - offset));
+                return static_cast<uint32_t>(value & ((1ULL << count) - 1));
+            }
+
+            /**
+             * @return A copy of the block with the order of all 128 bits reversed, weights are stored in this order from the top of the block
+             */
+            Block Reversed() const {
+                auto reverse{[](uint64_t value) {
+                    value = ((value >> 1) & 0x5555555555555555ULL) | ((value & 0x5555555555555555ULL) << 1);
+                    value = ((value >> 2) & 0x3333333333333333ULL) | ((value & 0x3333333333333333ULL) << 2);
+                    value = ((value >> 4) & 0x0F0F0F0F0F0F0F0FULL) | ((value & 0x0F0F0F0F0F0F0F0FULL) << 4);
+                    return __builtin_bswap64(value);
+                }};
+                return Block{reverse(high), reverse(low)};
+            }
+        };
+
+        /**
+         * @brief Reads an Integer Sequence Encoded stream from a block, bits past the end of the stream are read as zero
+         */
+        class IseReader {
+          private:
+            const Block &block;
+            size_t offset;
+            size_t end;
+
+            uint32_t Read(size_t count) {
+                size_t available{offset < end ? std::min(count, end - offset) : 0};
+                uint32_t value{block.GetBits(offset, available)};
+                offset += count;
+                return value;
+            }
+
+          public:
+            IseReader(const Block &block, size_t offset, size_t length) : block{block}, offset{offset}, end{offset + length} {}
+
+            /**
+             * @brief Decodes the supplied amount of values, the values are combined digits and bits (digit * 2^bits + bits)
+             */
+            void Decode(IseEncoding encoding, size_t count, uint8_t *output) {
+                size_t bits{encoding.bits};
+                if (encoding.trit) {
+                    for (size_t index{}; index < count; index += 5) {
+                        std::array<uint32_t, 5> m{};
+                        uint32_t t;
+                        m[0] = Read(bits);
+                        t = Read(2);
+                        m[1] = Read(bits);
+                        t |= Read(2) << 2;
+                        m[2] = Read(bits);
+                        t |= Read(1) << 4;
+                        m[3] = Read(bits);
+                        t |= Read(2) << 5;
+                        m[4] = Read(bits);
+                        t |= Read(1) << 7;
+
+                        std::array<uint32_t, 5> trits{};
+                        uint32_t c;
+                        if (((t >> 2) & 7) == 7) {
+                            c = (((t >> 5) & 7) << 2) | (t & 3);
+                            trits[4] = 2;
+                            trits[3] = 2;
+                        } else {
+                            c = t & 0x1F;
+                            if (((t >> 5) & 3) == 3) {
+                                trits[4] = 2;
+                                trits[3] = (t >> 7) & 1;
+                            } else {
+                                trits[4] = (t >> 7) & 1;
+                                trits[3] = (t >> 5) & 3;
+                            }
+                        }
+
+                        if ((c & 3) == 3) {
+                            trits[2] = 2;
+                            trits[1] = (c >> 4) & 1;
+                            trits[0] = (((c >> 3) & 1) << 1) | ((c >> 2) & ~(c >> 3) & 1);
+                        } else if (((c >> 2) & 3) == 3) {
+                            trits[2] = 2;
+                            trits[1] = 2;
+                            trits[0] = c & 3;
+                        } else {
+                            trits[2] = (c >> 4) & 1;
+                            trits[1] = (c >> 2) & 3;
+                            trits[0] = (((c >> 1) & 1) << 1) | (c & ~(c >> 1) & 1);
+                        }
+
+                        for (size_t i{}; i < 5 && index + i < count; i++)
+                            output[index + i] = static_cast<uint8_t>((trits[i] << bits) | m[i]);
+                    }
+                } else if (encoding.quint) {
+                    for (size_t index{}; index < count; index += 3) {
+                        std::array<uint32_t, 3> m{};
+                        uint32_t q;
+                        m[0] = Read(bits);
+                        q = Read(3);
+                        m[1] = Read(bits);
+                        q |= Read(2) << 3;
+                        m[2] = Read(bits);
+                        q |= Read(2) << 5;
+
+                        std::array<uint32_t, 3> quints{};
+                        if (((q >> 1) & 3) == 3 && ((q >> 5) & 3) == 0) {
+                            uint32_t notQ0{~q & 1};
+                            quints[2] = ((q & 1) << 2) | ((((q >> 4) & 1) & notQ0) << 1) | (((q >> 3) & 1) & notQ0);
+                            quints[1] = 4;
+                            quints[0] = 4;
+                        } else {
+                            uint32_t c;
+                            if (((q >> 1) & 3) == 3) {
+                                quints[2] = 4;
+                                c = (((q >> 3) & 3) << 3) | ((~(q >> 5) & 3) << 1) | (q & 1);
+                            } else {
+                                quints[2] = (q >> 5) & 3;
+                                c = q & 0x1F;
+                            }
+
+                            if ((c & 7) == 5) {
+                                quints[1] = 4;
+                                quints[0] = (c >> 3) & 3;
+                            } else {
+                                quints[1] = (c >> 3) & 3;
+                                quints[0] = c & 7;
+                            }
+                        }
+
+                        for (size_t i{}; i < 3 && index + i < count; i++)
+                            output[index + i] = static_cast<uint8_t>((quints[i] << bits) | m[i]);
+                    }
+                } else {
+                    for (size_t index{}; index < count; index++)
+                        output[index] = static_cast<uint8_t>(Read(bits));
+                }
+            }
+        };
+
+        /**
+         * @brief The weight grid parameters encoded in the block mode (Section 23.10)
+         */
+        struct BlockMode {
+            uint32_t gridWidth;
+            uint32_t gridHeight;
+            bool dualPlane;
+            uint32_t weightRange; //!< An index into IseEncodings
+        };
+
+        /**
+         * @return If the block mode is legal, the decoded block mode is written to the supplied reference
+         */
+        bool DecodeBlockMode(uint32_t mode, BlockMode &result) {
+            uint32_t range{(mode >> 4) & 1};
+            bool highPrecision{((mode >> 9) & 1) != 0}, dualPlane{((mode >> 10) & 1) != 0};
+            uint32_t a{(mode >> 5) & 3};
+            uint32_t width, height;
+
+            if ((mode & 3) != 0) {
+                range |= (mode & 3) << 1;
+                uint32_t b{(mode >> 7) & 3};
+                switch ((mode >> 2) & 3) {
+                    case 0:
+                        width = b + 4;
+                        height = a + 2;
+                        break;
+                    case 1:
+                        width = b + 8;
+                        height = a + 2;
+                        break;
+                    case 2:
+                        width = a + 2;
+                        height = b + 8;
+                        break;
+                    default:
+                        b &= 1;
+                        if (mode & 0x100) {
+                            width = b + 2;
+                            height = a + 2;
+                        } else {
+                            width = a + 2;
+                            height = b + 6;
+                        }
+                        break;
+                }
+            } else {
+                range |= ((mode >> 2) & 3) << 1;
+                if (((mode >> 2) & 3) == 0)
+                    return false; // Reserved, this also covers void-extent blocks which must be handled prior
+
+                uint32_t b{(mode >> 9) & 3};
+                switch ((mode >> 7) & 3) {
+                    case 0:
+                        width = 12;
+                        height = a + 2;
+                        break;
+                    case 1:
+                        width = a + 2;
+                        height = 12;
+                        break;
+                    case 2:
+                        width = a + 6;
+                        height = b + 6;
+                        dualPlane = false;
+                        highPrecision = false;
+                        break;
+                    default:
+                        if (((mode >> 5) & 3) == 0) {
+                            width = 6;
+                            height = 10;
+                        } else if (((mode >> 5) & 3) == 1) {
+                            width = 10;
+                            height = 6;
+                        } else {
+                            return false;
+                        }
+                        break;
+                }
+            }
+
+            result = BlockMode{width, height, dualPlane, (range - 2) + (highPrecision ? 6U : 0U)};
+            return true;
+        }
+
+        uint32_t Hash52(uint32_t value) {
+            value ^= value >> 15;
+            value *= 0xEEDE0891;
+            value ^= value >> 5;
+            value += value << 16;
+            value ^= value >> 7;
+            value ^= value >> 3;
+            value ^= value << 6;
+            value ^= value >> 17;
+            return value;
+        }
+
+        /**
+         * @brief Computes the partition of every texel in a block with the partition pattern generation function (Section 23.21)
+         */
+        void SelectPartitions(uint32_t seed, uint32_t partitionCount, size_t blockWidth, size_t blockHeight, uint8_t *partitions) {
+            bool smallBlock{blockWidth * blockHeight < 31};
+            seed += (partitionCount - 1) * 1024;
+            uint32_t random{Hash52(seed)};
+
+            std::array<uint32_t, 8> seeds{};
+            for (size_t i{}; i < seeds.size(); i++) {
+                uint32_t value{(random >> (i * 4)) & 0xF};
+                seeds[i] = value * value;
+            }
+
+            uint32_t shift1, shift2;
+            if (seed & 1) {
+                shift1 = (seed & 2) ? 4 : 5;
+                shift2 = (partitionCount == 3) ? 6 : 5;
+            } else {
+                shift1 = (partitionCount == 3) ? 6 : 5;
+                shift2 = (seed & 2) ? 4 : 5;
+            }
+            for (size_t i{}; i < seeds.size(); i++)
+                seeds[i] >>= (i & 1) ? shift2 : shift1;
+
+            for (size_t y{}; y < blockHeight; y++) {
+                for (size_t x{}; x < blockWidth; x++) {
+                    uint32_t px{static_cast<uint32_t>(smallBlock ? x << 1 : x)}, py{static_cast<uint32_t>(smallBlock ? y << 1 : y)};
+                    uint32_t a{((seeds[0] * px) + (seeds[1] * py) + (random >> 14)) & 0x3F};
+                    uint32_t b{((seeds[2] * px) + (seeds[3] * py) + (random >> 10)) & 0x3F};
+                    uint32_t c{partitionCount < 3 ? 0 : ((seeds[4] * px) + (seeds[5] * py) + (random >> 6)) & 0x3F};
+                    uint32_t d{partitionCount < 4 ? 0 : ((seeds[6] * px) + (seeds[7] * py) + (random >> 2)) & 0x3F};
+
+                    uint8_t partition;
+                    if (a >= b && a >= c && a >= d)
+                        partition = 0;
+                    else if (b >= c && b >= d)
+                        partition = 1;
+                    else if (c >= d)
+                        partition = 2;
+                    else
+                        partition = 3;
+                    partitions[(y * blockWidth) + x] = partition;
+                }
+            }
+        }
+
+        using Endpoint = std::array<int32_t, 4>;
+
+        constexpr int32_t ClampUnorm8(int32_t value) {
+            return std::clamp(value, 0, 255);
+        }
+
+        constexpr Endpoint BlueContract(int32_t r, int32_t g, int32_t b, int32_t a) {
+            return {(r + b) >> 1, (g + b) >> 1, b, a};
+        }
+
+        /**
+         * @brief Transfers the top bit of a delta value into its base and sign-extends the delta (Section 23.13.3)
+         */
+        constexpr void BitTransferSigned(int32_t &delta, int32_t &base) {
+            base >>= 1;
+            base |= delta & 0x80;
+            delta >>= 1;
+            delta &= 0x3F;
+            if (delta & 0x20)
+                delta -= 0x40;
+        }
+
+        /**
+         * @brief Decodes a pair of LDR color endpoints from their unquantized values (Section 23.13.3)
+         * @return If the endpoint mode is an LDR mode, HDR modes are illegal in the LDR profile
+         */
+        bool DecodeEndpoints(uint32_t mode, const uint8_t *values, Endpoint &e0, Endpoint &e1) {
+            std::array<int32_t, 8> v{};
+            for (size_t i{}; i < ((mode >> 2) + 1) * 2; i++)
+                v[i] = values[i];
+
+            switch (mode) {
+                case 0: // Luminance, direct
+                    e0 = {v[0], v[0], v[0], 0xFF};
+                    e1 = {v[1], v[1], v[1], 0xFF};
+                    return true;
+
+                case 1: { // Luminance, base+offset
+                    int32_t l0{(v[0] >> 2) | (v[1] & 0xC0)};
+                    int32_t l1{std::min(l0 + (v[1] & 0x3F), 0xFF)};
+                    e0 = {l0, l0, l0, 0xFF};
+                    e1 = {l1, l1, l1, 0xFF};
+                    return true;
+                }
+
+                case 4: // Luminance-Alpha, direct
+                    e0 = {v[0], v[0], v[0], v[2]};
+                    e1 = {v[1], v[1], v[1], v[3]};
+                    return true;
+
+                case 5: // Luminance-Alpha, base+offset
+                    BitTransferSigned(v[1], v[0]);
+                    BitTransferSigned(v[3], v[2]);
+                    e0 = {v[0], v[0], v[0], v[2]};
+                    e1 = {ClampUnorm8(v[0] + v[1]), ClampUnorm8(v[0] + v[1]), ClampUnorm8(v[0] + v[1]), ClampUnorm8(v[2] + v[3])};
+                    return true;
+
+                case 6: // RGB, base+scale
+                    e0 = {(v[0] * v[3]) >> 8, (v[1] * v[3]) >> 8, (v[2] * v[3]) >> 8, 0xFF};
+                    e1 = {v[0], v[1], v[2], 0xFF};
+                    return true;
+
+                case 8: // RGB, direct
+                case 12: { // RGBA, direct
+                    bool hasAlpha{mode == 12};
+                    if (v[1] + v[3] + v[5] >= v[0] + v[2] + v[4]) {
+                        e0 = {v[0], v[2], v[4], hasAlpha ? v[6] : 0xFF};
+                        e1 = {v[1], v[3], v[5], hasAlpha ? v[7] : 0xFF};
+                    } else {
+                        e0 = BlueContract(v[1], v[3], v[5], hasAlpha ? v[7] : 0xFF);
+                        e1 = BlueContract(v[0], v[2], v[4], hasAlpha ? v[6] : 0xFF);
+                    }
+                    return true;
+                }
+
+                case 9: // RGB, base+offset
+                case 13: { // RGBA, base+offset
+                    bool hasAlpha{mode == 13};
+                    BitTransferSigned(v[1], v[0]);
+                    BitTransferSigned(v[3], v[2]);
+                    BitTransferSigned(v[5], v[4]);
+                    if (hasAlpha)
+                        BitTransferSigned(v[7], v[6]);
+                    else
+                        v[6] = 0xFF, v[7] = 0;
+
+                    if (v[1] + v[3] + v[5] >= 0) {
+                        e0 = {v[0], v[2], v[4], v[6]};
+                        e1 = {ClampUnorm8(v[0] + v[1]), ClampUnorm8(v[2] + v[3]), ClampUnorm8(v[4] + v[5]), ClampUnorm8(v[6] + v[7])};
+                    } else {
+                        e0 = BlueContract(ClampUnorm8(v[0] + v[1]), ClampUnorm8(v[2] + v[3]), ClampUnorm8(v[4] + v[5]), ClampUnorm8(v[6] + v[7]));
+                        e1 = BlueContract(v[0], v[2], v[4], v[6]);
+                    }
+                    return true;
+                }
+
+                case 10: // RGB, base+scale plus two alpha values
+                    e0 = {(v[0] * v[3]) >> 8, (v[1] * v[3]) >> 8, (v[2] * v[3]) >> 8, v[4]};
+                    e1 = {v[0], v[1], v[2], v[5]};
+                    return true;
+
+                default: // HDR modes (2, 3, 7, 11, 14, 15)
+                    return false;
+            }
+        }
+
+        /**
+         * @brief Converts a 16-bit decoded value to 8-bit, sRGB formats use the top 8 bits while UNORM formats are rounded to the nearest value
+         */
+        template<bool IsSrgb>
+        inline uint8_t ConvertToUnorm8(uint32_t value) {
+            if constexpr (IsSrgb)
+                return static_cast<uint8_t>(value >> 8);
+            else
+                return static_cast<uint8_t>(((value * 255) + 32767) / 65535);
+        }
+
+        void FillBlock(uint8_t *texels, size_t texelCount, std::array<uint8_t, 4> color) {
+            for (size_t i{}; i < texelCount; i++)
+                std::memcpy(texels + (i * Rgba8Bpp), color.data(), Rgba8Bpp);
+        }
+
+        /**
+         * @brief Bilinearly infills the weights of a plane from the weight grid to the block footprint (Section 23.19)
+         * @param gridWeights The unquantized weights of the plane, this must be padded with at least gridWidth + 1 entries
+         */
+        void InfillWeights(const uint8_t *gridWeights, uint32_t gridWidth, uint32_t gridHeight, size_t blockWidth, size_t blockHeight, uint8_t *weights) {
+            if (gridWidth == blockWidth && gridHeight == blockHeight) {
+                std::memcpy(weights, gridWeights, blockWidth * blockHeight);
+                return;
+            }
+
+            uint32_t ds{static_cast<uint32_t>((1024 + (blockWidth / 2)) / (blockWidth - 1))};
+            uint32_t dt{static_cast<uint32_t>((1024 + (blockHeight / 2)) / (blockHeight - 1))};
+            for (size_t t{}; t < blockHeight; t++) {
+                uint32_t gt{((dt * static_cast<uint32_t>(t) * (gridHeight - 1)) + 32) >> 6};
+                uint32_t jt{gt >> 4}, ft{gt & 0xF};
+                for (size_t s{}; s < blockWidth; s++) {
+                    uint32_t gs{((ds * static_cast<uint32_t>(s) * (gridWidth - 1)) + 32) >> 6};
+                    uint32_t js{gs >> 4}, fs{gs & 0xF};
+
+                    uint32_t w11{((fs * ft) + 8) >> 4};
+                    uint32_t w10{ft - w11}, w01{fs - w11}, w00{16 - fs - ft + w11};
+
+                    const uint8_t *p{gridWeights + js + (jt * gridWidth)};
+                    weights[(t * blockWidth) + s] = static_cast<uint8_t>(((p[0] * w00) + (p[1] * w01) + (p[gridWidth] * w10) + (p[gridWidth + 1] * w11) + 8) >> 4);
+                }
+            }
+        }
+
+        constexpr size_t InterpolationBatch{8}; //!< The amount of texels interpolated at once, MaxBlockTexels is a multiple of this
+
+        using PlanarEndpoints = std::array<std::array<uint16_t, 8>, 4>; //!< The 16-bit expanded endpoints of every partition for each channel, the padding allows loading a full vector
+
+        /**
+         * @brief Interpolates the endpoints of every texel with its weights and converts the result to RGBA8 (Section 23.19)
+         * @param partitions The partition of every texel, this must be readable up to texelCount rounded up to InterpolationBatch
+         * @param channelWeights The weights used for every channel, these must be readable up to texelCount rounded up to InterpolationBatch
+         * @param texels The output texels, these are written up to texelCount rounded up to InterpolationBatch
+         */
+        template<bool IsSrgb>
+        void InterpolateTexels(const PlanarEndpoints &endpoints0, const PlanarEndpoints &endpoints1, const uint8_t *partitions, uint32_t partitionCount, const std::array<const uint8_t *, 4> &channelWeights, size_t texelCount, uint8_t *texels) {
+#if defined(__aarch64__)
+            std::array<uint8x16_t, 4> tables0, tables1;
+            for (size_t channel{}; channel < 4; channel++) {
+                tables0[channel] = vld1q_u8(reinterpret_cast<const uint8_t *>(endpoints0[channel].data()));
+                tables1[channel] = vld1q_u8(reinterpret_cast<const uint8_t *>(endpoints1[channel].data()));
+            }
+
+            auto convert{[](uint32x4_t value) {
+                if constexpr (IsSrgb) {
+                    return vmovn_u32(vshrq_n_u32(value, 8));
+                } else {
+                    // (value * 255 + 32767) / 65535 as a multiply-free division by 65535
+                    uint32x4_t scaled{vmlaq_n_u32(vdupq_n_u32(32767), value, 255)};
+                    return vmovn_u32(vshrq_n_u32(vaddq_u32(vsraq_n_u32(scaled, scaled, 16), vdupq_n_u32(1)), 16));
+                }
+            }};
+
+            for (size_t texel{}; texel < texelCount; texel += InterpolationBatch) {
+                // Every 16-bit lane selects the two little-endian bytes of the endpoint of its partition from the table
+                uint8x16_t byteIndices{vreinterpretq_u8_u16(vmlaq_n_u16(vdupq_n_u16(0x0100), vmovl_u8(vld1_u8(partitions + texel)), 0x0202))};
+                uint8x8x4_t result;
+                for (size_t channel{}; channel < 4; channel++) {
+                    uint16x8_t weight{vmovl_u8(vld1_u8(channelWeights[channel] + texel))};
+                    uint16x8_t inverse{vsubq_u16(vdupq_n_u16(64), weight)};
+                    uint16x8_t c0{vreinterpretq_u16_u8(vqtbl1q_u8(tables0[channel], byteIndices))};
+                    uint16x8_t c1{vreinterpretq_u16_u8(vqtbl1q_u8(tables1[channel], byteIndices))};
+                    uint32x4_t low{vrshrq_n_u32(vmlal_u16(vmull_u16(vget_low_u16(c0), vget_low_u16(inverse)), vget_low_u16(c1), vget_low_u16(weight)), 6)};
+                    uint32x4_t high{vrshrq_n_u32(vmlal_high_u16(vmull_high_u16(c0, inverse), c1, weight), 6)};
+                    result.val[channel] = vmovn_u16(vcombine_u16(convert(low), convert(high)));
+                }
+                vst4_u8(texels + (texel * Rgba8Bpp), result);
+            }
+#elif defined(__x86_64__)
+            auto splat{[](uint32_t value) { return _mm_set1_epi16(static_cast<short>(value)); }};
+            __m128i zero{_mm_setzero_si128()}, sixtyFour{splat(64)}, round{_mm_set1_epi32(32)};
+
+            auto convert{[](__m128i value) {
+                if constexpr (IsSrgb) {
+                    return _mm_srli_epi32(value, 8);
+                } else {
+                    // (value * 255 + 32767) / 65535 as a multiply-free division by 65535
+                    __m128i scaled{_mm_add_epi32(_mm_sub_epi32(_mm_slli_epi32(value, 8), value), _mm_set1_epi32(32767))};
+                    return _mm_srli_epi32(_mm_add_epi32(_mm_add_epi32(scaled, _mm_srli_epi32(scaled, 16)), _mm_set1_epi32(1)), 16);
+                }
+            }};
+
+            for (size_t texel{}; texel < texelCount; texel += InterpolationBatch) {
+                // There's no byte shuffle in SSE2 so the endpoint of every partition is selected with a comparison
+                __m128i partition{_mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(partitions + texel)), zero)};
+                auto lookup{[&](const std::array<uint16_t, 8> &endpoints) {
+                    __m128i value{splat(endpoints[0])};
+                    for (uint32_t index{1}; index < partitionCount; index++) {
+                        __m128i mask{_mm_cmpeq_epi16(partition, splat(index))};
+                        value = _mm_or_si128(_mm_and_si128(mask, splat(endpoints[index])), _mm_andnot_si128(mask, value));
+                    }
+                    return value;
+                }};
+
+                std::array<__m128i, 4> channels;
+                for (size_t channel{}; channel < 4; channel++) {
+                    __m128i weight{_mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(channelWeights[channel] + texel)), zero)};
+                    __m128i inverse{_mm_sub_epi16(sixtyFour, weight)};
+                    __m128i c0{lookup(endpoints0[channel])}, c1{lookup(endpoints1[channel])};
+                    // SSE2 has no 32-bit multiply, the products are assembled from the low and high halves of 16-bit multiplies
+                    __m128i c0Low{_mm_mullo_epi16(c0, inverse)}, c0High{_mm_mulhi_epu16(c0, inverse)};
+                    __m128i c1Low{_mm_mullo_epi16(c1, weight)}, c1High{_mm_mulhi_epu16(c1, weight)};
+                    __m128i low{_mm_add_epi32(_mm_unpacklo_epi16(c0Low, c0High), _mm_unpacklo_epi16(c1Low, c1High))};
+                    __m128i high{_mm_add_epi32(_mm_unpackhi_epi16(c0Low, c0High), _mm_unpackhi_epi16(c1Low, c1High))};
+                    low = convert(_mm_srli_epi32(_mm_add_epi32(low, round), 6));
+                    high = convert(_mm_srli_epi32(_mm_add_epi32(high, round), 6));
+                    channels[channel] = _mm_packus_epi16(_mm_packs_epi32(low, high), zero);
+                }
+
+                __m128i rg{_mm_unpacklo_epi8(channels[0], channels[1])}, ba{_mm_unpacklo_epi8(channels[2], channels[3])};
+                auto *output{reinterpret_cast<__m128i *>(texels + (texel * Rgba8Bpp))};
+                _mm_storeu_si128(output, _mm_unpacklo_epi16(rg, ba));
+                _mm_storeu_si128(output + 1, _mm_unpackhi_epi16(rg, ba));
+            }
+#else
+            for (size_t texel{}; texel < texelCount; texel++) {
+                uint8_t partition{partitions[texel]};
+                for (size_t channel{}; channel < 4; channel++) {
+                    uint32_t weight{channelWeights[channel][texel]};
+                    uint32_t c0{endpoints0[channel][partition]}, c1{endpoints1[channel][partition]};
+                    texels[(texel * Rgba8Bpp) + channel] = ConvertToUnorm8<IsSrgb>(((c0 * (64 - weight)) + (c1 * weight) + 32) >> 6);
+                }
+            }
+#endif
+        }
+
+        /**
+         * @brief Decodes a single ASTC block to RGBA8 texels in a tightly packed blockWidth x blockHeight array
+         * @param texels The output texels, this must have space for MaxBlockTexels texels as texels are written in groups of InterpolationBatch
+         */
+        template<bool IsSrgb>
+        void DecodeBlock(const uint8_t *data, size_t blockWidth, size_t blockHeight, uint8_t *texels) {
+            size_t texelCount{blockWidth * blockHeight};
+
+            Block block;
+            std::memcpy(&block, data, sizeof(Block));
+
+            uint32_t mode{block.GetBits(0, 11)};
+            if ((mode & 0x1FF) == 0x1FC) {
+                // Void-extent block, the entire block is a single constant color
+                if ((mode & 0x200) || block.GetBits(10, 2) != 0b11)
+                    return FillBlock(texels, texelCount, ErrorColor); // HDR void-extent blocks are illegal in the LDR profile
+
+                std::array<uint8_t, 4> color{};
+                for (size_t channel{}; channel < color.size(); channel++)
+                    color[channel] = ConvertToUnorm8<IsSrgb>(block.GetBits(64 + (channel * 16), 16));
+                return FillBlock(texels, texelCount, color);
+            }
+
+            BlockMode blockMode;
+            if (!DecodeBlockMode(mode, blockMode) || blockMode.gridWidth > blockWidth || blockMode.gridHeight > blockHeight)
+                return FillBlock(texels, texelCount, ErrorColor);
+
+            size_t planeCount{blockMode.dualPlane ? 2U : 1U};
+            size_t weightCount{blockMode.gridWidth * blockMode.gridHeight * planeCount};
+            auto weightEncoding{IseEncodings[blockMode.weightRange]};
+            size_t weightBits{weightEncoding.GetBitCount(weightCount)};
+            if (weightCount > MaxWeightCount || weightBits < 24 || weightBits > 96)
+                return FillBlock(texels, texelCount, ErrorColor);
+
+            uint32_t partitionCount{block.GetBits(11, 2) + 1};
+            if (blockMode.dualPlane && partitionCount == 4)
+                return FillBlock(texels, texelCount, ErrorColor);
+
+            std::array<uint32_t, 4> endpointModes{};
+            uint32_t partitionSeed{};
+            size_t colorOffset, belowWeights{128 - weightBits};
+            if (partitionCount == 1) {
+                endpointModes[0] = block.GetBits(13, 4);
+                colorOffset = 17;
+            } else {
+                partitionSeed = block.GetBits(13, 10);
+                colorOffset = 29;
+
+                uint32_t modeBits{block.GetBits(23, 6)};
+                if ((modeBits & 3) == 0) {
+                    endpointModes.fill(modeBits >> 2);
+                } else {
+                    // Endpoint modes differ between partitions, the high bits of the encoding are stored below the weights
+                    size_t extraBits{(3 * partitionCount) - 4};
+                    belowWeights -= extraBits;
+                    uint32_t encoded{modeBits | (block.GetBits(belowWeights, extraBits) << 6)};
+                    uint32_t baseClass{(encoded & 3) - 1};
+                    uint32_t bit{2};
+                    for (uint32_t partition{}; partition < partitionCount; partition++, bit++)
+                        endpointModes[partition] = (((encoded >> bit) & 1) + baseClass) << 2;
+                    for (uint32_t partition{}; partition < partitionCount; partition++, bit += 2)
+                        endpointModes[partition] |= (encoded >> bit) & 3;
+                }
+            }
+
+            uint32_t secondPlaneComponent{};
+            if (blockMode.dualPlane) {
+                belowWeights -= 2;
+                secondPlaneComponent = block.GetBits(belowWeights, 2);
+            }
+
+            size_t colorValueCount{};
+            for (uint32_t partition{}; partition < partitionCount; partition++)
+                colorValueCount += ((endpointModes[partition] >> 2) + 1) * 2;
+            if (belowWeights < colorOffset || colorValueCount > MaxColorValues)
+                return FillBlock(texels, texelCount, ErrorColor);
+
+            size_t colorBits{belowWeights - colorOffset};
+            if (colorBits < ((13 * colorValueCount) + 4) / 5)
+                return FillBlock(texels, texelCount, ErrorColor);
+
+            // The color endpoints use the largest range which fits into the remaining bits
+            size_t colorRange{IseEncodings.size() - 1};
+            while (colorRange > 0 && IseEncodings[colorRange].GetBitCount(colorValueCount) > colorBits)
+                colorRange--;
+
+            std::array<uint8_t, MaxColorValues> colorValues{};
+            IseReader{block, colorOffset, colorBits}.Decode(IseEncodings[colorRange], colorValueCount, colorValues.data());
+            UnquantizeValues(Unquantization.color[colorRange], colorValues.data(), colorValueCount);
+
+            std::array<Endpoint, 4> endpoints0{}, endpoints1{};
+            const uint8_t *partitionValues{colorValues.data()};
+            for (uint32_t partition{}; partition < partitionCount; partition++) {
+                if (!DecodeEndpoints(endpointModes[partition], partitionValues, endpoints0[partition], endpoints1[partition]))
+                    return FillBlock(texels, texelCount, ErrorColor);
+                partitionValues += ((endpointModes[partition] >> 2) + 1) * 2;
+            }
+
+            // Weights are stored in reverse bit order from the top of the block with the planes interleaved
+            std::array<uint8_t, MaxWeightCount> weightValues{};
+            IseReader{block.Reversed(), 0, weightBits}.Decode(weightEncoding, weightCount, weightValues.data());
+            UnquantizeValues(Unquantization.weight[blockMode.weightRange], weightValues.data(), weightCount);
+
+            std::array<std::array<uint8_t, MaxWeightCount + MaxBlockDimension + 1>, 2> gridWeights{};
+            for (size_t i{}; i < weightCount; i++)
+                gridWeights[i % planeCount][i / planeCount] = weightValues[i];
+
+            // The weights are padded with zeroes as they're read in groups of InterpolationBatch texels
+            std::array<std::array<uint8_t, MaxBlockTexels>, 2> weights{};
+            for (size_t plane{}; plane < planeCount; plane++)
+                InfillWeights(gridWeights[plane].data(), blockMode.gridWidth, blockMode.gridHeight, blockWidth, blockHeight, weights[plane].data());
+
+            std::array<uint8_t, MaxBlockTexels> partitions{};
+            if (partitionCount > 1)
+                SelectPartitions(partitionSeed, partitionCount, blockWidth, blockHeight, partitions.data());
+
+            // Endpoints are expanded to 16-bit prior to interpolation, sRGB formats replicate 0x80 into the low bits rather than the high bits
+            PlanarEndpoints expanded0{}, expanded1{};
+            for (uint32_t partition{}; partition < partitionCount; partition++) {
+                for (size_t channel{}; channel < 4; channel++) {
+                    auto expand{[](int32_t value) -> uint16_t {
+                        return static_cast<uint16_t>(IsSrgb ? ((static_cast<uint32_t>(value) << 8) | 0x80) : (static_cast<uint32_t>(value) * 257));
+                    }};
+                    expanded0[channel][partition] = expand(endpoints0[partition][channel]);
+                    expanded1[channel][partition] = expand(endpoints1[partition][channel]);
+                }
+            }
+
+            std::array<const uint8_t *, 4> channelWeights{};
+            for (size_t channel{}; channel < 4; channel++)
+                channelWeights[channel] = weights[(blockMode.dualPlane && channel == secondPlaneComponent) ? 1 : 0].data();
+
+            InterpolateTexels<IsSrgb>(expanded0, expanded1, partitions.data(), partitionCount, channelWeights, texelCount, texels);
+        }
+
+        template<bool IsSrgb>
+        void DecodeImage(const uint8_t *src, uint8_t *dst, size_t width, size_t height, size_t blockWidth, size_t blockHeight) {
+            size_t pitch{width * Rgba8Bpp};
+            std::array<uint8_t, MaxBlockTexels * Rgba8Bpp> texels;
+
+            for (size_t y{}; y < height; y += blockHeight) {
+                size_t rows{std::min(blockHeight, height - y)};
+                for (size_t x{}; x < width; x += blockWidth, src += BlockSize) {
+                    DecodeBlock<IsSrgb>(src, blockWidth, blockHeight, texels.data());
+
+                    size_t columns{std::min(blockWidth, width - x)};
+                    for (size_t row{}; row < rows; row++)
+                        std::memcpy(dst + ((y + row) * pitch) + (x * Rgba8Bpp), texels.data() + (row * blockWidth * Rgba8Bpp), columns * Rgba8Bpp);
+                }
+            }
+        }
+    }
+
+    void DecodeAstc(const uint8_t *src, uint8_t *dst, size_t width, size_t height, size_t blockWidth, size_t blockHeight, bool isSrgb) {
+        if (isSrgb)
+            DecodeImage<true>(src, dst, width, height, blockWidth, blockHeight);
+        else
+            DecodeImage<false>(src, dst, width, height, blockWidth, blockHeight);
+    }
+}
@@ -0,0 +1,18 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2024 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace astc {
+    constexpr size_t BlockSize{16}; //!< The size of a single ASTC block in bytes, this is the same for all footprints
+
+    /**
+     * @brief Decodes an LDR ASTC encoded image with the supplied block footprint to R8G8B8A8
+     * @param isSrgb If the image is sRGB, this selects the 8-bit conversion of the decoded 16-bit values mandated for sRGB formats
+     * @note HDR blocks and illegal encodings are decoded to the error color (opaque magenta) as required of LDR decoders
+     */
+    void DecodeAstc(const uint8_t *src, uint8_t *dst, size_t width, size_t height, size_t blockWidth, size_t blockHeight, bool isSrgb);
+}
@@ -9,6 +9,12 @@
 #include <fmt/printf.h>
 #include <common.h>
 
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#elif defined(__x86_64__)
+#include <emmintrin.h>
+#endif
+
 #ifdef NDEBUG
 #define ASSERT(condition)
 #define ASSERT_MSG(condition, message, ...)
@@ -25,6 +31,128 @@
 namespace {
     constexpr int BlockWidth = 4;
     constexpr int BlockHeight = 4;
+    constexpr int BlockTexels = BlockWidth * BlockHeight;
+
+    // Byte shuffles which expand a row of four 2-bit palette indices into the 16 bytes of the corresponding RGBA8 palette entries
+    constexpr auto PaletteRowShuffles = [] {
+        std::array<std::array<uint8_t, 16>, 256> shuffles{};
+        for (size_t row = 0; row < shuffles.size(); row++)
+            for (size_t byte = 0; byte < 16; byte++)
+                shuffles[row][byte] = static_cast<uint8_t>((((row >> ((byte / 4) * 2)) & 0x3) * 4) + (byte % 4));
+        return shuffles;
+    }();
+
+    // Writes a full row of a BC1-3 block from a palette of four RGBA8 colors and the 8 index bits of the row
+    inline void writePaletteRow(uint8_t *dst, const uint32_t (&palette)[4], size_t rowIndices) {
+#if defined(__aarch64__)
+        uint8x16_t table = vld1q_u8(reinterpret_cast<const uint8_t *>(palette));
+        vst1q_u8(dst, vqtbl1q_u8(table, vld1q_u8(PaletteRowShuffles[rowIndices].data())));
+#else
+        uint32_t row[BlockWidth] = {palette[rowIndices & 0x3], palette[(rowIndices >> 2) & 0x3], palette[(rowIndices >> 4) & 0x3], palette[(rowIndices >> 6) & 0x3]};
+        std::memcpy(dst, row, sizeof(row));
+#endif
+    }
+
+    // Interpolates planar endpoints for all 16 texels of a block with 6-bit weights: ((64 - w) * e0 + w * e1 + 32) >> 6
+    // The result is interleaved into 16 RGBA8 texels in row-major order
+    inline void interpolatePlanar(const uint8_t (&e0)[4][BlockTexels], const uint8_t (&e1)[4][BlockTexels], const uint8_t (&weights)[4][BlockTexels], uint8_t (&out)[BlockTexels * 4]) {
+#if defined(__aarch64__)
+        uint8x16x4_t result;
+        for (int c = 0; c < 4; c++) {
+            uint8x16_t w = vld1q_u8(weights[c]);
+            uint8x16_t wInv = vsubq_u8(vdupq_n_u8(64), w);
+            uint8x16_t a = vld1q_u8(e0[c]), b = vld1q_u8(e1[c]);
+            uint16x8_t low = vmlal_u8(vmull_u8(vget_low_u8(wInv), vget_low_u8(a)), vget_low_u8(w), vget_low_u8(b));
+            uint16x8_t high = vmlal_high_u8(vmull_high_u8(wInv, a), w, b);
+            result.val[c] = vcombine_u8(vrshrn_n_u16(low, 6), vrshrn_n_u16(high, 6));
+        }
+        vst4q_u8(out, result);
+#elif defined(__x86_64__)
+        __m128i zero = _mm_setzero_si128(), sixtyFour = _mm_set1_epi16(64), round = _mm_set1_epi16(32);
+        __m128i channels[4];
+        for (int c = 0; c < 4; c++) {
+            __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i *>(weights[c]));
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(e0[c])), b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(e1[c]));
+            auto lerp = [&](__m128i w16, __m128i a16, __m128i b16) {
+                __m128i sum = _mm_add_epi16(_mm_mullo_epi16(_mm_sub_epi16(sixtyFour, w16), a16), _mm_mullo_epi16(w16, b16));
+                return _mm_srli_epi16(_mm_add_epi16(sum, round), 6);
+            };
+            __m128i low = lerp(_mm_unpacklo_epi8(w, zero), _mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+            __m128i high = lerp(_mm_unpackhi_epi8(w, zero), _mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+            channels[c] = _mm_packus_epi16(low, high);
+        }
+        __m128i rgLow = _mm_unpacklo_epi8(channels[0], channels[1]), rgHigh = _mm_unpackhi_epi8(channels[0], channels[1]);
+        __m128i baLow = _mm_unpacklo_epi8(channels[2], channels[3]), baHigh = _mm_unpackhi_epi8(channels[2], channels[3]);
+        auto *output = reinterpret_cast<__m128i *>(out);
+        _mm_storeu_si128(output + 0, _mm_unpacklo_epi16(rgLow, baLow));
+        _mm_storeu_si128(output + 1, _mm_unpackhi_epi16(rgLow, baLow));
+        _mm_storeu_si128(output + 2, _mm_unpacklo_epi16(rgHigh, baHigh));
+        _mm_storeu_si128(output + 3, _mm_unpackhi_epi16(rgHigh, baHigh));
+#else
+        for (int t = 0; t < BlockTexels; t++)
+            for (int c = 0; c < 4; c++)
+                out[t * 4 + c] = static_cast<uint8_t>(((64 - weights[c][t]) * e0[c][t] + weights[c][t] * e1[c][t] + 32) >> 6);
+#endif
+    }
+
+    // Expands the 48 index bits of a BC4/5 block into 3-bit indices and looks them up in the 8-entry palette, producing 16 texels in row-major order
+    inline void expandChannelIndices(const uint8_t (&palette)[8], uint64_t indices, uint8_t (&out)[BlockTexels]) {
+        uint16_t rows[BlockHeight] = {
+            static_cast<uint16_t>(indices & 0xFFF), static_cast<uint16_t>((indices >> 12) & 0xFFF),
+            static_cast<uint16_t>((indices >> 24) & 0xFFF), static_cast<uint16_t>((indices >> 36) & 0xFFF),
+        };
+#if defined(__aarch64__)
+        // Every row's 12 index bits are broadcast to four lanes which are each shifted right by the offset of their index
+        static constexpr int16_t IndexShifts[8] = {0, -3, -6, -9, 0, -3, -6, -9};
+        int16x8_t shifts = vld1q_s16(IndexShifts);
+        uint16x8_t mask = vdupq_n_u16(0x7);
+        uint16x8_t rows01 = vandq_u16(vshlq_u16(vcombine_u16(vdup_n_u16(rows[0]), vdup_n_u16(rows[1])), shifts), mask);
+        uint16x8_t rows23 = vandq_u16(vshlq_u16(vcombine_u16(vdup_n_u16(rows[2]), vdup_n_u16(rows[3])), shifts), mask);
+        uint8x16_t table = vcombine_u8(vld1_u8(palette), vdup_n_u8(0));
+        vst1q_u8(out, vqtbl1q_u8(table, vcombine_u8(vmovn_u16(rows01), vmovn_u16(rows23))));
+#elif defined(__x86_64__)
+        // SSE2 lacks variable shifts, a high multiply of the row shifted left by 4 with 2^(12 - offset) shifts each lane right by the offset of its index
+        __m128i multipliers = _mm_set_epi16(8, 64, 512, 4096, 8, 64, 512, 4096), mask = _mm_set1_epi16(0x7);
+        auto expandRows = [&](uint16_t first, uint16_t second) {
+            __m128i row = _mm_set_epi16(second, second, second, second, first, first, first, first);
+            return _mm_and_si128(_mm_mulhi_epu16(_mm_slli_epi16(row, 4), multipliers), mask);
+        };
+        __m128i index = _mm_packus_epi16(expandRows(rows[0], rows[1]), expandRows(rows[2], rows[3]));
+        // There's no byte shuffle in SSE2 so the palette lookup selects each of the 8 entries with a comparison
+        __m128i result = _mm_setzero_si128();
+        for (int i = 0; i < 8; i++)
+            result = _mm_or_si128(result, _mm_and_si128(_mm_cmpeq_epi8(index, _mm_set1_epi8(static_cast<char>(i))), _mm_set1_epi8(static_cast<char>(palette[i]))));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out), result);
+#else
+        for (int j = 0; j < BlockHeight; j++)
+            for (int i = 0; i < BlockWidth; i++)
+                out[j * BlockWidth + i] = palette[(rows[j] >> (i * 3)) & 0x7];
+#endif
+    }
+
+    // Interleaves two planar channels of a block into 16 two-channel texels
+    inline void interleaveChannels(const uint8_t (&first)[BlockTexels], const uint8_t (&second)[BlockTexels], uint8_t (&out)[BlockTexels * 2]) {
+#if defined(__aarch64__)
+        uint8x16x2_t texels{{vld1q_u8(first), vld1q_u8(second)}};
+        vst2q_u8(out, texels);
+#elif defined(__x86_64__)
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(first)), b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(second));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out), _mm_unpacklo_epi8(a, b));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out) + 1, _mm_unpackhi_epi8(a, b));
+#else
+        for (int t = 0; t < BlockTexels; t++) {
+            out[t * 2] = first[t];
+            out[t * 2 + 1] = second[t];
+        }
+#endif
+    }
+
+    // Copies a decoded block of 16 texels to the destination, clipping it to the bounds of the image
+    inline void writeBlock(const uint8_t *texels, size_t texelSize, uint8_t *dst, size_t x, size_t y, size_t dstW, size_t dstH, size_t dstPitch) {
+        size_t rowSize = std::min<size_t>(BlockWidth, dstW - x) * texelSize;
+        for (size_t j = 0; j < BlockHeight && (y + j) < dstH; j++)
+            std::memcpy(dst + j * dstPitch, texels + j * BlockWidth * texelSize, rowSize);
+    }
 
     struct BC_color {
         void decode(uint8_t *dst, size_t x, size_t y, size_t dstW, size_t dstH, size_t dstPitch, size_t dstBpp, bool hasAlphaChannel, bool hasSeparateAlpha) const {
@@ -41,11 +169,24 @@ namespace {
                 }
             }
 
+            uint32_t palette[4];
+            for (int i = 0; i < 4; i++) {
+                palette[i] = c[i].pack8888();
+            }
+
+            if (dstBpp == sizeof(uint32_t) && (x + BlockWidth) <= dstW && (y + BlockHeight) <= dstH) {
+                // Interior blocks are written a row at a time without any bounds checks
+                for (int j = 0; j < BlockHeight; j++) {
+                    writePaletteRow(dst + j * dstPitch, palette, (idx >> (j * 8)) & 0xFF);
+                }
+                return;
+            }
+
             for (int j = 0; j < BlockHeight && (y + j) < dstH; j++) {
                 size_t dstOffset = j * dstPitch;
                 size_t idxOffset = j * BlockHeight;
                 for (size_t i = 0; i < BlockWidth && (x + i) < dstW; i++, idxOffset++, dstOffset += dstBpp) {
-                    *reinterpret_cast<unsigned int *>(dst + dstOffset) = c[getIdx(idxOffset)].pack8888();
+                    *reinterpret_cast<unsigned int *>(dst + dstOffset) = palette[getIdx(idxOffset)];
                 }
             }
         }
@@ -119,7 +260,7 @@ namespace {
     static_assert(sizeof(BC_color) == 8, "BC_color must be 8 bytes");
 
     struct BC_channel {
-        void decode(uint8_t *dst, size_t x, size_t y, size_t dstW, size_t dstH, size_t dstPitch, size_t dstBpp, size_t channel, bool isSigned) const {
+        void decode(uint8_t (&texels)[BlockTexels], bool isSigned) const {
             int c[8] = {0};
 
             if (isSigned) {
@@ -142,19 +283,26 @@ namespace {
                 c[7] = isSigned ? 127 : 255;
             }
 
+            uint8_t palette[8];
+            for (int i = 0; i < 8; ++i) {
+                palette[i] = static_cast<uint8_t>(c[i]);
+            }
+
+            expandChannelIndices(palette, data >> 16, texels);
+        }
+
+        void decode(uint8_t *dst, size_t x, size_t y, size_t dstW, size_t dstH, size_t dstPitch, size_t dstBpp, size_t channel, bool isSigned) const {
+            uint8_t texels[BlockTexels];
+            decode(texels, isSigned);
+
             for (size_t j = 0; j < BlockHeight && (y + j) < dstH; j++) {
                 for (size_t i = 0; i < BlockWidth && (x + i) < dstW; i++) {
-                    dst[channel + (i * dstBpp) + (j * dstPitch)] = static_cast<uint8_t>(c[getIdx((j * BlockHeight) + i)]);
+                    dst[channel + (i * dstBpp) + (j * dstPitch)] = texels[j * BlockWidth + i];
                 }
             }
         }
 
       private:
-        uint8_t getIdx(int i) const {
-            int offset = i * 3 + 16;
-            return static_cast<uint8_t>((data & (0x7ull << offset)) >> offset);
-        }
-
         uint64_t data;
     };
     static_assert(sizeof(BC_channel) == 8, "BC_channel must be 8 bytes");
@@ -483,55 +631,114 @@ namespace {
             }
         };
 
-        struct IndexInfo {
-            uint64_t value;
-            int numBits;
+        // The interpolation weights for 3 and 4-bit indices
+        static constexpr uint16_t Weights[5][16] = {
+            {}, {}, {},
+            {0, 9, 18, 27, 37, 46, 55, 64},
+            {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64},
         };
 
-// Interpolates between two endpoints, then does a final unquantization step
-        Color interpolate(RGBf e0, RGBf e1, const IndexInfo &index, bool isSigned) {
-            static constexpr uint32_t weights3[] = {0, 9, 18, 27, 37, 46, 55, 64};
-            static constexpr uint32_t weights4[] = {0, 4, 9, 13, 17, 21, 26, 30,
-                                                    34, 38, 43, 47, 51, 55, 60, 64};
-            static constexpr uint32_t const *weightsN[] = {
-                nullptr, nullptr, nullptr, weights3, weights4
+        // Interpolates planar unquantized endpoints for all 16 texels of a block, then does a final unquantization step
+        // The final step limits values to the legal range of half-precision floats by scaling by 31/32 or 31/64 depending on if the value is signed or unsigned
+        // The result is interleaved into 16 RGBA16F texels in row-major order with an alpha of 1.0
+        inline void interpolatePlanar(const uint16_t (&e0)[RGBfChannels][BlockTexels], const uint16_t (&e1)[RGBfChannels][BlockTexels], const uint16_t (&weights)[BlockTexels], bool isSigned, uint16_t (&out)[BlockTexels * 4]) {
+#if defined(__aarch64__)
+            for (int half = 0; half < 2; half++) {
+                uint16x8_t w = vld1q_u16(weights + half * 8);
+                uint16x8_t wInv = vsubq_u16(vdupq_n_u16(64), w);
+                uint16x8x4_t result;
+                for (int c = 0; c < RGBfChannels; c++) {
+                    uint16x8_t a = vld1q_u16(e0[c] + half * 8), b = vld1q_u16(e1[c] + half * 8);
+                    if (isSigned) {
+                        int16x8_t as = vreinterpretq_s16_u16(a), bs = vreinterpretq_s16_u16(b);
+                        int16x8_t ws = vreinterpretq_s16_u16(w), wInvs = vreinterpretq_s16_u16(wInv);
+                        auto finish = [](int32x4_t sum) {
+                            // Negative values are scaled by their magnitude with the sign bit set afterwards, -0.0 is normalized to 0.0
+                            int32x4_t value = vrshrq_n_s32(sum, 6);
+                            uint32x4_t negative = vcltq_s32(value, vdupq_n_s32(0));
+                            uint32x4_t scaled = vshrq_n_u32(vmulq_n_u32(vreinterpretq_u32_s32(vabsq_s32(value)), 31), 5);
+                            uint32x4_t signedValue = vorrq_u32(scaled, vandq_u32(negative, vdupq_n_u32(0x8000)));
+                            return vmovn_u32(vbicq_u32(signedValue, vceqq_u32(signedValue, vdupq_n_u32(0x8000))));
+                        };
+                        int32x4_t low = vmlal_s16(vmull_s16(vget_low_s16(as), vget_low_s16(wInvs)), vget_low_s16(bs), vget_low_s16(ws));
+                        int32x4_t high = vmlal_high_s16(vmull_high_s16(as, wInvs), bs, ws);
+                        result.val[c] = vcombine_u16(finish(low), finish(high));
+                    } else {
+                        auto finish = [](uint32x4_t sum) {
+                            return vmovn_u32(vshrq_n_u32(vmulq_n_u32(vrshrq_n_u32(sum, 6), 31), 6));
+                        };
+                        uint32x4_t low = vmlal_u16(vmull_u16(vget_low_u16(a), vget_low_u16(wInv)), vget_low_u16(b), vget_low_u16(w));
+                        uint32x4_t high = vmlal_high_u16(vmull_high_u16(a, wInv), b, w);
+                        result.val[c] = vcombine_u16(finish(low), finish(high));
+                    }
+                }
+                result.val[3] = vdupq_n_u16(halfFloat1);
+                vst4q_u16(out + half * 32, result);
+            }
+#elif defined(__x86_64__)
+            __m128i sixtyFour = _mm_set1_epi16(64), round = _mm_set1_epi32(32), signMask = _mm_set1_epi32(0x8000);
+            // SSE2 has no 32-bit multiply or non-saturating narrowing, so products are assembled from 16-bit halves and values are sign-extended from 16 bits before packing
+            auto narrow = [](__m128i low, __m128i high) {
+                return _mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(low, 16), 16), _mm_srai_epi32(_mm_slli_epi32(high, 16), 16));
             };
-            auto weights = weightsN[index.numBits];
-            ASSERT_MSG(weights != nullptr, "Unexpected number of index bits: %d", (int) index.numBits);
-            Color color;
-            uint32_t e0Weight = 64 - weights[index.value];
-            uint32_t e1Weight = weights[index.value];
-
-            for (int i = 0; i < RGBfChannels; i++) {
-                int32_t e0Channel = e0.channel[i];
-                int32_t e1Channel = e1.channel[i];
-
-                if (isSigned) {
-                    e0Channel = extendSign(e0Channel, 16);
-                    e1Channel = extendSign(e1Channel, 16);
+            auto times31 = [](__m128i value) {
+                return _mm_sub_epi32(_mm_slli_epi32(value, 5), value);
+            };
+            for (int half = 0; half < 2; half++) {
+                __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i *>(weights + half * 8));
+                __m128i wInv = _mm_sub_epi16(sixtyFour, w);
+                __m128i channels[4];
+                for (int c = 0; c < RGBfChannels; c++) {
+                    __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(e0[c] + half * 8)), b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(e1[c] + half * 8));
+                    __m128i aLow = _mm_mullo_epi16(a, wInv), bLow = _mm_mullo_epi16(b, w);
+                    __m128i aHigh = isSigned ? _mm_mulhi_epi16(a, wInv) : _mm_mulhi_epu16(a, wInv);
+                    __m128i bHigh = isSigned ? _mm_mulhi_epi16(b, w) : _mm_mulhi_epu16(b, w);
+                    __m128i sums[2] = {
+                        _mm_add_epi32(_mm_add_epi32(_mm_unpacklo_epi16(aLow, aHigh), _mm_unpacklo_epi16(bLow, bHigh)), round),
+                        _mm_add_epi32(_mm_add_epi32(_mm_unpackhi_epi16(aLow, aHigh), _mm_unpackhi_epi16(bLow, bHigh)), round),
+                    };
+                    for (auto &sum : sums) {
+                        if (isSigned) {
+                            __m128i value = _mm_srai_epi32(sum, 6);
+                            __m128i negative = _mm_srai_epi32(value, 31);
+                            __m128i magnitude = _mm_sub_epi32(_mm_xor_si128(value, negative), negative);
+                            __m128i signedValue = _mm_or_si128(_mm_srli_epi32(times31(magnitude), 5), _mm_and_si128(negative, signMask));
+                            sum = _mm_andnot_si128(_mm_cmpeq_epi32(signedValue, signMask), signedValue);
+                        } else {
+                            sum = _mm_srli_epi32(times31(_mm_srli_epi32(sum, 6)), 6);
+                        }
+                    }
+                    channels[c] = narrow(sums[0], sums[1]);
                 }
-
-                int32_t e0Value = e0Channel * e0Weight;
-                int32_t e1Value = e1Channel * e1Weight;
-
-                uint32_t tmp = ((e0Value + e1Value + 32) >> 6);
-
-                // Need to unquantize value to limit it to the legal range of half-precision
-                // floats. We do this by scaling by 31/32 or 31/64 depending on if the value
-                // is signed or unsigned.
-                if (isSigned) {
-                    tmp = ((tmp & 0x80000000) != 0) ? (((~tmp + 1) * 31) >> 5) | 0x8000 : (tmp * 31) >> 5;
-                    // Don't return -0.0f, just normalize it to 0.0f.
-                    if (tmp == 0x8000)
-                        tmp = 0;
-                } else {
-                    tmp = (tmp * 31) >> 6;
+                channels[3] = _mm_set1_epi16(static_cast<short>(halfFloat1));
+                __m128i rgLow = _mm_unpacklo_epi16(channels[0], channels[1]), rgHigh = _mm_unpackhi_epi16(channels[0], channels[1]);
+                __m128i baLow = _mm_unpacklo_epi16(channels[2], channels[3]), baHigh = _mm_unpackhi_epi16(channels[2], channels[3]);
+                auto *output = reinterpret_cast<__m128i *>(out + half * 32);
+                _mm_storeu_si128(output + 0, _mm_unpacklo_epi32(rgLow, baLow));
+                _mm_storeu_si128(output + 1, _mm_unpackhi_epi32(rgLow, baLow));
+                _mm_storeu_si128(output + 2, _mm_unpacklo_epi32(rgHigh, baHigh));
+                _mm_storeu_si128(output + 3, _mm_unpackhi_epi32(rgHigh, baHigh));
+            }
+#else
+            for (int t = 0; t < BlockTexels; t++) {
+                int32_t e0Weight = 64 - weights[t], e1Weight = weights[t];
+                for (int c = 0; c < RGBfChannels; c++) {
+                    int32_t e0Channel = isSigned ? extendSign(e0[c][t], 16) : e0[c][t];
+                    int32_t e1Channel = isSigned ? extendSign(e1[c][t], 16) : e1[c][t];
+                    uint32_t tmp = ((e0Channel * e0Weight + e1Channel * e1Weight + 32) >> 6);
+                    if (isSigned) {
+                        tmp = ((tmp & 0x80000000) != 0) ? (((~tmp + 1) * 31) >> 5) | 0x8000 : (tmp * 31) >> 5;
+                        // Don't return -0.0f, just normalize it to 0.0f.
+                        if (tmp == 0x8000)
+                            tmp = 0;
+                    } else {
+                        tmp = (tmp * 31) >> 6;
+                    }
+                    out[t * 4 + c] = (uint16_t) tmp;
                 }
-
-                color.channel[i] = (uint16_t) tmp;
+                out[t * 4 + 3] = halfFloat1;
             }
-
-            return color;
+#endif
         }
 
         enum DataType {
@@ -892,40 +1099,36 @@ namespace {
                     e[ep].unquantize();
                 }
 
-                // Get the indices, calculate final colors, and output
-                for (int y = 0; y < 4; y++) {
-                    for (int x = 0; x < 4; x++) {
-                        int pixelNum = x + y * 4;
-                        IndexInfo idx;
-                        bool isAnchor = false;
-                        int firstEndpoint = 0;
-                        // Bc6H can have either 1 or 2 petitions depending on the mode.
-                        // The number of petitions affects the number of indices with implicit
-                        // leading 0 bits and the number of bits per index.
-                        if (modeDesc.partitionCount == 1) {
-                            idx.numBits = 4;
-                            // There's an implicit leading 0 bit for the first idx
-                            isAnchor = (pixelNum == 0);
-                        } else {
-                            idx.numBits = 3;
-                            // There are 2 indices with implicit leading 0-bits.
-                            isAnchor = ((pixelNum == 0) || (pixelNum == AnchorTable2[partition]));
-                            firstEndpoint = PartitionTable2[partition][pixelNum] * 2;
-                        }
-
-                        idx.value = data.consumeBits(idx.numBits - isAnchor - 1, 0);
-
-                        // Don't exit the loop early, we need to consume these index bits regardless if
-                        // we actually output them or not.
-                        if ((y + dstY >= dstHeight) || (x + dstX >= dstWidth)) {
-                            continue;
-                        }
+                // Get the indices and gather the endpoints and weights of every texel into planar arrays for interpolation
+                uint16_t e0[RGBfChannels][BlockTexels], e1[RGBfChannels][BlockTexels], weights[BlockTexels];
+                for (int pixelNum = 0; pixelNum < BlockTexels; pixelNum++) {
+                    int numBits;
+                    bool isAnchor = false;
+                    int firstEndpoint = 0;
+                    // Bc6H can have either 1 or 2 petitions depending on the mode.
+                    // The number of petitions affects the number of indices with implicit
+                    // leading 0 bits and the number of bits per index.
+                    if (modeDesc.partitionCount == 1) {
+                        numBits = 4;
+                        // There's an implicit leading 0 bit for the first idx
+                        isAnchor = (pixelNum == 0);
+                    } else {
+                        numBits = 3;
+                        // There are 2 indices with implicit leading 0-bits.
+                        isAnchor = ((pixelNum == 0) || (pixelNum == AnchorTable2[partition]));
+                        firstEndpoint = PartitionTable2[partition][pixelNum] * 2;
+                    }
 
-                        Color color = interpolate(e[firstEndpoint], e[firstEndpoint + 1], idx, isSigned);
-                        auto out = reinterpret_cast<Color *>(dst + dstBpp * x + dstPitch * y);
-                        *out = color;
+                    weights[pixelNum] = Weights[numBits][data.consumeBits(numBits - isAnchor - 1, 0)];
+                    for (int c = 0; c < RGBfChannels; c++) {
+                        e0[c][pixelNum] = e[firstEndpoint].channel[c];
+                        e1[c][pixelNum] = e[firstEndpoint + 1].channel[c];
                     }
                 }
+
+                uint16_t texels[BlockTexels * 4];
+                interpolatePlanar(e0, e1, weights, isSigned, texels);
+                writeBlock(reinterpret_cast<const uint8_t *>(texels), sizeof(Color), dst, dstX, dstY, dstWidth, dstHeight, dstPitch);
             }
         };
 
@@ -1278,24 +1481,14 @@ namespace {
                 return Modes[8];  // Invalid mode
             }
 
-            struct IndexInfo {
-                uint64_t value;
-                int numBits;
+            // The interpolation weights for 2, 3 and 4-bit indices
+            static constexpr uint8_t Weights[5][16] = {
+                {}, {},
+                {0, 21, 43, 64},
+                {0, 9, 18, 27, 37, 46, 55, 64},
+                {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64},
             };
 
-            uint8_t interpolate(uint8_t e0, uint8_t e1, const IndexInfo &index) const {
-                static constexpr uint16_t weights2[] = {0, 21, 43, 64};
-                static constexpr uint16_t weights3[] = {0, 9, 18, 27, 37, 46, 55, 64};
-                static constexpr uint16_t weights4[] = {0, 4, 9, 13, 17, 21, 26, 30,
-                                                        34, 38, 43, 47, 51, 55, 60, 64};
-                static constexpr uint16_t const *weightsN[] = {
-                    nullptr, nullptr, weights2, weights3, weights4
-                };
-                auto weights = weightsN[index.numBits];
-                ASSERT_MSG(weights != nullptr, "Unexpected number of index bits: %d", (int) index.numBits);
-                return (uint8_t) (((64 - weights[index.value]) * uint16_t(e0) + weights[index.value] * uint16_t(e1) + 32) >> 6);
-            }
-
             void decode(uint8_t *dst, size_t dstX, size_t dstY, size_t dstWidth, size_t dstHeight, size_t dstPitch) const {
                 auto const &mode = this->mode();
 
@@ -1368,54 +1561,63 @@ namespace {
                     }
                 }
 
+                // All per-block fields are read once rather than per-texel and the indices are extracted up front, this allows all texels to be interpolated together
+                auto partitionIdx = Get(mode.Partition());
+                ASSERT(partitionIdx < MaxPartitions);
+                auto rotation = Get(mode.Rotation());
+                auto indexSelection = Get(mode.IndexSelection());
+                ASSERT(indexSelection <= 1);
+
+                // ARB_texture_compression_bptc states:
+                // "The index value for interpolating color comes from the secondary
+                // index for the texel if the format has an index selection bit and its
+                // value is one and from the primary index otherwise."
+                // "The alpha index comes from the secondary index if the block has a
+                // secondary index and the block either doesn't have an index selection
+                // bit or that bit is zero and the primary index otherwise."
+                bool colorSecondary = indexSelection == 1;
+                bool alphaSecondary = (mode.IB2 != 0) && (indexSelection == 0);
+                int colorIndexBits = colorSecondary ? mode.IB2 : mode.IB;
+                int alphaIndexBits = alphaSecondary ? mode.IB2 : mode.IB;
+
+                uint8_t e0[4][BlockTexels], e1[4][BlockTexels], weights[4][BlockTexels];
                 int colorIndexBitOffset = 0;
                 int alphaIndexBitOffset = 0;
-                for (int y = 0; y < 4; y++) {
-                    for (int x = 0; x < 4; x++) {
-                        auto texelIdx = y * 4 + x;
-                        auto partitionIdx = Get(mode.Partition());
-                        ASSERT(partitionIdx < MaxPartitions);
-                        auto subsetIdx = subsetIndex(mode, partitionIdx, texelIdx);
-                        ASSERT(subsetIdx < MaxSubsets);
-                        auto const &subset = subsets[subsetIdx];
-
-                        auto anchorIdx = anchorIndex(mode, partitionIdx, subsetIdx);
-                        auto isAnchor = anchorIdx == texelIdx;
-                        auto colorIdx = colorIndex(mode, isAnchor, colorIndexBitOffset);
-                        auto alphaIdx = alphaIndex(mode, isAnchor, alphaIndexBitOffset);
-
-                        if (y + dstY >= dstHeight || x + dstX >= dstWidth) {
-                            // Don't be tempted to skip early at the loops:
-                            // The calls to colorIndex() and alphaIndex() adjust bit
-                            // offsets that need to be carefully tracked.
-                            continue;
-                        }
-
-                        Color output;
-                        // Note: We flip r and b channels past this point as the texture storage is BGR while the output is RGB
-                        output.rgb.r = interpolate(subset[0].rgb.b, subset[1].rgb.b, colorIdx);
-                        output.rgb.g = interpolate(subset[0].rgb.g, subset[1].rgb.g, colorIdx);
-                        output.rgb.b = interpolate(subset[0].rgb.r, subset[1].rgb.r, colorIdx);
-                        output.a = interpolate(subset[0].a, subset[1].a, alphaIdx);
-
-                        switch (Get(mode.Rotation())) {
-                            default:
-                                break;
-                            case 1:
-                                std::swap(output.a, output.rgb.b);
-                                break;
-                            case 2:
-                                std::swap(output.a, output.rgb.g);
-                                break;
-                            case 3:
-                                std::swap(output.a, output.rgb.r);
-                                break;
-                        }
+                for (int texelIdx = 0; texelIdx < BlockTexels; texelIdx++) {
+                    auto subsetIdx = subsetIndex(mode, partitionIdx, texelIdx);
+                    ASSERT(subsetIdx < MaxSubsets);
+                    auto const &subset = subsets[subsetIdx];
+                    bool isAnchor = anchorIndex(mode, partitionIdx, subsetIdx) == texelIdx;
+
+                    auto colorIdx = readIndex(mode, colorSecondary, colorIndexBits - (isAnchor ? 1 : 0), colorIndexBitOffset);
+                    auto alphaIdx = readIndex(mode, alphaSecondary, alphaIndexBits - (isAnchor ? 1 : 0), alphaIndexBitOffset);
+
+                    // Note: The planar channels are in output (RGBA) order rather than in the BGR order of the endpoint storage
+                    e0[0][texelIdx] = subset[0].rgb.r;
+                    e0[1][texelIdx] = subset[0].rgb.g;
+                    e0[2][texelIdx] = subset[0].rgb.b;
+                    e0[3][texelIdx] = subset[0].a;
+                    e1[0][texelIdx] = subset[1].rgb.r;
+                    e1[1][texelIdx] = subset[1].rgb.g;
+                    e1[2][texelIdx] = subset[1].rgb.b;
+                    e1[3][texelIdx] = subset[1].a;
+
+                    uint8_t colorWeight = Weights[colorIndexBits][colorIdx];
+                    weights[0][texelIdx] = weights[1][texelIdx] = weights[2][texelIdx] = colorWeight;
+                    weights[3][texelIdx] = Weights[alphaIndexBits][alphaIdx];
+                }
 
-                        auto out = reinterpret_cast<Color *>(dst + sizeof(Color) * x + dstPitch * y);
-                        *out = output;
-                    }
+                // Rotation swaps alpha with one of the color channels after interpolation, this is equivalent to swapping their inputs
+                if (rotation != 0) {
+                    int channel = static_cast<int>(rotation) - 1;
+                    std::swap(e0[3], e0[channel]);
+                    std::swap(e1[3], e1[channel]);
+                    std::swap(weights[3], weights[channel]);
                 }
+
+                uint8_t texels[BlockTexels * 4];
+                interpolatePlanar(e0, e1, weights, texels);
+                writeBlock(texels, sizeof(Color), dst, dstX, dstY, dstWidth, dstHeight, dstPitch);
             }
 
             int subsetIndex(const Mode &mode, int partitionIdx, int texelIndex) const {
@@ -1446,40 +1648,12 @@ namespace {
                 }
             }
 
-            IndexInfo colorIndex(const Mode &mode, bool isAnchor,
-                                 int &indexBitOffset) const {
-                // ARB_texture_compression_bptc states:
-                // "The index value for interpolating color comes from the secondary
-                // index for the texel if the format has an index selection bit and its
-                // value is one and from the primary index otherwise.""
-                auto idx = Get(mode.IndexSelection());
-                ASSERT(idx <= 1);
-                bool secondary = idx == 1;
-                auto numBits = secondary ? mode.IB2 : mode.IB;
-                auto numReadBits = numBits - (isAnchor ? 1 : 0);
-                auto index =
-                    Get(secondary ? mode.SecondaryIndex(indexBitOffset, numReadBits)
-                                  : mode.PrimaryIndex(indexBitOffset, numReadBits));
-                indexBitOffset += numReadBits;
-                return {index, numBits};
-            }
-
-            IndexInfo alphaIndex(const Mode &mode, bool isAnchor,
-                                 int &indexBitOffset) const {
-                // ARB_texture_compression_bptc states:
-                // "The alpha index comes from the secondary index if the block has a
-                // secondary index and the block either doesn't have an index selection
-                // bit or that bit is zero and the primary index otherwise."
-                auto idx = Get(mode.IndexSelection());
-                ASSERT(idx <= 1);
-                bool secondary = (mode.IB2 != 0) && (idx == 0);
-                auto numBits = secondary ? mode.IB2 : mode.IB;
-                auto numReadBits = numBits - (isAnchor ? 1 : 0);
+            uint64_t readIndex(const Mode &mode, bool secondary, int numReadBits, int &indexBitOffset) const {
                 auto index =
                     Get(secondary ? mode.SecondaryIndex(indexBitOffset, numReadBits)
                                   : mode.PrimaryIndex(indexBitOffset, numReadBits));
                 indexBitOffset += numReadBits;
-                return {index, numBits};
+                return index;
             }
 
             // Assumes little-endian
@@ -1538,8 +1712,11 @@ namespace bcn {
         size_t pitch{R8Bpp * width};
         for (size_t y{}; y < height; y += BlockHeight, dst += BlockHeight * pitch) {
             uint8_t *dstRow{dst};
-            for (size_t x{}; x < width; x += BlockWidth, ++red, dstRow += BlockWidth * R8Bpp)
-                [[clang::always_inline]] red->decode(dstRow, x, y, width, height, pitch, R8Bpp, 0, isSigned);
+            for (size_t x{}; x < width; x += BlockWidth, ++red, dstRow += BlockWidth * R8Bpp) {
+                uint8_t texels[BlockTexels];
+                [[clang::always_inline]] red->decode(texels, isSigned);
+                writeBlock(texels, R8Bpp, dstRow, x, y, width, height, pitch);
+            }
         }
     }
 
@@ -1550,8 +1727,11 @@ namespace bcn {
         for (size_t y{}; y < height; y += BlockHeight, dst += BlockHeight * pitch) {
             uint8_t *dstRow{dst};
             for (size_t x{}; x < width; x += BlockWidth, red += 2, green += 2, dstRow += BlockWidth * R8g8Bpp) {
-                [[clang::always_inline]] red->decode(dstRow, x, y, width, height, pitch, R8g8Bpp, 0, isSigned);
-                [[clang::always_inline]] green->decode(dstRow, x, y, width, height, pitch, R8g8Bpp, 1, isSigned);
+                uint8_t redTexels[BlockTexels], greenTexels[BlockTexels], texels[BlockTexels * R8g8Bpp];
+                [[clang::always_inline]] red->decode(redTexels, isSigned);
+                [[clang::always_inline]] green->decode(greenTexels, isSigned);
+                interleaveChannels(redTexels, greenTexels, texels);
+                writeBlock(texels, R8g8Bpp, dstRow, x, y, width, height, pitch);
             }
         }
     }
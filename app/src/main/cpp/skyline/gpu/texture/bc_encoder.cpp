@@ -0,0 +1,357 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2024 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include "bc_encoder.h"
+
+namespace bcn {
+    namespace {
+        constexpr size_t BlockWidth{4};
+        constexpr size_t BlockHeight{4};
+        constexpr size_t BlockTexels{BlockWidth * BlockHeight};
+        constexpr size_t Channels{4}; //!< The amount of channels in an R8G8B8A8 texel
+
+        using Block = std::array<std::array<float, Channels>, BlockTexels>;
+        using Endpoint = std::array<float, Channels>;
+
+        constexpr std::array<uint32_t, 16> Bc7Weights4{0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64}; //!< The interpolation weights of 4-bit BC7 indices
+
+        /**
+         * @brief A mapping from a weight in [0, 64] to the 4-bit BC7 index with the nearest weight
+         */
+        constexpr auto Bc7NearestIndex4{[] {
+            std::array<uint8_t, 65> indices{};
+            for (uint32_t weight{}; weight < indices.size(); weight++) {
+                uint32_t bestDistance{std::numeric_limits<uint32_t>::max()};
+                for (uint8_t index{}; index < Bc7Weights4.size(); index++) {
+                    uint32_t distance{weight > Bc7Weights4[index] ? weight - Bc7Weights4[index] : Bc7Weights4[index] - weight};
+                    if (distance < bestDistance) {
+                        bestDistance = distance;
+                        indices[weight] = index;
+                    }
+                }
+            }
+            return indices;
+        }()};
+
+        /**
+         * @brief Writes fields of a 128-bit block from the LSB upwards
+         */
+        class BitWriter {
+          private:
+            uint64_t data[2]{};
+            size_t position{};
+
+          public:
+            void Write(uint64_t value, size_t bits) {
+                if (position < 64) {
+                    data[0] |= value << position;
+                    if (position + bits > 64)
+                        data[1] |= value >> (64 - position);
+                } else {
+                    data[1] |= value << (position - 64);
+                }
+                position += bits;
+            }
+
+            void Store(uint8_t *dst) const {
+                std::memcpy(dst, data, sizeof(data));
+            }
+        };
+
+        /**
+         * @brief Gathers a block of texels from an R8G8B8A8 image, texels outside the image replicate the closest edge texel
+         */
+        void LoadBlock(const uint8_t *src, size_t width, size_t height, size_t x, size_t y, Block &block) {
+            for (size_t row{}; row < BlockHeight; row++) {
+                const uint8_t *line{src + (std::min(y + row, height - 1) * width * Channels)};
+                for (size_t column{}; column < BlockWidth; column++) {
+                    const uint8_t *texel{line + (std::min(x + column, width - 1) * Channels)};
+                    for (size_t channel{}; channel < Channels; channel++)
+                        block[(row * BlockWidth) + column][channel] = texel[channel];
+                }
+            }
+        }
+
+        /**
+         * @brief A candidate mode 6 encoding of a block
+         */
+        struct Bc7Mode6 {
+            std::array<std::array<uint8_t, Channels>, 2> endpoints; //!< The 7-bit endpoints
+            std::array<uint8_t, 2> pBits;
+            std::array<uint8_t, BlockTexels> indices;
+            float error;
+        };
+
+        /**
+         * @brief Quantizes an endpoint to 7 bits per channel with a shared P-bit, the P-bit which results in the lowest error is selected
+         * @param opaque If the P-bit should be forced to 1, this is used for fully opaque blocks so that an alpha of 255 is exactly representable
+         */
+        void QuantizeEndpoint(const Endpoint &endpoint, bool opaque, std::array<uint8_t, Channels> &quantized, uint8_t &pBit) {
+            float bestError{std::numeric_limits<float>::max()};
+            for (uint8_t p{opaque ? uint8_t{1} : uint8_t{0}}; p < 2; p++) {
+                std::array<uint8_t, Channels> candidate;
+                float error{};
+                for (size_t channel{}; channel < Channels; channel++) {
+                    int value{std::clamp(static_cast<int>(std::lround((endpoint[channel] - p) / 2.0f)), 0, 127)};
+                    candidate[channel] = static_cast<uint8_t>(value);
+                    float difference{static_cast<float>((value << 1) | p) - endpoint[channel]};
+                    error += difference * difference;
+                }
+
+                if (error < bestError) {
+                    bestError = error;
+                    quantized = candidate;
+                    pBit = p;
+                }
+            }
+        }
+
+        /**
+         * @brief Quantizes the supplied endpoints and selects the index of every texel by projecting it onto the quantized endpoint line
+         */
+        Bc7Mode6 EncodeMode6(const Block &block, const Endpoint &low, const Endpoint &high, bool opaque) {
+            Bc7Mode6 mode{};
+            QuantizeEndpoint(low, opaque, mode.endpoints[0], mode.pBits[0]);
+            QuantizeEndpoint(high, opaque, mode.endpoints[1], mode.pBits[1]);
+
+            std::array<std::array<int, Channels>, 2> decoded;
+            for (size_t endpoint{}; endpoint < 2; endpoint++)
+                for (size_t channel{}; channel < Channels; channel++)
+                    decoded[endpoint][channel] = (mode.endpoints[endpoint][channel] << 1) | mode.pBits[endpoint];
+
+            std::array<float, Channels> direction;
+            float lengthSquared{};
+            for (size_t channel{}; channel < Channels; channel++) {
+                direction[channel] = static_cast<float>(decoded[1][channel] - decoded[0][channel]);
+                lengthSquared += direction[channel] * direction[channel];
+            }
+            float scale{lengthSquared > 0.0f ? 64.0f / lengthSquared : 0.0f};
+
+            for (size_t texel{}; texel < BlockTexels; texel++) {
+                float projection{};
+                for (size_t channel{}; channel < Channels; channel++)
+                    projection += (block[texel][channel] - static_cast<float>(decoded[0][channel])) * direction[channel];
+                auto weight{std::clamp(static_cast<int>(std::lround(projection * scale)), 0, 64)};
+                mode.indices[texel] = Bc7NearestIndex4[static_cast<size_t>(weight)];
+
+                uint32_t indexWeight{Bc7Weights4[mode.indices[texel]]};
+                for (size_t channel{}; channel < Channels; channel++) {
+                    auto value{static_cast<float>((((64 - indexWeight) * static_cast<uint32_t>(decoded[0][channel])) + (indexWeight * static_cast<uint32_t>(decoded[1][channel])) + 32) >> 6)};
+                    float difference{value - block[texel][channel]};
+                    mode.error += difference * difference;
+                }
+            }
+
+            return mode;
+        }
+
+        /**
+         * @brief Solves for the endpoints which minimize the squared error of the block given the interpolation weights of a previous encoding
+         * @return If the system had a unique solution
+         */
+        bool RefineEndpoints(const Block &block, const Bc7Mode6 &mode, Endpoint &low, Endpoint &high) {
+            float lowLow{}, lowHigh{}, highHigh{};
+            Endpoint lowSum{}, highSum{};
+            for (size_t texel{}; texel < BlockTexels; texel++) {
+                float weight{static_cast<float>(Bc7Weights4[mode.indices[texel]]) / 64.0f};
+                float inverse{1.0f - weight};
+                lowLow += inverse * inverse;
+                lowHigh += inverse * weight;
+                highHigh += weight * weight;
+                for (size_t channel{}; channel < Channels; channel++) {
+                    lowSum[channel] += inverse * block[texel][channel];
+                    highSum[channel] += weight * block[texel][channel];
+                }
+            }
+
+            float determinant{(lowLow * highHigh) - (lowHigh * lowHigh)};
+            if (std::abs(determinant) < 1e-6f)
+                return false;
+
+            for (size_t channel{}; channel < Channels; channel++) {
+                low[channel] = std::clamp(((highHigh * lowSum[channel]) - (lowHigh * highSum[channel])) / determinant, 0.0f, 255.0f);
+                high[channel] = std::clamp(((lowLow * highSum[channel]) - (lowHigh * lowSum[channel])) / determinant, 0.0f, 255.0f);
+            }
+            return true;
+        }
+
+        void EncodeBc7Block(const Block &block, uint8_t *dst) {
+            Endpoint mean{};
+            bool opaque{true};
+            for (const auto &texel : block) {
+                for (size_t channel{}; channel < Channels; channel++)
+                    mean[channel] += texel[channel];
+                opaque &= texel[3] == 255.0f;
+            }
+            for (auto &channel : mean)
+                channel /= BlockTexels;
+
+            // The principal axis of the block is determined by power iteration on the covariance matrix, seeded with the axis of the bounding box
+            std::array<std::array<float, Channels>, Channels> covariance{};
+            Endpoint minimum{block[0]}, maximum{block[0]};
+            for (const auto &texel : block) {
+                for (size_t i{}; i < Channels; i++) {
+                    minimum[i] = std::min(minimum[i], texel[i]);
+                    maximum[i] = std::max(maximum[i], texel[i]);
+                    for (size_t j{}; j < Channels; j++)
+                        covariance[i][j] += (texel[i] - mean[i]) * (texel[j] - mean[j]);
+                }
+            }
+
+            Endpoint axis;
+            for (size_t channel{}; channel < Channels; channel++)
+                axis[channel] = maximum[channel] - minimum[channel];
+
+            for (size_t iteration{}; iteration < 4; iteration++) {
+                Endpoint next{};
+                float largest{};
+                for (size_t i{}; i < Channels; i++) {
+                    for (size_t j{}; j < Channels; j++)
+                        next[i] += covariance[i][j] * axis[j];
+                    largest = std::max(largest, std::abs(next[i]));
+                }
+                if (largest == 0.0f)
+                    break; // The covariance is zero along the axis, the current axis is retained
+                for (size_t channel{}; channel < Channels; channel++)
+                    axis[channel] = next[channel] / largest;
+            }
+
+            float axisLengthSquared{};
+            for (auto channel : axis)
+                axisLengthSquared += channel * channel;
+
+            Endpoint low{mean}, high{mean};
+            if (axisLengthSquared > 0.0f) {
+                float minimumProjection{std::numeric_limits<float>::max()}, maximumProjection{std::numeric_limits<float>::lowest()};
+                for (const auto &texel : block) {
+                    float projection{};
+                    for (size_t channel{}; channel < Channels; channel++)
+                        projection += (texel[channel] - mean[channel]) * axis[channel];
+                    minimumProjection = std::min(minimumProjection, projection);
+                    maximumProjection = std::max(maximumProjection, projection);
+                }
+
+                for (size_t channel{}; channel < Channels; channel++) {
+                    low[channel] = std::clamp(mean[channel] + (axis[channel] * minimumProjection / axisLengthSquared), 0.0f, 255.0f);
+                    high[channel] = std::clamp(mean[channel] + (axis[channel] * maximumProjection / axisLengthSquared), 0.0f, 255.0f);
+                }
+            }
+
+            auto mode{EncodeMode6(block, low, high, opaque)};
+            if (mode.error > 0.0f && RefineEndpoints(block, mode, low, high)) {
+                auto refined{EncodeMode6(block, low, high, opaque)};
+                if (refined.error < mode.error)
+                    mode = refined;
+            }
+
+            // The MSB of the index of the first texel is implicitly zero, the endpoints are swapped to satisfy this
+            if (mode.indices[0] & 0x8) {
+                std::swap(mode.endpoints[0], mode.endpoints[1]);
+                std::swap(mode.pBits[0], mode.pBits[1]);
+                for (auto &index : mode.indices)
+                    index = static_cast<uint8_t>(15 - index);
+            }
+
+            BitWriter writer;
+            writer.Write(1 << 6, 7); // Mode 6
+            for (size_t channel{}; channel < Channels; channel++) {
+                writer.Write(mode.endpoints[0][channel], 7);
+                writer.Write(mode.endpoints[1][channel], 7);
+            }
+            writer.Write(mode.pBits[0], 1);
+            writer.Write(mode.pBits[1], 1);
+            writer.Write(mode.indices[0], 3);
+            for (size_t texel{1}; texel < BlockTexels; texel++)
+                writer.Write(mode.indices[texel], 4);
+            writer.Store(dst);
+        }
+
+        /**
+         * @brief Returns the palette of a BC3 alpha block, this matches the interpolation used by the BC3 decoder
+         */
+        std::array<uint8_t, 8> Bc3AlphaPalette(uint8_t alpha0, uint8_t alpha1) {
+            std::array<uint8_t, 8> palette{alpha0, alpha1};
+            if (alpha0 > alpha1) {
+                for (uint32_t i{2}; i < 8; i++)
+                    palette[i] = static_cast<uint8_t>((((8 - i) * alpha0) + ((i - 1) * alpha1)) / 7);
+            } else {
+                for (uint32_t i{2}; i < 6; i++)
+                    palette[i] = static_cast<uint8_t>((((6 - i) * alpha0) + ((i - 1) * alpha1)) / 5);
+                palette[6] = 0;
+                palette[7] = 255;
+            }
+            return palette;
+        }
+
+        /**
+         * @brief Encodes a block of alpha values as a BC3 alpha block with the supplied endpoints
+         * @return The sum of the absolute error of all texels
+         */
+        uint32_t EncodeBc3Alpha(const std::array<uint8_t, BlockTexels> &alpha, uint8_t alpha0, uint8_t alpha1, uint64_t &encoded) {
+            auto palette{Bc3AlphaPalette(alpha0, alpha1)};
+            encoded = alpha0 | (static_cast<uint64_t>(alpha1) << 8);
+            uint32_t totalError{};
+            for (size_t texel{}; texel < BlockTexels; texel++) {
+                uint32_t bestError{std::numeric_limits<uint32_t>::max()};
+                uint64_t bestIndex{};
+                for (uint64_t index{}; index < palette.size(); index++) {
+                    uint32_t error{static_cast<uint32_t>(std::abs(static_cast<int>(palette[index]) - static_cast<int>(alpha[texel])))};
+                    if (error < bestError) {
+                        bestError = error;
+                        bestIndex = index;
+                    }
+                }
+                encoded |= bestIndex << (16 + (texel * 3));
+                totalError += bestError;
+            }
+            return totalError;
+        }
+    }
+
+    void EncodeBc7(const uint8_t *src, uint8_t *dst, size_t width, size_t height) {
+        Block block;
+        for (size_t y{}; y < height; y += BlockHeight) {
+            for (size_t x{}; x < width; x += BlockWidth, dst += 16) {
+                LoadBlock(src, width, height, x, y, block);
+                EncodeBc7Block(block, dst);
+            }
+        }
+    }
+
+    void TranscodeBc2ToBc3(const uint8_t *src, uint8_t *dst, size_t width, size_t height) {
+        size_t blockCount{((width + BlockWidth - 1) / BlockWidth) * ((height + BlockHeight - 1) / BlockHeight)};
+        for (size_t block{}; block < blockCount; block++, src += 16, dst += 16) {
+            uint64_t explicitAlpha;
+            std::memcpy(&explicitAlpha, src, sizeof(explicitAlpha));
+
+            std::array<uint8_t, BlockTexels> alpha;
+            uint8_t minimum{255}, maximum{0}; //!< The extremes of all alpha values
+            uint8_t innerMinimum{255}, innerMaximum{0}; //!< The extremes of all alpha values aside from 0 and 255, which are implicit in the 6-value mode
+            for (size_t texel{}; texel < BlockTexels; texel++) {
+                alpha[texel] = static_cast<uint8_t>(((explicitAlpha >> (texel * 4)) & 0xF) * 17);
+                minimum = std::min(minimum, alpha[texel]);
+                maximum = std::max(maximum, alpha[texel]);
+                if (alpha[texel] != 0 && alpha[texel] != 255) {
+                    innerMinimum = std::min(innerMinimum, alpha[texel]);
+                    innerMaximum = std::max(innerMaximum, alpha[texel]);
+                }
+            }
+            if (innerMinimum > innerMaximum)
+                innerMinimum = innerMaximum = 0;
+
+            // Both the 8-value mode spanning the extremes and the 6-value mode spanning all values other than 0 and 255 are tried, the one with lower error is used
+            uint64_t encoded, encodedInner;
+            uint32_t error{EncodeBc3Alpha(alpha, maximum, minimum, encoded)};
+            if (error != 0 && EncodeBc3Alpha(alpha, innerMinimum, innerMaximum, encodedInner) < error)
+                encoded = encodedInner;
+
+            std::memcpy(dst, &encoded, sizeof(encoded));
+            std::memcpy(dst + 8, src + 8, 8); // BC2 and BC3 share the same color block encoding
+        }
+    }
+}
@@ -0,0 +1,22 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2024 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace bcn {
+    /**
+     * @brief Encodes an R8G8B8A8 image to BC7 using only mode 6 (a single RGBA subset with 7-bit endpoints, P-bits and 4-bit indices)
+     * @note This is a fast encoder intended for transcoding at runtime, it trades quality for speed compared to an exhaustive encoder but is still significantly higher quality than BC1/BC3
+     * @note The image is treated as raw data, sRGB images should be supplied in their encoded form
+     */
+    void EncodeBc7(const uint8_t *src, uint8_t *dst, size_t width, size_t height);
+
+    /**
+     * @brief Transcodes a BC2 encoded image to BC3 by reusing the color block and re-encoding the explicit 4-bit alpha as interpolated alpha
+     * @note The result is exact for any block where the alpha values lie on the interpolated ramp between its extremes (such as blocks with up to two distinct alpha values), other blocks use the nearest value on the ramp
+     */
+    void TranscodeBc2ToBc3(const uint8_t *src, uint8_t *dst, size_t width, size_t height);
+}
@@ -0,0 +1,190 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2024 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include <array>
+#include <cstring>
+#include <common/base.h>
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#elif defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+/**
+ * @brief Kernels which copy entire GOBs (64x8 bytes) or single 64-byte GOB lines between block-linear and pitch memory
+ * @note A GOB is stored as 8 runs of 64 contiguous bytes, each run contains 4 sectors in the order (X, Y), (X, Y + 1), (X + 16, Y), (X + 16, Y + 1) with Y = 2 * (run & 3) and X = 32 * (run >> 2)
+ * @note Inside a GOB line the 4 sectors spanning X = 0, 16, 32, 48 are located at offsets 0, 32, 256, 288 respectively relative to the start of the line
+ */
+namespace skyline::gpu::texture::gob {
+    constexpr size_t SectorWidth{16}; //!< The width of a sector in bytes
+    constexpr size_t Width{64}; //!< The width of a GOB in bytes
+    constexpr size_t Height{8}; //!< The height of a GOB in lines
+    constexpr size_t Size{Width * Height}; //!< The size of a GOB in bytes
+    constexpr size_t RunCount{Size / Width}; //!< The amount of 64-byte runs inside a GOB
+    constexpr std::array<size_t, 4> LineSectorOffsets{0, 32, 256, 288}; //!< The offsets of the sectors in a single GOB line, relative to the start of the line
+
+    /**
+     * @brief A portable kernel which moves a sector at a time with fixed-size memcpy, this is used when no vector extension is available
+     */
+    struct ScalarKernel {
+        template<bool BlockLinearToPitch>
+        static void CopyGob(u8 *blockLinear, u8 *pitch, size_t pitchStride) {
+            for (size_t run{}; run < RunCount; run++, blockLinear += Width) {
+                u8 *line{pitch + ((run & 3) * 2 * pitchStride) + ((run >> 2) * 32)};
+                for (size_t sector{}; sector < 4; sector++) {
+                    u8 *linearSector{line + ((sector & 1) * pitchStride) + ((sector >> 1) * SectorWidth)};
+                    if constexpr (BlockLinearToPitch)
+                        std::memcpy(linearSector, blockLinear + (sector * SectorWidth), SectorWidth);
+                    else
+                        std::memcpy(blockLinear + (sector * SectorWidth), linearSector, SectorWidth);
+                }
+            }
+        }
+
+        template<bool BlockLinearToPitch>
+        static void CopyGobLine(u8 *blockLinearLine, u8 *pitch) {
+            for (size_t sector{}; sector < LineSectorOffsets.size(); sector++, pitch += SectorWidth) {
+                if constexpr (BlockLinearToPitch)
+                    std::memcpy(pitch, blockLinearLine + LineSectorOffsets[sector], SectorWidth);
+                else
+                    std::memcpy(blockLinearLine + LineSectorOffsets[sector], pitch, SectorWidth);
+            }
+        }
+    };
+
+    #if defined(__aarch64__)
+    /**
+     * @brief A NEON kernel which moves an entire 64-byte run in a single LD1/ST1 of four registers and splits it into two 32-byte line stores
+     */
+    struct NeonKernel {
+        template<bool BlockLinearToPitch>
+        __attribute__((always_inline)) static void CopyGob(u8 *blockLinear, u8 *pitch, size_t pitchStride) {
+            #pragma clang loop unroll(full)
+            for (size_t run{}; run < RunCount; run++, blockLinear += Width) {
+                u8 *line0{pitch + ((run & 3) * 2 * pitchStride) + ((run >> 2) * 32)};
+                u8 *line1{line0 + pitchStride};
+                if constexpr (BlockLinearToPitch) {
+                    uint8x16x4_t sectors{vld1q_u8_x4(blockLinear)};
+                    vst1q_u8_x2(line0, uint8x16x2_t{sectors.val[0], sectors.val[2]});
+                    vst1q_u8_x2(line1, uint8x16x2_t{sectors.val[1], sectors.val[3]});
+                } else {
+                    uint8x16x2_t upper{vld1q_u8_x2(line0)}, lower{vld1q_u8_x2(line1)};
+                    vst1q_u8_x4(blockLinear, uint8x16x4_t{upper.val[0], lower.val[0], upper.val[1], lower.val[1]});
+                }
+            }
+        }
+
+        template<bool BlockLinearToPitch>
+        __attribute__((always_inline)) static void CopyGobLine(u8 *blockLinearLine, u8 *pitch) {
+            if constexpr (BlockLinearToPitch) {
+                vst1q_u8_x4(pitch, uint8x16x4_t{
+                    vld1q_u8(blockLinearLine + LineSectorOffsets[0]), vld1q_u8(blockLinearLine + LineSectorOffsets[1]),
+                    vld1q_u8(blockLinearLine + LineSectorOffsets[2]), vld1q_u8(blockLinearLine + LineSectorOffsets[3]),
+                });
+            } else {
+                uint8x16x4_t sectors{vld1q_u8_x4(pitch)};
+                vst1q_u8(blockLinearLine + LineSectorOffsets[0], sectors.val[0]);
+                vst1q_u8(blockLinearLine + LineSectorOffsets[1], sectors.val[1]);
+                vst1q_u8(blockLinearLine + LineSectorOffsets[2], sectors.val[2]);
+                vst1q_u8(blockLinearLine + LineSectorOffsets[3], sectors.val[3]);
+            }
+        }
+    };
+    #elif defined(__x86_64__)
+    /**
+     * @brief An SSE2 kernel which moves a sector per 128-bit load/store, SSE2 is part of the x86-64 baseline so this is always available
+     */
+    struct Sse2Kernel {
+        template<bool BlockLinearToPitch>
+        __attribute__((always_inline)) static void CopyGob(u8 *blockLinear, u8 *pitch, size_t pitchStride) {
+            #pragma GCC unroll 8
+            for (size_t run{}; run < RunCount; run++, blockLinear += Width) {
+                u8 *line0{pitch + ((run & 3) * 2 * pitchStride) + ((run >> 2) * 32)};
+                u8 *line1{line0 + pitchStride};
+                auto *sectors{reinterpret_cast<__m128i *>(blockLinear)};
+                if constexpr (BlockLinearToPitch) {
+                    __m128i s0{_mm_loadu_si128(sectors)}, s1{_mm_loadu_si128(sectors + 1)}, s2{_mm_loadu_si128(sectors + 2)}, s3{_mm_loadu_si128(sectors + 3)};
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(line0), s0);
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(line0 + SectorWidth), s2);
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(line1), s1);
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(line1 + SectorWidth), s3);
+                } else {
+                    __m128i s0{_mm_loadu_si128(reinterpret_cast<__m128i *>(line0))}, s2{_mm_loadu_si128(reinterpret_cast<__m128i *>(line0 + SectorWidth))};
+                    __m128i s1{_mm_loadu_si128(reinterpret_cast<__m128i *>(line1))}, s3{_mm_loadu_si128(reinterpret_cast<__m128i *>(line1 + SectorWidth))};
+                    _mm_storeu_si128(sectors, s0);
+                    _mm_storeu_si128(sectors + 1, s1);
+                    _mm_storeu_si128(sectors + 2, s2);
+                    _mm_storeu_si128(sectors + 3, s3);
+                }
+            }
+        }
+
+        template<bool BlockLinearToPitch>
+        __attribute__((always_inline)) static void CopyGobLine(u8 *blockLinearLine, u8 *pitch) {
+            auto *linear{reinterpret_cast<__m128i *>(pitch)};
+            #pragma GCC unroll 4
+            for (size_t sector{}; sector < LineSectorOffsets.size(); sector++) {
+                auto *swizzled{reinterpret_cast<__m128i *>(blockLinearLine + LineSectorOffsets[sector])};
+                if constexpr (BlockLinearToPitch)
+                    _mm_storeu_si128(linear + sector, _mm_loadu_si128(swizzled));
+                else
+                    _mm_storeu_si128(swizzled, _mm_loadu_si128(linear + sector));
+            }
+        }
+    };
+
+    /**
+     * @brief An AVX2 kernel which moves a 64-byte run in two 256-bit loads, the sectors are transposed into lines with VPERM2I128
+     * @note The functions are compiled for AVX2 regardless of the global target flags, callers must check for support at runtime
+     */
+    struct Avx2Kernel {
+        template<bool BlockLinearToPitch>
+        __attribute__((target("avx2"))) static void CopyGob(u8 *blockLinear, u8 *pitch, size_t pitchStride) {
+            #pragma GCC unroll 8
+            for (size_t run{}; run < RunCount; run++, blockLinear += Width) {
+                auto *line0{reinterpret_cast<__m256i *>(pitch + ((run & 3) * 2 * pitchStride) + ((run >> 2) * 32))};
+                auto *line1{reinterpret_cast<__m256i *>(reinterpret_cast<u8 *>(line0) + pitchStride)};
+                auto *sectors{reinterpret_cast<__m256i *>(blockLinear)};
+                if constexpr (BlockLinearToPitch) {
+                    __m256i low{_mm256_loadu_si256(sectors)}, high{_mm256_loadu_si256(sectors + 1)}; // (X, Y), (X, Y + 1) and (X + 16, Y), (X + 16, Y + 1)
+                    _mm256_storeu_si256(line0, _mm256_permute2x128_si256(low, high, 0x20));
+                    _mm256_storeu_si256(line1, _mm256_permute2x128_si256(low, high, 0x31));
+                } else {
+                    __m256i upper{_mm256_loadu_si256(line0)}, lower{_mm256_loadu_si256(line1)};
+                    _mm256_storeu_si256(sectors, _mm256_permute2x128_si256(upper, lower, 0x20));
+                    _mm256_storeu_si256(sectors + 1, _mm256_permute2x128_si256(upper, lower, 0x31));
+                }
+            }
+        }
+
+        template<bool BlockLinearToPitch>
+        __attribute__((target("avx2"))) static void CopyGobLine(u8 *blockLinearLine, u8 *pitch) {
+            Sse2Kernel::CopyGobLine<BlockLinearToPitch>(blockLinearLine, pitch); // Sectors in a GOB line aren't contiguous past 16 bytes, wider vectors don't help here
+        }
+    };
+    #endif
+
+    /**
+     * @brief Invokes the supplied templated functor with the fastest kernel supported by the host CPU
+     * @note The CPU features are only queried on the first call, the result is cached for all subsequent calls
+     */
+    template<typename Function>
+    __attribute__((always_inline)) inline void DispatchKernel(Function &&function) {
+        #if defined(__aarch64__)
+        static const bool hasAsimd{(getauxval(AT_HWCAP) & HWCAP_ASIMD) != 0};
+        if (hasAsimd) [[likely]]
+            return function.template operator()<NeonKernel>();
+        #elif defined(__x86_64__)
+        static const bool hasAvx2{__builtin_cpu_supports("avx2") != 0};
+        if (hasAvx2)
+            return function.template operator()<Avx2Kernel>();
+        return function.template operator()<Sse2Kernel>();
+        #endif
+        function.template operator()<ScalarKernel>();
+    }
+}
@@ -1,7 +1,9 @@
 // SPDX-License-Identifier: MPL-2.0
 // Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
 
+#include <list>
 #include "layout.h"
+#include "gob_kernels.h"
 
 namespace skyline::gpu::texture {
     #pragma pack(push, 0)
@@ -95,11 +97,151 @@ namespace skyline::gpu::texture {
         return mipLevels;
     }
 
+    BlockLinearLayout::BlockLinearLayout(const Key &key)
+        : mipLevels{GetBlockLinearMipLayout(Dimensions{key.width, key.height, key.depth},
+                                            key.formatBlockHeight, key.formatBlockWidth, key.formatBpb,
+                                            key.targetFormatBlockHeight, key.targetFormatBlockWidth, key.targetFormatBpb,
+                                            key.gobBlockHeight, key.gobBlockDepth,
+                                            key.levelCount)},
+          layerSize{},
+          linearLayerSize{},
+          targetLinearLayerSize{} {
+        for (const auto &level : mipLevels) {
+            layerSize += level.blockLinearSize;
+            linearLayerSize += level.linearSize;
+            targetLinearLayerSize += level.targetLinearSize;
+        }
+
+        multiLayerSize = util::AlignUp(layerSize, GobWidth * GobHeight * key.gobBlockHeight * key.gobBlockDepth);
+    }
+
+    std::shared_ptr<const BlockLinearLayout> GetBlockLinearLayout(Dimensions dimensions, size_t formatBlockWidth, size_t formatBlockHeight, size_t formatBpb, size_t targetFormatBlockWidth, size_t targetFormatBlockHeight, size_t targetFormatBpb, size_t gobBlockHeight, size_t gobBlockDepth, size_t levelCount) {
+        // The parameters are guest-controlled so the amount of cached layouts is bounded, the least recently used layout is evicted once the limit is reached and is freed when its last user is destroyed
+        constexpr size_t MaxCachedLayouts{0x400};
+        using LayoutList = std::list<std::pair<BlockLinearLayout::Key, std::shared_ptr<const BlockLinearLayout>>>;
+        static LayoutList layoutList; //!< All cached layouts ordered from the most to the least recently used
+        static std::unordered_map<BlockLinearLayout::Key, LayoutList::iterator, util::ObjectHash<BlockLinearLayout::Key>> layouts;
+        static std::mutex layoutsMutex;
+
+        // Identical source and target formats are normalized to avoid duplicate layouts for textures which don't require decoding
+        bool isSameFormat{targetFormatBpb == 0 || (targetFormatBlockWidth == formatBlockWidth && targetFormatBlockHeight == formatBlockHeight && targetFormatBpb == formatBpb)};
+        BlockLinearLayout::Key key{
+            .width = dimensions.width,
+            .height = dimensions.height,
+            .depth = dimensions.depth,
+            .formatBlockWidth = static_cast<u8>(formatBlockWidth),
+            .formatBlockHeight = static_cast<u8>(formatBlockHeight),
+            .formatBpb = static_cast<u8>(formatBpb),
+            .targetFormatBlockWidth = static_cast<u8>(isSameFormat ? 0 : targetFormatBlockWidth),
+            .targetFormatBlockHeight = static_cast<u8>(isSameFormat ? 0 : targetFormatBlockHeight),
+            .targetFormatBpb = static_cast<u8>(isSameFormat ? 0 : targetFormatBpb),
+            .gobBlockHeight = static_cast<u8>(gobBlockHeight),
+            .gobBlockDepth = static_cast<u8>(gobBlockDepth),
+            .levelCount = static_cast<u32>(levelCount),
+        };
+
+        {
+            std::scoped_lock lock{layoutsMutex};
+            auto it{layouts.find(key)};
+            if (it != layouts.end()) [[likely]] {
+                layoutList.splice(layoutList.begin(), layoutList, it->second);
+                return it->second->second;
+            }
+        }
+
+        // The layout is computed without holding the lock, if another thread inserts the same layout in the meantime then its instance is used instead
+        auto layout{std::make_shared<const BlockLinearLayout>(key)};
+
+        std::scoped_lock lock{layoutsMutex};
+        auto [it, inserted]{layouts.try_emplace(key)};
+        if (!inserted) {
+            layoutList.splice(layoutList.begin(), layoutList, it->second);
+            return it->second->second;
+        }
+
+        layoutList.emplace_front(key, std::move(layout));
+        it->second = layoutList.begin();
+        if (layouts.size() > MaxCachedLayouts) {
+            layouts.erase(layoutList.back().first);
+            layoutList.pop_back();
+        }
+
+        return layoutList.front().second;
+    }
+
+    std::vector<SubresourceRegion> GetBlockLinearRegions(span<const std::pair<size_t, size_t>> ranges,
+                                                         span<const MipLevelLayout> mipLevels, size_t layerStride, size_t layerCount,
+                                                         size_t formatBlockWidth, size_t formatBlockHeight, size_t formatBpb) {
+        constexpr size_t GobSize{GobWidth * GobHeight};
+
+        std::vector<SubresourceRegion> regions;
+        size_t lastRob{}; //!< The index of the ROB of the last region, this is used to determine if a GOB can be merged into it
+        for (auto [start, end] : ranges) {
+            for (size_t offset{util::AlignDown(start, GobSize)}; offset < end; offset += GobSize) {
+                size_t layer{offset / layerStride};
+                if (layer >= layerCount)
+                    return regions;
+
+                // Locate the level containing the GOB, any GOBs past the last level are layer end padding
+                size_t levelOffset{offset - (layer * layerStride)};
+                u32 levelIndex{};
+                for (; levelIndex < mipLevels.size() && levelOffset >= mipLevels[levelIndex].blockLinearSize; levelIndex++)
+                    levelOffset -= mipLevels[levelIndex].blockLinearSize;
+                if (levelIndex == mipLevels.size())
+                    continue;
+
+                const auto &level{mipLevels[levelIndex]};
+                size_t widthBlocks{util::DivideCeil<size_t>(level.dimensions.width, formatBlockWidth)}; //!< The width of the level in format blocks
+                size_t heightBlocks{util::DivideCeil<size_t>(level.dimensions.height, formatBlockHeight)};
+                size_t sliceSize{GobSize * level.blockHeight}; //!< The size of a single slice of a block
+                size_t blockSize{sliceSize * level.blockDepth};
+                size_t robSize{util::DivideCeil<size_t>(widthBlocks * formatBpb, GobWidth) * blockSize};
+
+                size_t rob{levelOffset / robSize}, blockOffset{levelOffset % blockSize};
+                if (blockOffset >= sliceSize)
+                    continue; // Any slices after the first are Z-axis padding for 2D surfaces
+
+                size_t gobX{(levelOffset % robSize) / blockSize}, gobY{(rob * level.blockHeight) + (blockOffset / GobSize)};
+                size_t startX{(gobX * GobWidth) / formatBpb}, endX{std::min(util::DivideCeil<size_t>((gobX + 1) * GobWidth, formatBpb), widthBlocks)};
+                size_t startY{gobY * GobHeight}, endY{std::min(startY + GobHeight, heightBlocks)};
+                if (startX >= endX || startY >= endY)
+                    continue;
+
+                // Convert the rectangle from format blocks to texels, the last block in each axis may be partially outside the level
+                auto x{static_cast<u32>(startX * formatBlockWidth)}, y{static_cast<u32>(startY * formatBlockHeight)};
+                auto width{std::min(static_cast<u32>(endX * formatBlockWidth), level.dimensions.width) - x};
+                auto height{std::min(static_cast<u32>(endY * formatBlockHeight), level.dimensions.height) - y};
+
+                if (!regions.empty() && regions.back().layer == layer && regions.back().level == levelIndex && lastRob == rob) {
+                    auto &region{regions.back()};
+                    u32 regionEndX{std::max(region.x + region.width, x + width)}, regionEndY{std::max(region.y + region.height, y + height)};
+                    region.x = std::min(region.x, x);
+                    region.y = std::min(region.y, y);
+                    region.width = regionEndX - region.x;
+                    region.height = regionEndY - region.y;
+                } else {
+                    regions.push_back(SubresourceRegion{
+                        .layer = static_cast<u32>(layer),
+                        .level = levelIndex,
+                        .x = x,
+                        .y = y,
+                        .width = width,
+                        .height = height,
+                    });
+                    lastRob = rob;
+                }
+            }
+        }
+
+        return regions;
+    }
+
     /**
      * @brief Copies pixel data between a pitch-linear and blocklinear texture
      * @tparam BlockLinearToPitch Whether to copy from a blocklinear texture to a pitch-linear texture or a pitch-linear texture to a blocklinear texture
+     * @tparam Kernel The GOB copy kernel to use for any GOBs which are entirely inside the surface, partial GOBs are always copied a sector at a time
      */
-    template<bool BlockLinearToPitch>
+    template<bool BlockLinearToPitch, typename Kernel>
     void CopyBlockLinearInternal(Dimensions dimensions,
                                  size_t formatBlockWidth, size_t formatBlockHeight, size_t formatBpb, u32 pitchAmount,
                                  size_t gobBlockHeight, size_t gobBlockDepth,
@@ -131,19 +273,21 @@ namespace skyline::gpu::texture {
         u8 *sector{blockLinear};
 
         auto deswizzleRob{[&](u8 *pitchRob, auto isLastRob, size_t depthSliceCount, size_t blockPaddingY = 0, size_t blockExtentY = 0) {
-            auto deswizzleBlock{[&](u8 *pitchBlock, auto copySector) __attribute__((always_inline)) {
+            auto deswizzleBlock{[&](u8 *pitchBlock, auto copySector, auto isPaddingBlock) __attribute__((always_inline)) {
                 for (size_t gobZ{}; gobZ < depthSliceCount; gobZ++) { // Every Block contains `depthSliceCount` slices, excluding padding
                     u8 *pitchGob{pitchBlock};
                     for (size_t gobY{}; gobY < blockHeight; gobY++) { // Every Block contains `blockHeight` Y-axis GOBs
-                        #pragma clang loop unroll_count(SectorLinesInGob)
-                        for (size_t index{}; index < SectorLinesInGob; index++) {
-                            size_t xT{((index << 3) & 0b10000) | ((index << 1) & 0b100000)}; // Morton-Swizzle on the X-axis
-                            size_t yT{((index >> 1) & 0b110) | (index & 0b1)}; // Morton-Swizzle on the Y-axis
-
-                            if constexpr (!isLastRob) {
-                                copySector(pitchGob + (yT * pitchWidthBytes) + xT, xT);
-                            } else {
-                                if (gobY != blockHeight - 1 || yT < blockExtentY)
+                        if (!isPaddingBlock && (!isLastRob || gobY != blockHeight - 1 || blockExtentY == GobHeight)) [[likely]] {
+                            // The GOB is entirely inside the surface, so we can copy it in one go
+                            Kernel::template CopyGob<BlockLinearToPitch>(sector, pitchGob, pitchWidthBytes);
+                            sector += gob::Size;
+                        } else {
+                            #pragma clang loop unroll_count(SectorLinesInGob)
+                            for (size_t index{}; index < SectorLinesInGob; index++) {
+                                size_t xT{((index << 3) & 0b10000) | ((index << 1) & 0b100000)}; // Morton-Swizzle on the X-axis
+                                size_t yT{((index >> 1) & 0b110) | (index & 0b1)}; // Morton-Swizzle on the Y-axis
+
+                                if (!isLastRob || gobY != blockHeight - 1 || yT < blockExtentY)
                                     copySector(pitchGob + (yT * pitchWidthBytes) + xT, xT);
                                 else
                                     sector += SectorWidth;
@@ -170,7 +314,7 @@ namespace skyline::gpu::texture {
                     else
                         std::memcpy(sector, linearSector, SectorWidth);
                     sector += SectorWidth; // `sectorWidth` bytes are of sequential image data
-                });
+                }, std::false_type{});
 
                 pitchRob += GobWidth; // Increment the linear block to the next block (As Block Width = 1 GOB Width)
             }
@@ -186,7 +330,7 @@ namespace skyline::gpu::texture {
                             std::memcpy(sector, linearSector, copyAmount);
                     }
                     sector += SectorWidth;
-                });
+                }, std::true_type{});
         }};
 
         for (size_t currMob{}; currMob < depthMobCount; ++currMob, pitch += gobZOffset * gobBlockDepth) {
@@ -213,12 +357,29 @@ namespace skyline::gpu::texture {
         }
     }
 
+    /**
+     * @brief Selects the fastest GOB kernel supported by the host and copies pixel data between a pitch-linear and blocklinear texture with it
+     */
+    template<bool BlockLinearToPitch>
+    void CopyBlockLinearInternal(Dimensions dimensions,
+                                 size_t formatBlockWidth, size_t formatBlockHeight, size_t formatBpb, u32 pitchAmount,
+                                 size_t gobBlockHeight, size_t gobBlockDepth,
+                                 u8 *blockLinear, u8 *pitch) {
+        gob::DispatchKernel([&]<typename Kernel>() {
+            CopyBlockLinearInternal<BlockLinearToPitch, Kernel>(dimensions,
+                                                                formatBlockWidth, formatBlockHeight, formatBpb, pitchAmount,
+                                                                gobBlockHeight, gobBlockDepth,
+                                                                blockLinear, pitch);
+        });
+    }
+
     /**
      * @brief Copies pixel data between a pitch and part of a blocklinear texture
      * @tparam BlockLinearToPitch Whether to copy from a part of a blocklinear texture to a pitch texture or a pitch texture to a part of a blocklinear texture
+     * @tparam Kernel The GOB copy kernel to use for any GOB lines which are entirely inside the subrect, the unaligned edges are copied a pixel at a time
      * @note The function assumes that the pitch texture is always equal or smaller than the blocklinear texture
      */
-    template<bool BlockLinearToPitch>
+    template<bool BlockLinearToPitch, typename Kernel>
     void CopyBlockLinearSubrectInternal(Dimensions pitchDimensions, Dimensions blockLinearDimensions,
                                         size_t formatBlockWidth, size_t formatBlockHeight, size_t formatBpb, u32 pitchAmount,
                                         size_t gobBlockHeight, size_t gobBlockDepth,
@@ -261,9 +422,29 @@ namespace skyline::gpu::texture {
         size_t robPerMob{util::DivideCeil<size_t>(util::DivideCeil<size_t>(blockLinearDimensions.height, formatBlockHeight), robHeight)};
         size_t blockSize{robHeight * GobWidth * gobBlockDepth};
 
+        // The X-axis range of every line is split into an unaligned head and tail which are copied a pixel at a time and a GOB-aligned body which is copied a GOB line at a time
+        size_t endXBytes{originXBytes + (pitchTextureWidth * formatBpb)};
+        size_t bodyStartXBytes{std::min(util::AlignUp(originXBytes, GobWidth), endXBytes)};
+        size_t bodyEndXBytes{std::max(util::AlignDown(endXBytes, GobWidth), bodyStartXBytes)};
+
         u8 *pitchOffset{pitch};
 
         auto copyTexture{[&]<typename FORMATBPB>() __attribute__((always_inline)) {
+            auto copyPixels{[&](u8 *swizzledYZOffset, u8 *deSwizzledOffset, size_t xBytes, size_t xEndBytes) __attribute__((always_inline)) {
+                for (; xBytes < xEndBytes; deSwizzledOffset += formatBpb, xBytes += formatBpb) {
+                    // XYZ Offset in entire blocks in current ROB and X Offset inside current GOB
+                    size_t blockOffset{(xBytes / GobWidth) * blockSize};
+                    size_t GobXOffset{((xBytes & 0x20) << 3) + (xBytes & 0xF) + ((xBytes & 0x10) << 1)};
+
+                    u8 *swizzledOffset{swizzledYZOffset + blockOffset + GobXOffset};
+
+                    if constexpr (BlockLinearToPitch)
+                        *reinterpret_cast<FORMATBPB *>(deSwizzledOffset) = *reinterpret_cast<FORMATBPB *>(swizzledOffset);
+                    else
+                        *reinterpret_cast<FORMATBPB *>(swizzledOffset) = *reinterpret_cast<FORMATBPB *>(deSwizzledOffset);
+                }
+            }};
+
             for (size_t currMob{}; currMob < depthMobCount; ++currMob, blockLinear += robSize * robPerMob) {
                 size_t sliceCount{(currMob + 1) == depthMobCount ? lastMobSliceCount : gobBlockDepth};
                 u64 sliceOffset{};
@@ -278,30 +459,15 @@ namespace skyline::gpu::texture {
                         // Y Offset inside current GOB
                         GobYOffset += (((originY + line) & 0x6) << 5) + (((originY + line) & 0x1) << 4);
 
-                        u8 *deSwizzledOffset{pitchOffset};
                         u8 *swizzledYZOffset{blockLinear + robOffset + GobYOffset + sliceOffset};
-                        u8 *swizzledOffset{};
-
-                        size_t xBytes{originXBytes};
-                        size_t GobXOffset{};
 
-                        size_t blockOffset{util::AlignDown(xBytes, GobWidth) * robHeight * gobBlockDepth};
+                        copyPixels(swizzledYZOffset, pitchOffset, originXBytes, bodyStartXBytes);
 
-                        for (size_t pixel{}; pixel < pitchTextureWidth; ++pixel, deSwizzledOffset += formatBpb, xBytes += formatBpb) {
-                            // XYZ Offset in entire blocks in current ROB
-                            if (pixel && !(xBytes & 0x3F)) [[unlikely]]
-                                blockOffset += blockSize;
+                        u8 *deSwizzledOffset{pitchOffset + (bodyStartXBytes - originXBytes)};
+                        for (size_t xBytes{bodyStartXBytes}; xBytes < bodyEndXBytes; xBytes += GobWidth, deSwizzledOffset += GobWidth)
+                            Kernel::template CopyGobLine<BlockLinearToPitch>(swizzledYZOffset + ((xBytes / GobWidth) * blockSize), deSwizzledOffset);
 
-                            // X Offset inside current GOB
-                            GobXOffset = ((xBytes & 0x20) << 3) + (xBytes & 0xF) + ((xBytes & 0x10) << 1);
-
-                            swizzledOffset = swizzledYZOffset + blockOffset + GobXOffset;
-
-                            if constexpr (BlockLinearToPitch)
-                                *reinterpret_cast<FORMATBPB *>(deSwizzledOffset) = *reinterpret_cast<FORMATBPB *>(swizzledOffset);
-                            else
-                                *reinterpret_cast<FORMATBPB *>(swizzledOffset) = *reinterpret_cast<FORMATBPB *>(deSwizzledOffset);
-                        }
+                        copyPixels(swizzledYZOffset, pitchOffset + (bodyEndXBytes - originXBytes), bodyEndXBytes, endXBytes);
                     }
                 }
             }
@@ -331,6 +497,24 @@ namespace skyline::gpu::texture {
         }
     }
 
+    /**
+     * @brief Selects the fastest GOB kernel supported by the host and copies pixel data between a pitch and part of a blocklinear texture with it
+     */
+    template<bool BlockLinearToPitch>
+    void CopyBlockLinearSubrectInternal(Dimensions pitchDimensions, Dimensions blockLinearDimensions,
+                                        size_t formatBlockWidth, size_t formatBlockHeight, size_t formatBpb, u32 pitchAmount,
+                                        size_t gobBlockHeight, size_t gobBlockDepth,
+                                        u8 *blockLinear, u8 *pitch,
+                                        u32 originX, u32 originY) {
+        gob::DispatchKernel([&]<typename Kernel>() {
+            CopyBlockLinearSubrectInternal<BlockLinearToPitch, Kernel>(pitchDimensions, blockLinearDimensions,
+                                                                       formatBlockWidth, formatBlockHeight, formatBpb, pitchAmount,
+                                                                       gobBlockHeight, gobBlockDepth,
+                                                                       blockLinear, pitch,
+                                                                       originX, originY);
+        });
+    }
+
     void CopyBlockLinearToLinear(Dimensions dimensions, size_t formatBlockWidth, size_t formatBlockHeight, size_t formatBpb, size_t gobBlockHeight, size_t gobBlockDepth, u8 *blockLinear, u8 *linear) {
         CopyBlockLinearInternal<true>(
             dimensions,
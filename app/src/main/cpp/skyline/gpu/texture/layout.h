@@ -32,6 +32,71 @@ namespace skyline::gpu::texture {
                                                         size_t gobBlockHeight, size_t gobBlockDepth,
                                                         size_t levelCount);
 
+    /**
+     * @brief An immutable description of the layout of a block-linear surface with all of its mip levels
+     * @note Layouts are cached by GetBlockLinearLayout, surfaces with the same parameters share a single instance which is kept alive by its users after being evicted from the cache
+     */
+    struct BlockLinearLayout {
+        /**
+         * @brief All parameters which determine the layout of a surface
+         * @note A target format bpb of 0 denotes that the target format is the same as the source format
+         */
+        struct Key {
+            u32 width, height, depth;
+            u8 formatBlockWidth, formatBlockHeight, formatBpb;
+            u8 targetFormatBlockWidth, targetFormatBlockHeight, targetFormatBpb;
+            u8 gobBlockHeight, gobBlockDepth;
+            u32 levelCount;
+
+            bool operator==(const Key &) const = default;
+        };
+
+        std::vector<MipLevelLayout> mipLevels; //!< The layout of every mip level of the surface
+        size_t layerSize; //!< The size of a single layer of the block-linear surface in bytes
+        size_t multiLayerSize; //!< The size of a single layer of the block-linear surface in bytes, aligned to a block as required for surfaces with more than one layer
+        size_t linearLayerSize; //!< The size of a single layer with linear tiling in the source format in bytes, this is the sum of `linearSize` of every level
+        size_t targetLinearLayerSize; //!< The size of a single layer with linear tiling in the target format in bytes, this is the sum of `targetLinearSize` of every level
+
+        BlockLinearLayout(const Key &key);
+
+        /**
+         * @param isMultiLayer If the surface has more than one layer, a multi-layer surface requires alignment to a block at layer end
+         */
+        size_t GetLayerSize(bool isMultiLayer) const {
+            return isMultiLayer ? multiLayerSize : layerSize;
+        }
+    };
+
+    /**
+     * @note The target format is the format of the texture after it has been decoded, if bpb is 0, the target format is the same as the source format
+     * @return The shared layout of the supplied block-linear surface, this is only computed if a layout with the same parameters isn't in the cache
+     */
+    std::shared_ptr<const BlockLinearLayout> GetBlockLinearLayout(Dimensions dimensions,
+                                                  size_t formatBlockWidth, size_t formatBlockHeight, size_t formatBpb,
+                                                  size_t targetFormatBlockWidth, size_t targetFormatBlockHeight, size_t targetFormatBpb,
+                                                  size_t gobBlockHeight, size_t gobBlockDepth,
+                                                  size_t levelCount);
+
+    /**
+     * @brief A rectangle of texels inside a single mip level and array layer of a 2D surface
+     */
+    struct SubresourceRegion {
+        u32 layer;
+        u32 level;
+        u32 x, y; //!< The offset of the region in texels, this is always aligned to the format block size
+        u32 width, height; //!< The extent of the region in texels
+    };
+
+    /**
+     * @brief Maps ranges of bytes in a 2D block-linear surface back to the rectangles of texels that are stored in them
+     * @param ranges Sorted and non-overlapping ranges of offsets relative to the start of the surface, each range is expanded to contain all GOBs it touches
+     * @param layerStride The stride between array layers of the surface in bytes
+     * @note The rectangles of all GOBs within the same ROB of a level are merged into their bounding box, GOBs which solely contain padding are discarded
+     */
+    std::vector<SubresourceRegion> GetBlockLinearRegions(span<const std::pair<size_t, size_t>> ranges,
+                                                         span<const MipLevelLayout> mipLevels, size_t layerStride, size_t layerCount,
+                                                         size_t formatBlockWidth, size_t formatBlockHeight, size_t formatBpb);
+
     /**
      * @brief Copies the contents of a blocklinear texture to a linear output buffer
      */
@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: MPL-2.0
 // Copyright © 2020 Skyline Team and Contributors (https://github.com/skyline-emu/)
 
+#include <numeric>
 #include <gpu.h>
 #include <kernel/memory.h>
 #include <kernel/types/KProcess.h>
@@ -10,6 +11,8 @@
 #include "layout.h"
 #include "adreno_aliasing.h"
 #include "bc_decoder.h"
+#include "bc_encoder.h"
+#include "astc_decoder.h"
 #include "format.h"
 
 namespace skyline::gpu {
@@ -30,10 +33,18 @@ namespace skyline::gpu {
                 return dimensions.height * tileConfig.pitch;
 
             case texture::TileMode::Block:
-                return static_cast<u32>(texture::GetBlockLinearLayerSize(dimensions, format->blockHeight, format->blockWidth, format->bpb, tileConfig.blockHeight, tileConfig.blockDepth, mipLevelCount, layerCount > 1));
+                return static_cast<u32>(GetBlockLinearLayout()->GetLayerSize(layerCount > 1));
         }
     }
 
+    std::shared_ptr<const texture::BlockLinearLayout> GuestTexture::GetBlockLinearLayout() const {
+        return texture::GetBlockLinearLayout(dimensions,
+                                             format->blockWidth, format->blockHeight, format->bpb,
+                                             0, 0, 0,
+                                             tileConfig.blockHeight, tileConfig.blockDepth,
+                                             mipLevelCount);
+    }
+
     vk::ImageType GuestTexture::GetImageType() const {
         switch (viewType) {
             case vk::ImageViewType::e1D:
@@ -250,6 +261,13 @@ namespace skyline::gpu {
 
         WaitOnBacking();
 
+        std::vector<texture::SubresourceRegion> dirtyRegions;
+        if (GetDirtyRegions(dirtyRegions))
+            return dirtyRegions.empty() ? nullptr : SynchronizeHostRegions(dirtyRegions); // The host texture is already up to date if no regions were modified
+
+        if (auto stagingBuffer{PrepareGpuDecode()})
+            return stagingBuffer;
+
         u8 *bufferData;
         auto stagingBuffer{[&]() -> std::shared_ptr<memory::StagingBuffer> {
             if (tiling == vk::ImageTiling::eOptimal || !std::holds_alternative<memory::Image>(backing)) {
@@ -269,6 +287,15 @@ namespace skyline::gpu {
             }
         }()};
 
+        // Textures which require decoding on the CPU are looked up in the persistent cache, a hit is directly copied into the staging buffer to skip deswizzling and decoding entirely
+        std::optional<DecodedTextureCacheManager::Key> decodedCacheKey;
+        u8 *decodedOutput{bufferData};
+        if (guest->format != format && gpu.decodedTextureCacheManager && DecodedTextureCacheManager::ShouldCache(surfaceSize)) {
+            decodedCacheKey = DecodedTextureCacheManager::MakeKey(*guest, format, levelCount, mirror);
+            if (gpu.decodedTextureCacheManager->Lookup(*decodedCacheKey, span<u8>{decodedOutput, surfaceSize}))
+                return stagingBuffer;
+        }
+
         std::vector<u8> deswizzleBuffer;
         u8 *deswizzleOutput;
         if (guest->format != format) {
@@ -279,13 +306,21 @@ namespace skyline::gpu {
         }
 
         auto guestLayerStride{guest->GetLayerStride()};
+        auto tilingToken{gpu.tilingPool.CreateToken(deswizzledSurfaceSize)}; // Every layer and mip level is deswizzled as separate jobs which are waited on prior to decoding
         if (levelCount == 1) {
             auto outputLayer{deswizzleOutput};
             for (size_t layer{}; layer < layerCount; layer++) {
                 if (guest->tileConfig.mode == texture::TileMode::Block)
-                    texture::CopyBlockLinearToLinear(*guest, pointer, outputLayer);
+                    gpu.tilingPool.CopyBlockLinearToLinear(
+                        tilingToken, guest->dimensions,
+                        guest->format->blockWidth, guest->format->blockHeight, guest->format->bpb,
+                        guest->tileConfig.blockHeight, guest->tileConfig.blockDepth,
+                        pointer, outputLayer
+                    );
                 else if (guest->tileConfig.mode == texture::TileMode::Pitch)
-                    texture::CopyPitchLinearToLinear(*guest, pointer, outputLayer);
+                    gpu.tilingPool.Submit(tilingToken, [&guestTexture = *guest, pointer, outputLayer] {
+                        texture::CopyPitchLinearToLinear(guestTexture, pointer, outputLayer);
+                    });
                 else if (guest->tileConfig.mode == texture::TileMode::Linear)
                     std::memcpy(outputLayer, pointer, surfaceSize);
                 pointer += guestLayerStride;
@@ -296,8 +331,8 @@ namespace skyline::gpu {
             for (size_t layer{}; layer < layerCount; layer++) {
                 auto inputLevel{pointer}, outputLevel{deswizzleOutput};
                 for (const auto &level : mipLayouts) {
-                    texture::CopyBlockLinearToLinear(
-                        level.dimensions,
+                    gpu.tilingPool.CopyBlockLinearToLinear(
+                        tilingToken, level.dimensions,
                         guest->format->blockWidth, guest->format->blockHeight, guest->format->bpb,
                         level.blockHeight, level.blockDepth,
                         inputLevel, outputLevel + (layer * level.linearSize) // Offset into the current layer relative to the start of the current mip level
@@ -313,49 +348,117 @@ namespace skyline::gpu {
             throw exception("Mipmapped textures with tiling mode '{}' aren't supported", static_cast<int>(tiling));
         }
 
+        tilingToken.Wait();
+
         if (!deswizzleBuffer.empty()) {
+            auto decodeToken{gpu.tilingPool.CreateToken(surfaceSize)};
             for (const auto &level : mipLayouts) {
-                size_t levelHeight{level.dimensions.height * layerCount}; //!< The height of an image representing all layers in the entire level
+                /**
+                 * @brief Decodes every layer of the level with the supplied decoder which has the same semantics as the bcn:: decoders
+                 * @note Layers are decoded individually as the last row of blocks of a layer may be partial, rows of blocks in each layer are split across the tiling pool
+                 * @note When transcoding into a compressed host format, jobs are split on groups of lines that are a multiple of both the guest and host block heights
+                 */
+                auto decode{[&](auto decoder) {
+                    size_t groupLines{std::lcm<size_t>(guest->format->blockHeight, format->blockHeight)}; //!< The amount of lines in the smallest unit that can be decoded independently
+                    size_t groups{util::DivideCeil<size_t>(level.dimensions.height, groupLines)};
+                    size_t inputGroupSize{util::DivideCeil<size_t>(level.dimensions.width, guest->format->blockWidth) * guest->format->bpb * (groupLines / guest->format->blockHeight)};
+                    size_t outputGroupSize{util::DivideCeil<size_t>(level.dimensions.width, format->blockWidth) * format->bpb * (groupLines / format->blockHeight)};
+
+                    for (size_t layer{}; layer < layerCount; layer++) {
+                        const u8 *layerInput{deswizzleOutput + (layer * level.linearSize)};
+                        u8 *layerOutput{bufferData + (layer * level.targetLinearSize)};
+                        gpu.tilingPool.SubmitBlockRows(decodeToken, groups, outputGroupSize, [=, width = level.dimensions.width, height = level.dimensions.height](size_t firstGroup, size_t groupCount) {
+                            size_t firstLine{firstGroup * groupLines};
+                            decoder(layerInput + (firstGroup * inputGroupSize), layerOutput + (firstGroup * outputGroupSize), width, std::min(groupCount * groupLines, height - firstLine));
+                        });
+                    }
+                }};
+
                 switch (guest->format->vkFormat) {
                     case vk::Format::eBc1RgbaUnormBlock:
                     case vk::Format::eBc1RgbaSrgbBlock:
-                        bcn::DecodeBc1(deswizzleOutput, bufferData, level.dimensions.width, levelHeight, true);
+                        decode([](const u8 *input, u8 *output, size_t width, size_t height) { bcn::DecodeBc1(input, output, width, height, true); });
                         break;
 
                     case vk::Format::eBc2UnormBlock:
                     case vk::Format::eBc2SrgbBlock:
-                        bcn::DecodeBc2(deswizzleOutput, bufferData, level.dimensions.width, levelHeight);
+                        if (format->IsCompressed())
+                            decode(bcn::TranscodeBc2ToBc3);
+                        else
+                            decode(bcn::DecodeBc2);
                         break;
 
                     case vk::Format::eBc3UnormBlock:
                     case vk::Format::eBc3SrgbBlock:
-                        bcn::DecodeBc3(deswizzleOutput, bufferData, level.dimensions.width, levelHeight);
+                        decode(bcn::DecodeBc3);
                         break;
 
                     case vk::Format::eBc4UnormBlock:
-                        bcn::DecodeBc4(deswizzleOutput, bufferData, level.dimensions.width, levelHeight, false);
+                        decode([](const u8 *input, u8 *output, size_t width, size_t height) { bcn::DecodeBc4(input, output, width, height, false); });
                         break;
                     case vk::Format::eBc4SnormBlock:
-                        bcn::DecodeBc4(deswizzleOutput, bufferData, level.dimensions.width, levelHeight, true);
+                        decode([](const u8 *input, u8 *output, size_t width, size_t height) { bcn::DecodeBc4(input, output, width, height, true); });
                         break;
 
                     case vk::Format::eBc5UnormBlock:
-                        bcn::DecodeBc5(deswizzleOutput, bufferData, level.dimensions.width, levelHeight, false);
+                        decode([](const u8 *input, u8 *output, size_t width, size_t height) { bcn::DecodeBc5(input, output, width, height, false); });
                         break;
                     case vk::Format::eBc5SnormBlock:
-                        bcn::DecodeBc5(deswizzleOutput, bufferData, level.dimensions.width, levelHeight, true);
+                        decode([](const u8 *input, u8 *output, size_t width, size_t height) { bcn::DecodeBc5(input, output, width, height, true); });
                         break;
 
                     case vk::Format::eBc6HUfloatBlock:
-                        bcn::DecodeBc6(deswizzleOutput, bufferData, level.dimensions.width, levelHeight, false);
+                        decode([](const u8 *input, u8 *output, size_t width, size_t height) { bcn::DecodeBc6(input, output, width, height, false); });
                         break;
                     case vk::Format::eBc6HSfloatBlock:
-                        bcn::DecodeBc6(deswizzleOutput, bufferData, level.dimensions.width, levelHeight, true);
+                        decode([](const u8 *input, u8 *output, size_t width, size_t height) { bcn::DecodeBc6(input, output, width, height, true); });
                         break;
 
                     case vk::Format::eBc7UnormBlock:
                     case vk::Format::eBc7SrgbBlock:
-                        bcn::DecodeBc7(deswizzleOutput, bufferData, level.dimensions.width, levelHeight);
+                        decode(bcn::DecodeBc7);
+                        break;
+
+                    case vk::Format::eAstc4x4UnormBlock:
+                    case vk::Format::eAstc5x4UnormBlock:
+                    case vk::Format::eAstc5x5UnormBlock:
+                    case vk::Format::eAstc6x5UnormBlock:
+                    case vk::Format::eAstc6x6UnormBlock:
+                    case vk::Format::eAstc8x5UnormBlock:
+                    case vk::Format::eAstc8x6UnormBlock:
+                    case vk::Format::eAstc8x8UnormBlock:
+                    case vk::Format::eAstc10x5UnormBlock:
+                    case vk::Format::eAstc10x6UnormBlock:
+                    case vk::Format::eAstc10x8UnormBlock:
+                    case vk::Format::eAstc10x10UnormBlock:
+                    case vk::Format::eAstc12x10UnormBlock:
+                    case vk::Format::eAstc12x12UnormBlock:
+                    case vk::Format::eAstc4x4SrgbBlock:
+                    case vk::Format::eAstc5x4SrgbBlock:
+                    case vk::Format::eAstc5x5SrgbBlock:
+                    case vk::Format::eAstc6x5SrgbBlock:
+                    case vk::Format::eAstc6x6SrgbBlock:
+                    case vk::Format::eAstc8x5SrgbBlock:
+                    case vk::Format::eAstc8x6SrgbBlock:
+                    case vk::Format::eAstc8x8SrgbBlock:
+                    case vk::Format::eAstc10x5SrgbBlock:
+                    case vk::Format::eAstc10x6SrgbBlock:
+                    case vk::Format::eAstc10x8SrgbBlock:
+                    case vk::Format::eAstc10x10SrgbBlock:
+                    case vk::Format::eAstc12x10SrgbBlock:
+                    case vk::Format::eAstc12x12SrgbBlock:
+                        if (format->IsCompressed()) {
+                            // ASTC is transcoded into BC7 through an intermediate R8G8B8A8 image which only spans the lines decoded by the job
+                            decode([blockWidth = guest->format->blockWidth, blockHeight = guest->format->blockHeight, isSrgb = format == format::BC7Srgb](const u8 *input, u8 *output, size_t width, size_t height) {
+                                std::vector<u8> decoded(width * height * format::R8G8B8A8Unorm.bpb);
+                                astc::DecodeAstc(input, decoded.data(), width, height, blockWidth, blockHeight, isSrgb);
+                                bcn::EncodeBc7(decoded.data(), output, width, height);
+                            });
+                        } else {
+                            decode([blockWidth = guest->format->blockWidth, blockHeight = guest->format->blockHeight, isSrgb = format == format::R8G8B8A8Srgb](const u8 *input, u8 *output, size_t width, size_t height) {
+                                astc::DecodeAstc(input, output, width, height, blockWidth, blockHeight, isSrgb);
+                            });
+                        }
                         break;
 
                     default:
@@ -365,6 +468,162 @@ namespace skyline::gpu {
                 deswizzleOutput += level.linearSize * layerCount;
                 bufferData += level.targetLinearSize * layerCount;
             }
+            decodeToken.Wait();
+
+            if (decodedCacheKey)
+                gpu.decodedTextureCacheManager->QueueWrite(*decodedCacheKey, span<const u8>{decodedOutput, surfaceSize});
+        }
+
+        return stagingBuffer;
+    }
+
+    bool Texture::GetDirtyRegions(std::vector<texture::SubresourceRegion> &regions) {
+        bool wasSynchronized{std::exchange(hostSynchronized, true)};
+
+        // Partial synchronization is limited to 2D color block-linear textures without any decoding that are never written to by the GPU, this ensures the host texture only ever contains guest data
+        bool isSupported{guest->tileConfig.mode == texture::TileMode::Block && guest->format == format && format->vkAspect == vk::ImageAspectFlagBits::eColor && dimensions.depth == 1 &&
+                         !everUsedAsRt && !memoryFreed && layout != vk::ImageLayout::eUndefined && (tiling == vk::ImageTiling::eOptimal || !std::holds_alternative<memory::Image>(backing))};
+        if (!isSupported) {
+            syncedPageHashes.clear();
+            return false;
+        }
+
+        auto hashPage{[this](size_t page) {
+            auto pageData{mirror.subspan(page * DirtyTrackingGranularity)};
+            return XXH3_64bits(pageData.data(), std::min(pageData.size(), DirtyTrackingGranularity));
+        }};
+
+        size_t pageCount{util::DivideCeil(mirror.size(), DirtyTrackingGranularity)};
+        if (syncedPageHashes.size() != pageCount) {
+            // Most textures are only synchronized once, hashing is deferred until a texture is synchronized again to avoid the overhead for them
+            if (wasSynchronized) {
+                syncedPageHashes.resize(pageCount);
+                for (size_t page{}; page < pageCount; page++)
+                    syncedPageHashes[page] = hashPage(page);
+            }
+            return false;
+        }
+
+        std::vector<std::pair<size_t, size_t>> dirtyRanges;
+        size_t dirtySize{};
+        for (size_t page{}; page < pageCount; page++) {
+            auto hash{hashPage(page)};
+            if (hash == syncedPageHashes[page])
+                continue;
+
+            syncedPageHashes[page] = hash;
+            size_t start{page * DirtyTrackingGranularity}, end{std::min(start + DirtyTrackingGranularity, mirror.size())};
+            if (!dirtyRanges.empty() && dirtyRanges.back().second == start)
+                dirtyRanges.back().second = end;
+            else
+                dirtyRanges.emplace_back(start, end);
+            dirtySize += end - start;
+        }
+
+        if (dirtySize > mirror.size() / 2)
+            return false; // A full synchronization is cheaper than copying a large amount of individual regions
+
+        regions = texture::GetBlockLinearRegions(dirtyRanges, mipLayouts, guest->GetLayerStride(), layerCount, guest->format->blockWidth, guest->format->blockHeight, guest->format->bpb);
+        return true;
+    }
+
+    std::shared_ptr<memory::StagingBuffer> Texture::SynchronizeHostRegions(span<const texture::SubresourceRegion> regions) {
+        TRACE_EVENT("gpu", "Texture::SynchronizeHostRegions", "regions", regions.size());
+
+        // Every region is tightly packed in the staging buffer at an offset aligned to a format block and 4 bytes as required by Vulkan
+        size_t offsetAlignment{std::lcm<size_t>(format->bpb, 4)};
+        std::vector<size_t> regionOffsets;
+        regionOffsets.reserve(regions.size());
+        size_t stagingSize{};
+        for (const auto &region : regions) {
+            stagingSize = util::AlignUp(stagingSize, offsetAlignment);
+            regionOffsets.push_back(stagingSize);
+            stagingSize += format->GetSize(region.width, region.height);
+        }
+
+        auto stagingBuffer{gpu.memory.AllocateStagingBuffer(stagingSize)};
+        std::vector<u8 *> levelOffsets; //!< The offset of every level in the first layer of the guest texture
+        levelOffsets.reserve(levelCount);
+        for (u8 *levelOffset{mirror.data()}; const auto &level : mipLayouts) {
+            levelOffsets.push_back(levelOffset);
+            levelOffset += level.blockLinearSize;
+        }
+
+        auto guestLayerStride{guest->GetLayerStride()};
+        auto tilingToken{gpu.tilingPool.CreateToken(stagingSize)};
+        for (size_t index{}; index < regions.size(); index++) {
+            const auto &region{regions[index]};
+            const auto &level{mipLayouts[region.level]};
+            u8 *input{levelOffsets[region.level] + (region.layer * guestLayerStride)}, *output{stagingBuffer->data() + regionOffsets[index]};
+            gpu.tilingPool.Submit(tilingToken, [&guestFormat = *guest->format, &level, region, input, output] {
+                texture::CopyBlockLinearToPitchSubrect(
+                    texture::Dimensions{region.width, region.height, 1}, level.dimensions,
+                    guestFormat.blockWidth, guestFormat.blockHeight, guestFormat.bpb, 0,
+                    level.blockHeight, level.blockDepth,
+                    input, output,
+                    region.x, region.y
+                );
+            });
+
+            pendingBufferImageCopies.emplace_back(vk::BufferImageCopy{
+                .bufferOffset = regionOffsets[index],
+                .imageSubresource = {
+                    .aspectMask = vk::ImageAspectFlagBits::eColor,
+                    .mipLevel = region.level,
+                    .baseArrayLayer = region.layer,
+                    .layerCount = 1,
+                },
+                .imageOffset = {static_cast<i32>(region.x), static_cast<i32>(region.y), 0},
+                .imageExtent = {region.width, region.height, 1},
+            });
+        }
+        tilingToken.Wait();
+
+        return stagingBuffer;
+    }
+
+    std::shared_ptr<memory::StagingBuffer> Texture::PrepareGpuDecode() {
+        if (!*gpu.state.settings->useGpuTextureDecoding || guest->tileConfig.mode != texture::TileMode::Block)
+            return nullptr;
+
+        if (tiling != vk::ImageTiling::eOptimal && std::holds_alternative<memory::Image>(backing))
+            return nullptr; // Host linear textures are directly written on the CPU which is cheaper than a staging copy
+
+        auto mode{TextureDecodeHelperShader::GetMode(*guest->format, *format)};
+        if (!mode)
+            return nullptr;
+
+        // The shader writes R8/R8G8 output a word at a time so every row of every level must start on a word boundary
+        u32 widthAlignment{*mode == TextureDecodeHelperShader::Mode::Bc4 ? 4U : (*mode == TextureDecodeHelperShader::Mode::Bc5 ? 2U : 1U)};
+        auto guestLayerStride{guest->GetLayerStride()};
+        if (!util::IsAligned(guestLayerStride, sizeof(u32)) || !ranges::all_of(mipLayouts, [widthAlignment](const auto &level) { return util::IsAligned(level.dimensions.width, widthAlignment); }))
+            return nullptr;
+
+        auto input{gpu.memory.AllocateStagingBuffer(util::AlignUp(mirror.size(), sizeof(u32)), vk::BufferUsageFlagBits::eStorageBuffer)};
+        std::memcpy(input->data(), mirror.data(), mirror.size());
+
+        auto stagingBuffer{gpu.memory.AllocateStagingBuffer(surfaceSize, vk::BufferUsageFlagBits::eStorageBuffer)};
+        bool isSigned{guest->format->vkFormat == vk::Format::eBc4SnormBlock || guest->format->vkFormat == vk::Format::eBc5SnormBlock};
+        gpuDecode = gpu.helperShaders.textureDecodeHelperShader.CreateDecode(gpu, *mode, isSigned, *guest->format, std::move(input), stagingBuffer);
+
+        // The output is in the layout consumed by GetBufferImageCopies, where all layers of a mip level are contiguous
+        gpuDecode->subresources.reserve(layerCount * levelCount);
+        for (size_t layer{}; layer < layerCount; layer++) {
+            size_t inputLevel{layer * guestLayerStride}, outputLevel{};
+            for (const auto &level : mipLayouts) {
+                gpuDecode->subresources.push_back(TextureDecodeHelperShader::Subresource{
+                    .srcOffset = static_cast<u32>(inputLevel),
+                    .dstOffset = static_cast<u32>(outputLevel + (layer * level.targetLinearSize)),
+                    .width = level.dimensions.width,
+                    .height = level.dimensions.height,
+                    .depth = level.dimensions.depth,
+                    .gobBlockHeight = static_cast<u32>(levelCount == 1 ? guest->tileConfig.blockHeight : level.blockHeight),
+                    .gobBlockDepth = static_cast<u32>(levelCount == 1 ? guest->tileConfig.blockDepth : level.blockDepth),
+                });
+
+                inputLevel += level.blockLinearSize;
+                outputLevel += layerCount * level.targetLinearSize;
+            }
         }
 
         return stagingBuffer;
@@ -423,7 +682,10 @@ namespace skyline::gpu {
             );
         }
 
-        auto bufferImageCopies{GetBufferImageCopies()};
+        if (gpuDecode)
+            gpu.helperShaders.textureDecodeHelperShader.RecordDecode(commandBuffer, *gpuDecode);
+
+        auto bufferImageCopies{pendingBufferImageCopies.empty() ? GetBufferImageCopies() : std::exchange(pendingBufferImageCopies, {})};
         commandBuffer.copyBufferToImage(stagingBuffer->vkBuffer, image, layout, vk::ArrayProxy(static_cast<u32>(bufferImageCopies.size()), bufferImageCopies.data()));
     }
 
@@ -484,12 +746,20 @@ namespace skyline::gpu {
         auto guestOutput{mirror.data()};
 
         auto guestLayerStride{guest->GetLayerStride()};
+        auto tilingToken{gpu.tilingPool.CreateToken(surfaceSize)};
         if (levelCount == 1) {
             for (size_t layer{}; layer < layerCount; layer++) {
                 if (guest->tileConfig.mode == texture::TileMode::Block)
-                    texture::CopyLinearToBlockLinear(*guest, hostBuffer, guestOutput);
+                    gpu.tilingPool.CopyLinearToBlockLinear(
+                        tilingToken, guest->dimensions,
+                        guest->format->blockWidth, guest->format->blockHeight, guest->format->bpb,
+                        guest->tileConfig.blockHeight, guest->tileConfig.blockDepth,
+                        hostBuffer, guestOutput
+                    );
                 else if (guest->tileConfig.mode == texture::TileMode::Pitch)
-                    texture::CopyLinearToPitchLinear(*guest, hostBuffer, guestOutput);
+                    gpu.tilingPool.Submit(tilingToken, [&guestTexture = *guest, hostBuffer, guestOutput] {
+                        texture::CopyLinearToPitchLinear(guestTexture, hostBuffer, guestOutput);
+                    });
                 else if (guest->tileConfig.mode == texture::TileMode::Linear)
                     std::memcpy(hostBuffer, guestOutput, layerStride);
                 guestOutput += guestLayerStride;
@@ -501,8 +771,8 @@ namespace skyline::gpu {
             for (size_t layer{}; layer < layerCount; layer++) {
                 auto outputLevel{guestOutput}, inputLevel{hostBuffer};
                 for (const auto &level : mipLayouts) {
-                    texture::CopyLinearToBlockLinear(
-                        level.dimensions,
+                    gpu.tilingPool.CopyLinearToBlockLinear(
+                        tilingToken, level.dimensions,
                         guest->format->blockWidth, guest->format->blockHeight, guest->format->bpb,
                         level.blockHeight, level.blockDepth,
                         inputLevel + (layer * level.linearSize), outputLevel
@@ -517,6 +787,8 @@ namespace skyline::gpu {
         } else if (levelCount != 0) {
             throw exception("Mipmapped textures with tiling mode '{}' aren't supported", static_cast<int>(tiling));
         }
+
+        tilingToken.Wait();
     }
 
     void Texture::FreeGuest() {
@@ -542,7 +814,7 @@ namespace skyline::gpu {
 
     texture::Format ConvertHostCompatibleFormat(texture::Format format, const TraitManager &traits) {
         auto bcnSupport{traits.bcnSupport};
-        if (bcnSupport.all())
+        if (bcnSupport.all() && traits.supportsAstcLdr)
             return format;
 
         switch (format->vkFormat) {
@@ -551,10 +823,11 @@ namespace skyline::gpu {
             case vk::Format::eBc1RgbaSrgbBlock:
                 return bcnSupport[0] ? format : format::R8G8B8A8Srgb;
 
+            // BC2 is transcoded into BC3 rather than decoded when possible as they share color blocks and BC3 alpha can represent BC2 alpha exactly in most blocks
             case vk::Format::eBc2UnormBlock:
-                return bcnSupport[1] ? format : format::R8G8B8A8Unorm;
+                return bcnSupport[1] ? format : (bcnSupport[2] ? format::BC3Unorm : format::R8G8B8A8Unorm);
             case vk::Format::eBc2SrgbBlock:
-                return bcnSupport[1] ? format : format::R8G8B8A8Srgb;
+                return bcnSupport[1] ? format : (bcnSupport[2] ? format::BC3Srgb : format::R8G8B8A8Srgb);
 
             case vk::Format::eBc3UnormBlock:
                 return bcnSupport[2] ? format : format::R8G8B8A8Unorm;
@@ -580,25 +853,42 @@ namespace skyline::gpu {
             case vk::Format::eBc7SrgbBlock:
                 return bcnSupport[6] ? format : format::R8G8B8A8Srgb;
 
+            case vk::Format::eAstc4x4UnormBlock:
+            case vk::Format::eAstc5x4UnormBlock:
+            case vk::Format::eAstc5x5UnormBlock:
+            case vk::Format::eAstc6x5UnormBlock:
+            case vk::Format::eAstc6x6UnormBlock:
+            case vk::Format::eAstc8x5UnormBlock:
+            case vk::Format::eAstc8x6UnormBlock:
+            case vk::Format::eAstc8x8UnormBlock:
+            case vk::Format::eAstc10x5UnormBlock:
+            case vk::Format::eAstc10x6UnormBlock:
+            case vk::Format::eAstc10x8UnormBlock:
+            case vk::Format::eAstc10x10UnormBlock:
+            case vk::Format::eAstc12x10UnormBlock:
+            case vk::Format::eAstc12x12UnormBlock:
+                return traits.supportsAstcLdr ? format : (bcnSupport[6] ? format::BC7Unorm : format::R8G8B8A8Unorm); // ASTC is transcoded into BC7 when possible as it's a quarter of the size of R8G8B8A8
+            case vk::Format::eAstc4x4SrgbBlock:
+            case vk::Format::eAstc5x4SrgbBlock:
+            case vk::Format::eAstc5x5SrgbBlock:
+            case vk::Format::eAstc6x5SrgbBlock:
+            case vk::Format::eAstc6x6SrgbBlock:
+            case vk::Format::eAstc8x5SrgbBlock:
+            case vk::Format::eAstc8x6SrgbBlock:
+            case vk::Format::eAstc8x8SrgbBlock:
+            case vk::Format::eAstc10x5SrgbBlock:
+            case vk::Format::eAstc10x6SrgbBlock:
+            case vk::Format::eAstc10x8SrgbBlock:
+            case vk::Format::eAstc10x10SrgbBlock:
+            case vk::Format::eAstc12x10SrgbBlock:
+            case vk::Format::eAstc12x12SrgbBlock:
+                return traits.supportsAstcLdr ? format : (bcnSupport[6] ? format::BC7Srgb : format::R8G8B8A8Srgb);
+
             default:
                 return format;
         }
     }
 
-    size_t CalculateLevelStride(const std::vector<texture::MipLevelLayout> &mipLayouts) {
-        size_t surfaceSize{};
-        for (const auto &level : mipLayouts)
-            surfaceSize += level.linearSize;
-        return surfaceSize;
-    }
-
-    size_t CalculateTargetLevelStride(const std::vector<texture::MipLevelLayout> &mipLayouts) {
-        size_t surfaceSize{};
-        for (const auto &level : mipLayouts)
-            surfaceSize += level.targetLinearSize;
-        return surfaceSize;
-    }
-
     Texture::Texture(GPU &pGpu, GuestTexture pGuest)
         : gpu(pGpu),
           guest(std::move(pGuest)),
@@ -610,17 +900,18 @@ namespace skyline::gpu {
           deswizzledLayerStride(static_cast<u32>(guest->format->GetSize(dimensions))),
           layerStride(format == guest->format ? deswizzledLayerStride : static_cast<u32>(format->GetSize(dimensions))),
           levelCount(guest->mipLevelCount),
-          mipLayouts(
-              texture::GetBlockLinearMipLayout(
+          blockLinearLayout(
+              texture::GetBlockLinearLayout(
                   guest->dimensions,
-                  guest->format->blockHeight, guest->format->blockWidth, guest->format->bpb,
-                  format->blockHeight, format->blockWidth, format->bpb,
+                  guest->format->blockWidth, guest->format->blockHeight, guest->format->bpb,
+                  format->blockWidth, format->blockHeight, format->bpb,
                   guest->tileConfig.blockHeight, guest->tileConfig.blockDepth,
                   guest->mipLevelCount
               )
           ),
-          deswizzledSurfaceSize(CalculateLevelStride(mipLayouts) * layerCount),
-          surfaceSize(format == guest->format ? deswizzledSurfaceSize : (CalculateTargetLevelStride(mipLayouts) * layerCount)),
+          mipLayouts(blockLinearLayout->mipLevels),
+          deswizzledSurfaceSize(blockLinearLayout->linearLayerSize * layerCount),
+          surfaceSize(format == guest->format ? deswizzledSurfaceSize : (blockLinearLayout->targetLinearLayerSize * layerCount)),
           sampleCount(vk::SampleCountFlagBits::e1),
           flags(gpu.traits.quirks.vkImageMutableFormatCostly ? vk::ImageCreateFlags{} : vk::ImageCreateFlagBits::eMutableFormat),
           usage(vk::ImageUsageFlagBits::eTransferSrc | vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled) {
@@ -718,6 +1009,7 @@ namespace skyline::gpu {
 
         backing = std::move(pBacking);
         layout = pLayout;
+        syncedPageHashes.clear();
         if (GetBacking())
             backingCondition.notify_all();
     }
@@ -772,6 +1064,7 @@ namespace skyline::gpu {
             if (gpuDirty && dirtyState == DirtyState::Clean) {
                 // If a texture is Clean then we can just transition it to being GPU dirty and retrap it
                 dirtyState = DirtyState::GpuDirty;
+                syncedPageHashes.clear();
                 gpu.state.process->trap.TrapRegions(*trapHandle, false);
                 FreeGuest();
                 return;
@@ -781,6 +1074,8 @@ namespace skyline::gpu {
 
             dirtyState = gpuDirty ? DirtyState::GpuDirty : DirtyState::Clean;
             gpu.state.process->trap.TrapRegions(*trapHandle, !gpuDirty); // Trap any future CPU reads (optionally) + writes to this texture
+            if (gpuDirty)
+                syncedPageHashes.clear(); // The GPU may write to the host texture after this synchronization, the hashes can't be relied on to reflect its contents
         }
 
         // From this point on Clean -> CPU dirty state transitions can occur, GPU dirty -> * transitions will always require the full lock to be held and thus won't occur
@@ -793,6 +1088,8 @@ namespace skyline::gpu {
                 CopyFromStagingBuffer(commandBuffer, stagingBuffer);
             })};
             lCycle->AttachObjects(stagingBuffer, shared_from_this());
+            if (gpuDecode)
+                lCycle->AttachObject(std::exchange(gpuDecode, nullptr));
             lCycle->ChainCycle(cycle);
             cycle = lCycle;
         }
@@ -818,6 +1115,7 @@ namespace skyline::gpu {
             std::scoped_lock lock{stateMutex};
             if (gpuDirty && dirtyState == DirtyState::Clean) {
                 dirtyState = DirtyState::GpuDirty;
+                syncedPageHashes.clear();
                 gpu.state.process->trap.TrapRegions(*trapHandle, false);
                 FreeGuest();
                 return;
@@ -827,12 +1125,16 @@ namespace skyline::gpu {
 
             dirtyState = gpuDirty ? DirtyState::GpuDirty : DirtyState::Clean;
             gpu.state.process->trap.TrapRegions(*trapHandle, !gpuDirty); // Trap any future CPU reads (optionally) + writes to this texture
+            if (gpuDirty)
+                syncedPageHashes.clear(); // The GPU may write to the host texture after this synchronization, the hashes can't be relied on to reflect its contents
         }
 
         auto stagingBuffer{SynchronizeHostImpl()};
         if (stagingBuffer) {
             CopyFromStagingBuffer(commandBuffer, stagingBuffer);
             pCycle->AttachObjects(stagingBuffer, shared_from_this());
+            if (gpuDecode)
+                pCycle->AttachObject(std::exchange(gpuDecode, nullptr));
             pCycle->ChainCycle(cycle);
             cycle = pCycle;
         }
@@ -923,6 +1225,8 @@ namespace skyline::gpu {
     }
 
     void Texture::CopyFrom(std::shared_ptr<Texture> source, vk::Semaphore waitSemaphore, vk::Semaphore signalSemaphore, texture::Format srcFormat, const vk::ImageSubresourceRange &subresource) {
+        syncedPageHashes.clear(); // The host texture will no longer match the guest texture after the copy
+
         if (cycle)
             cycle->WaitSubmit();
         if (source->cycle)
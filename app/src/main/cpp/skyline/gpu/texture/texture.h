@@ -13,6 +13,7 @@
 #include <gpu/stage_mask.h>
 #include <vulkan/vulkan_format_traits.hpp>
 #include <gpu/usage_tracker.h>
+#include <gpu/shaders/helper_shaders.h>
 
 namespace skyline::gpu {
     namespace texture {
@@ -230,6 +231,9 @@ namespace skyline::gpu {
 
             constexpr MipLevelLayout(Dimensions dimensions, size_t linearSize, size_t targetLinearSize, size_t blockLinearSize, size_t blockHeight, size_t blockDepth) : dimensions{dimensions}, linearSize{linearSize}, targetLinearSize{targetLinearSize}, blockLinearSize{blockLinearSize}, blockHeight{blockHeight}, blockDepth{blockDepth} {}
         };
+
+        struct BlockLinearLayout;
+        struct SubresourceRegion;
     }
 
     class Texture;
@@ -297,6 +301,12 @@ namespace skyline::gpu {
          */
         u32 CalculateLayerSize() const;
 
+        /**
+         * @note Requires `dimensions`, `format`, `tileConfig` and `mipLevelCount` to be filled in, the tiling mode must be block-linear for the layout to be meaningful
+         * @return The shared layout of the guest texture in its own format
+         */
+        std::shared_ptr<const texture::BlockLinearLayout> GetBlockLinearLayout() const;
+
         /**
          * @return The most appropriate backing image type for this texture
          */
@@ -411,6 +421,12 @@ namespace skyline::gpu {
         std::vector<TextureViewStorage> views;
 
         std::shared_ptr<memory::StagingBuffer> downloadStagingBuffer{};
+        std::shared_ptr<TextureDecodeHelperShader::DecodeState> gpuDecode{}; //!< A pending GPU deswizzle/decode into the staging buffer returned by SynchronizeHostImpl, it's recorded prior to copying the staging buffer and must then be attached to the cycle
+
+        static constexpr size_t DirtyTrackingGranularity{constant::PageSize}; //!< The granularity at which modifications to the guest texture are detected for partial synchronization
+        std::vector<u64> syncedPageHashes; //!< Hashes of every page of the mirror as of the last guest -> host synchronization, this is empty if the host texture can't be assumed to match them
+        bool hostSynchronized{}; //!< If the host texture has been synchronized from the guest before, page hashes are only tracked for textures which are synchronized repeatedly
+        boost::container::small_vector<vk::BufferImageCopy, 10> pendingBufferImageCopies; //!< Copies of dirty regions from the staging buffer returned by SynchronizeHostImpl, these are used instead of GetBufferImageCopies() if present
 
         u32 lastRenderPassIndex{}; //!< The index of the last render pass that used this texture
         texture::RenderPassUsage lastRenderPassUsage{texture::RenderPassUsage::None}; //!< The type of usage in the last render pass
@@ -432,8 +448,28 @@ namespace skyline::gpu {
          */
         std::shared_ptr<memory::StagingBuffer> SynchronizeHostImpl();
 
+        /**
+         * @brief Determines the regions of the guest texture which were modified since the last guest -> host synchronization by comparing the hashes of every page
+         * @param regions The modified regions, this is empty if the texture is unmodified
+         * @return If the texture can be partially synchronized with the supplied regions rather than being synchronized in its entirety
+         */
+        bool GetDirtyRegions(std::vector<texture::SubresourceRegion> &regions);
+
+        /**
+         * @brief Deswizzles the supplied regions of the guest texture into a staging buffer and sets up copies of them into the host texture
+         * @return A staging buffer containing all regions which is consumed by CopyFromStagingBuffer
+         */
+        std::shared_ptr<memory::StagingBuffer> SynchronizeHostRegions(span<const texture::SubresourceRegion> regions);
+
+        /**
+         * @brief Prepares a deswizzle and/or decode of the guest texture on the GPU if it's enabled and supported for the texture, this only copies the raw guest texture on the CPU
+         * @return A staging buffer that will be filled by the GPU decode or nullptr if the texture must be synchronized on the CPU
+         */
+        std::shared_ptr<memory::StagingBuffer> PrepareGpuDecode();
+
         /**
          * @brief Records commands for copying data from a staging buffer to the texture's backing into the supplied command buffer
+         * @note If a GPU decode is pending then it'll be recorded prior to the copy
          */
         void CopyFromStagingBuffer(const vk::raii::CommandBuffer &commandBuffer, const std::shared_ptr<memory::StagingBuffer> &stagingBuffer);
 
@@ -483,7 +519,8 @@ namespace skyline::gpu {
         size_t deswizzledLayerStride{}; //!< The stride of a single layer given linear tiling using the guest format, this does **not** consider mipmapping
         size_t layerStride{}; //!< The stride of a single layer given linear tiling, this does **not** consider mipmapping
         u32 levelCount;
-        std::vector<texture::MipLevelLayout> mipLayouts; //!< The layout of each mip level in the guest texture
+        std::shared_ptr<const texture::BlockLinearLayout> blockLinearLayout; //!< The shared layout of the guest texture when decoded into the host format, this is null for textures without a guest
+        span<const texture::MipLevelLayout> mipLayouts; //!< The layout of each mip level in the guest texture, this points into `blockLinearLayout`
         size_t deswizzledSurfaceSize{}; //!< The size of the guest surface with linear tiling, calculated with the guest format which may differ from the host format
         size_t surfaceSize{}; //!< The size of the entire surface given linear tiling, this contains all mip levels and layers
         vk::SampleCountFlagBits sampleCount;
@@ -0,0 +1,86 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2024 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include "tiling_pool.h"
+#include "gob_kernels.h"
+#include "layout.h"
+
+namespace skyline::gpu::texture {
+    TilingPool::Token::~Token() {
+        // Jobs reference buffers owned by the caller so we cannot let them outlive the token, even when unwinding
+        for (auto &future : futures)
+            if (future.valid())
+                future.wait();
+    }
+
+    void TilingPool::Token::Wait() {
+        for (auto &future : futures)
+            future.wait();
+
+        auto pending{std::move(futures)};
+        for (auto &future : pending)
+            future.get(); // Rethrows any exception from the job
+    }
+
+    /**
+     * @return The amount of workers to use for tiling, this leaves some cores free for the guest and GPFIFO threads
+     */
+    static u32 GetTilingWorkerCount() {
+        return std::max(std::thread::hardware_concurrency() / 2, 1U);
+    }
+
+    TilingPool::TilingPool() : pool{GetTilingWorkerCount()} {}
+
+    TilingPool::Token TilingPool::CreateToken(size_t surfaceSize) {
+        return Token{surfaceSize >= ParallelThreshold && pool.get_thread_count() > 1};
+    }
+
+    template<bool BlockLinearToLinear>
+    void TilingPool::SubmitBlockLinearCopy(Token &token, Dimensions dimensions,
+                                           size_t formatBlockWidth, size_t formatBlockHeight, size_t formatBpb,
+                                           size_t gobBlockHeight, size_t gobBlockDepth,
+                                           u8 *blockLinear, u8 *linear) {
+        auto copy{[=](Dimensions copyDimensions, u8 *copyBlockLinear, u8 *copyLinear) {
+            if constexpr (BlockLinearToLinear)
+                texture::CopyBlockLinearToLinear(copyDimensions, formatBlockWidth, formatBlockHeight, formatBpb, gobBlockHeight, gobBlockDepth, copyBlockLinear, copyLinear);
+            else
+                texture::CopyLinearToBlockLinear(copyDimensions, formatBlockWidth, formatBlockHeight, formatBpb, gobBlockHeight, gobBlockDepth, copyLinear, copyBlockLinear);
+        }};
+
+        size_t linearLineBytes{util::DivideCeil<size_t>(dimensions.width, formatBlockWidth) * formatBpb};
+        size_t robLines{gob::Height * gobBlockHeight}; //!< The height of a single ROB in lines of format blocks
+        size_t robSize{util::AlignUp(linearLineBytes, gob::Width) * robLines * gobBlockDepth}; //!< The size of a single ROB in the block-linear surface
+        size_t surfaceLines{util::DivideCeil<size_t>(dimensions.height, formatBlockHeight)};
+        size_t robCount{util::DivideCeil(surfaceLines, robLines)};
+
+        // The linear layout of 3D surfaces interleaves slices so only 2D surfaces can be split into ROB ranges
+        if (!token.parallel || dimensions.depth != 1 || robCount < 2 || robSize * robCount < MinimumJobSize * 2) {
+            Submit(token, [=] { copy(dimensions, blockLinear, linear); });
+            return;
+        }
+
+        size_t robsPerJob{std::max(util::DivideCeil(MinimumJobSize, robSize), util::DivideCeil<size_t>(robCount, pool.get_thread_count()))};
+        for (size_t rob{}; rob < robCount; rob += robsPerJob) {
+            size_t firstLine{rob * robLines};
+            Dimensions jobDimensions{dimensions.width, static_cast<u32>(std::min((rob + robsPerJob) * robLines, surfaceLines) - firstLine) * static_cast<u32>(formatBlockHeight), 1};
+            if (rob + robsPerJob >= robCount)
+                jobDimensions.height = dimensions.height - static_cast<u32>(firstLine * formatBlockHeight); // Retain the exact height of the last job rather than the block aligned one
+
+            Submit(token, [=] { copy(jobDimensions, blockLinear + (rob * robSize), linear + (firstLine * linearLineBytes)); });
+        }
+    }
+
+    void TilingPool::CopyBlockLinearToLinear(Token &token, Dimensions dimensions,
+                                             size_t formatBlockWidth, size_t formatBlockHeight, size_t formatBpb,
+                                             size_t gobBlockHeight, size_t gobBlockDepth,
+                                             u8 *blockLinear, u8 *linear) {
+        SubmitBlockLinearCopy<true>(token, dimensions, formatBlockWidth, formatBlockHeight, formatBpb, gobBlockHeight, gobBlockDepth, blockLinear, linear);
+    }
+
+    void TilingPool::CopyLinearToBlockLinear(Token &token, Dimensions dimensions,
+                                             size_t formatBlockWidth, size_t formatBlockHeight, size_t formatBpb,
+                                             size_t gobBlockHeight, size_t gobBlockDepth,
+                                             u8 *linear, u8 *blockLinear) {
+        SubmitBlockLinearCopy<false>(token, dimensions, formatBlockWidth, formatBlockHeight, formatBpb, gobBlockHeight, gobBlockDepth, blockLinear, linear);
+    }
+}
@@ -0,0 +1,108 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2024 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include <future>
+#include <BS_thread_pool.hpp>
+#include "texture.h"
+
+namespace skyline::gpu::texture {
+    /**
+     * @brief A pool of workers which texture tiling (swizzling/deswizzling) and decoding work for large surfaces is split across
+     * @note Work is split per subresource (layer/mip level) and subresources that are large enough are further split into ranges of ROBs (Rows of Blocks)
+     */
+    class TilingPool {
+      public:
+        static constexpr size_t ParallelThreshold{0x100000}; //!< The minimum size of a surface in bytes for it to be tiled on the pool rather than on the calling thread
+        static constexpr size_t MinimumJobSize{0x40000}; //!< The minimum size of a ROB range job in bytes, subresources smaller than this are never split
+
+        /**
+         * @brief A completion token for a set of jobs submitted to the pool, jobs are executed inline when the token isn't parallel
+         */
+        class Token {
+          private:
+            friend TilingPool;
+            std::vector<std::future<void>> futures;
+            bool parallel;
+
+          public:
+            Token(bool parallel) : parallel{parallel} {}
+
+            Token(const Token &) = delete;
+
+            Token &operator=(const Token &) = delete;
+
+            ~Token();
+
+            /**
+             * @brief Blocks till all jobs associated with the token have completed, any exceptions thrown by jobs are rethrown
+             */
+            void Wait();
+        };
+
+      private:
+        BS::thread_pool<BS::tp::none> pool;
+
+        /**
+         * @brief Splits a copy of a single block-linear subresource into ROB range jobs and submits them
+         */
+        template<bool BlockLinearToLinear>
+        void SubmitBlockLinearCopy(Token &token, Dimensions dimensions,
+                                   size_t formatBlockWidth, size_t formatBlockHeight, size_t formatBpb,
+                                   size_t gobBlockHeight, size_t gobBlockDepth,
+                                   u8 *blockLinear, u8 *linear);
+
+      public:
+        TilingPool();
+
+        /**
+         * @return A token for tiling a surface of the supplied size, the token will only be parallel if the surface is large enough to benefit from it
+         */
+        Token CreateToken(size_t surfaceSize);
+
+        /**
+         * @brief Submits a copy of a subresource of a block-linear texture to a linear buffer, this has the same semantics as texture::CopyBlockLinearToLinear
+         * @note The buffers must stay valid till the token has been waited on
+         */
+        void CopyBlockLinearToLinear(Token &token, Dimensions dimensions,
+                                     size_t formatBlockWidth, size_t formatBlockHeight, size_t formatBpb,
+                                     size_t gobBlockHeight, size_t gobBlockDepth,
+                                     u8 *blockLinear, u8 *linear);
+
+        /**
+         * @brief Submits a copy of a linear buffer to a subresource of a block-linear texture, this has the same semantics as texture::CopyLinearToBlockLinear
+         * @note The buffers must stay valid till the token has been waited on
+         */
+        void CopyLinearToBlockLinear(Token &token, Dimensions dimensions,
+                                     size_t formatBlockWidth, size_t formatBlockHeight, size_t formatBpb,
+                                     size_t gobBlockHeight, size_t gobBlockDepth,
+                                     u8 *linear, u8 *blockLinear);
+
+        /**
+         * @brief Splits the decoding of an image into ranges of block rows and submits each range as a job
+         * @param rowSize The size of a single decoded row of blocks in bytes, this is used to determine the amount of rows in each job
+         * @param job A functor which decodes a range of rows, it is supplied the index of the first row and the amount of rows
+         */
+        template<typename Job>
+        void SubmitBlockRows(Token &token, size_t blockRows, size_t rowSize, Job &&job) {
+            size_t rowsPerJob{blockRows};
+            if (token.parallel)
+                rowsPerJob = std::max(util::DivideCeil(MinimumJobSize, rowSize), util::DivideCeil<size_t>(blockRows, pool.get_thread_count()));
+
+            for (size_t row{}; row < blockRows; row += rowsPerJob)
+                Submit(token, [job, row, rowCount = std::min(rowsPerJob, blockRows - row)] { job(row, rowCount); });
+        }
+
+        /**
+         * @brief Submits an arbitrary job that is part of tiling a surface (such as a pitch-linear layer copy) or runs it on the calling thread if the token isn't parallel
+         */
+        template<typename Job>
+        void Submit(Token &token, Job &&job) {
+            if (token.parallel)
+                token.futures.emplace_back(pool.submit_task(std::forward<Job>(job)));
+            else
+                job();
+        }
+    };
+}
@@ -74,6 +74,7 @@ namespace skyline::gpu {
                 if (matchGuestTexture.format->IsCompatible(*guestTexture.format) && matchGuestTexture.tileConfig == guestTexture.tileConfig &&
                         (!layerMipMatch || (matchGuestTexture.GetViewLayerCount() >= layerMipMatch->guest->GetViewLayerCount() && matchGuestTexture.mipLevelCount >= layerMipMatch->guest->mipLevelCount))) {
                     size_t memOffset{static_cast<size_t>(guestMapping.data() - hostMapping->texture->guest->mappings.front().data())};
+                    size_t guestLayerSize{guestTexture.CalculateLayerSize()};
                     size_t layerMemOffset{};
                     bool matched{};
                     for (u32 layer{}; layer < hostMapping->texture->layerCount; layer++) {
@@ -82,7 +83,7 @@ namespace skyline::gpu {
 
                         for (auto &mipLevel : hostMapping->texture->mipLayouts) {
                             if (layerMemOffset + levelMemOffset == memOffset) {
-                                if (mipLevel.blockLinearSize == guestTexture.CalculateLayerSize()) {
+                                if (mipLevel.blockLinearSize == guestLayerSize) {
                                     matched = true;
                                     matchLayer = layer;
                                     matchLevel = level;
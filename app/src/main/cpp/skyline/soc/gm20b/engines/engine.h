@@ -118,7 +118,10 @@ namespace skyline::soc::gm20b::engine {
             throw exception("DrawIndexedInstanced is not implemented for this engine");
         }
 
-        virtual void DrawIndexedIndirect(u32 drawTopology, span<u8> indirectBuffer, u32 count, u32 stride) {
+        /**
+         * @return If the draw was performed, if this is false the draw can't be done with GPU-side parameters and the caller must read them back and perform it directly
+         */
+        virtual bool DrawIndexedIndirect(u32 drawTopology, span<u8> indirectBuffer, u32 count, u32 stride) {
             throw exception("DrawIndexedIndirect is not implemented for this engine");
         }
 
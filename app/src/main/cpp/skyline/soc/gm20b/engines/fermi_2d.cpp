@@ -80,4 +80,18 @@ namespace skyline::soc::gm20b::engine::fermi2d {
 
         HandleMethod(method, argument);
     }
+
+    void Fermi2D::CallMethodBatch(u32 method, span<u32> arguments) {
+        for (u32 argument : arguments) {
+            LOGV("Called method in Fermi 2D: 0x{:X} args: 0x{:X}", method, argument);
+            HandleMethod(method++, argument);
+        }
+    }
+
+    void Fermi2D::CallMethodBatchNonInc(u32 method, span<u32> arguments) {
+        for (u32 argument : arguments) {
+            LOGV("Called method in Fermi 2D: 0x{:X} args: 0x{:X}", method, argument);
+            HandleMethod(method, argument);
+        }
+    }
 }
@@ -93,5 +93,9 @@ namespace skyline::soc::gm20b::engine::fermi2d {
         u32 ReadMethodFromMacro(u32 method) override;
 
         void CallMethod(u32 method, u32 argument);
+
+        void CallMethodBatch(u32 method, span<u32> arguments);
+
+        void CallMethodBatchNonInc(u32 method, span<u32> arguments);
     };
 }
@@ -34,7 +34,7 @@ namespace skyline::soc::gm20b::engine {
             gpu::texture::Dimensions srcDimensions{state.lineLengthIn, state.lineCount, state.dstDepth};
 
             gpu::texture::Dimensions dstDimensions{state.dstWidth, state.dstHeight, state.dstDepth};
-            size_t dstSize{GetBlockLinearLayerSize(dstDimensions, 1, 1, 1, 1 << (u8)state.dstBlockSize.height, 1 << (u8)state.dstBlockSize.depth)};
+            size_t dstSize{GetBlockLinearLayout(dstDimensions, 1, 1, 1, 0, 0, 0, 1 << (u8)state.dstBlockSize.height, 1 << (u8)state.dstBlockSize.depth, 1)->layerSize};
 
             auto dstMappings{channelCtx.asCtx->gmmu.TranslateRange(state.offsetOut, dstSize)};
 
@@ -114,6 +114,13 @@ namespace skyline::soc::gm20b::engine {
 
     }
 
+    void Inline2Memory::CallMethodBatch(u32 method, span<u32> arguments) {
+        for (u32 argument : arguments) {
+            LOGV("Called method in I2M: 0x{:X} args: 0x{:X}", method, argument);
+            HandleMethod(method++, argument);
+        }
+    }
+
     void Inline2Memory::CallMethodBatchNonInc(u32 method, span<u32> arguments) {
         switch (method) {
             case ENGINE_STRUCT_OFFSET(i2m, loadInlineData):
@@ -123,7 +130,9 @@ namespace skyline::soc::gm20b::engine {
                 break;
         }
 
-        for (u32 argument : arguments)
+        for (u32 argument : arguments) {
+            LOGV("Called method in I2M: 0x{:X} args: 0x{:X}", method, argument);
             HandleMethod(method, argument);
+        }
     }
 }
@@ -155,6 +155,8 @@ namespace skyline::soc::gm20b::engine {
 
         void CallMethod(u32 method, u32 argument);
 
+        void CallMethodBatch(u32 method, span<u32> arguments);
+
         void CallMethodBatchNonInc(u32 method, span<u32> arguments);
     };
 }
@@ -49,6 +49,13 @@ namespace skyline::soc::gm20b::engine {
         }
     }
 
+    void KeplerCompute::CallMethodBatch(u32 method, span<u32> arguments) {
+        for (u32 argument : arguments) {
+            LOGV("Called method in Kepler compute: 0x{:X} args: 0x{:X}", method, argument);
+            HandleMethod(method++, argument);
+        }
+    }
+
     void KeplerCompute::CallMethodBatchNonInc(u32 method, span<u32> arguments) {
         switch (method) {
             case ENGINE_STRUCT_OFFSET(i2m, loadInlineData):
@@ -58,7 +65,9 @@ namespace skyline::soc::gm20b::engine {
                 break;
         }
 
-        for (u32 argument : arguments)
+        for (u32 argument : arguments) {
+            LOGV("Called method in Kepler compute: 0x{:X} args: 0x{:X}", method, argument);
             HandleMethod(method, argument);
+        }
     }
 }
@@ -114,12 +114,73 @@ namespace skyline::soc::gm20b::engine::maxwell3d {
         InitializeRegisters();
     }
 
-    __attribute__((always_inline)) void Maxwell3D::FlushDeferredDraw() {
-        if (batchEnableState.drawActive) {
-            batchEnableState.drawActive = false;
+    void Maxwell3D::FlushMultiDraw() {
+        if (batchEnableState.multiDrawActive) {
+            batchEnableState.multiDrawActive = false;
+            if (CheckRenderEnable()) {
+                if (multiDraw.draws.size() == 1) {
+                    const auto &draw{multiDraw.draws.front()};
+                    interconnect.Draw(multiDraw.drawTopology, false, multiDraw.indexed, draw.count, draw.first, 1, draw.vertexOffset, multiDraw.drawBaseInstance);
+                } else {
+                    interconnect.MultiDraw(multiDraw.drawTopology, multiDraw.indexed, multiDraw.draws, multiDraw.drawBaseInstance);
+                }
+            }
+            multiDraw.draws.clear();
+        }
+    }
+
+    __attribute__((always_inline)) void Maxwell3D::QueueDeferredDraw() {
+        batchEnableState.drawActive = false;
+
+        // Instanced draws, quads/quad strips/polygons (which require index buffer conversion) and transform feedback (which restarts capture for every draw) can't be merged
+        bool needsConversion{deferredDraw.drawTopology == type::DrawTopology::Quads || deferredDraw.drawTopology == type::DrawTopology::QuadStrip || deferredDraw.drawTopology == type::DrawTopology::Polygon};
+        if (deferredDraw.instanceCount == 1 && !needsConversion && !*registers.streamOutputEnable) {
+            if (batchEnableState.multiDrawActive && !multiDraw.IsCompatible(deferredDraw))
+                FlushMultiDraw();
+
+            if (!batchEnableState.multiDrawActive) {
+                multiDraw.indexed = deferredDraw.indexed;
+                multiDraw.drawTopology = deferredDraw.drawTopology;
+                multiDraw.drawBaseInstance = deferredDraw.drawBaseInstance;
+                batchEnableState.multiDrawActive = true;
+            }
+
+            multiDraw.draws.push_back({deferredDraw.drawCount, deferredDraw.drawFirst, deferredDraw.drawBaseVertex});
+            if (multiDraw.draws.size() == MultiDrawState::MaxDrawCount)
+                FlushMultiDraw();
+        } else {
+            FlushMultiDraw();
             if (CheckRenderEnable())
                 interconnect.Draw(deferredDraw.drawTopology, *registers.streamOutputEnable, deferredDraw.indexed, deferredDraw.drawCount, deferredDraw.drawFirst, deferredDraw.instanceCount, deferredDraw.drawBaseVertex, deferredDraw.drawBaseInstance);
-            deferredDraw.instanceCount = 1;
+        }
+
+        deferredDraw.instanceCount = 1;
+    }
+
+    __attribute__((always_inline)) void Maxwell3D::FlushDeferredDraw() {
+        if (batchEnableState.drawActive)
+            QueueDeferredDraw();
+
+        FlushMultiDraw();
+    }
+
+    bool Maxwell3D::IsDrawParameterMethod(u32 method) {
+        switch (method) {
+            case ENGINE_OFFSET(vertexArrayStart):
+            case ENGINE_STRUCT_OFFSET(indexBuffer, first):
+            case ENGINE_OFFSET(globalBaseVertexIndex):
+            case ENGINE_OFFSET(begin):
+            case ENGINE_OFFSET(end):
+            case ENGINE_OFFSET(drawVertexArray):
+            case ENGINE_OFFSET(drawIndexBuffer):
+            case ENGINE_OFFSET(drawVertexArrayBeginEndInstanceFirst):
+            case ENGINE_OFFSET(drawIndexBuffer32BeginEndInstanceFirst):
+            case ENGINE_OFFSET(drawIndexBuffer16BeginEndInstanceFirst):
+            case ENGINE_OFFSET(drawIndexBuffer8BeginEndInstanceFirst):
+                return true;
+
+            default:
+                return false;
         }
     }
 
@@ -173,7 +234,7 @@ namespace skyline::soc::gm20b::engine::maxwell3d {
 
                             deferredDraw.instanceCount++;
                         } else {
-                            FlushDeferredDraw();
+                            QueueDeferredDraw();
                             break; // This instanced draw is finished, continue on to handle the next draw
                         }
 
@@ -218,10 +279,18 @@ namespace skyline::soc::gm20b::engine::maxwell3d {
                     // Once we stop calling draw methods flush the current draw since drawing is dependent on the register state not changing
                     default:
                         registers.raw[method] = origRegisterValue;
-                        FlushDeferredDraw();
+                        if (IsDrawParameterMethod(method))
+                            QueueDeferredDraw(); // The next draw is being set up, it may be merged with this one (see MultiDrawState comment)
+                        else
+                            FlushDeferredDraw();
                         registers.raw[method] = argument;
                         break;
                 }
+            } else if (batchEnableState.multiDrawActive && !IsDrawParameterMethod(method)) {
+                // Any state change between draws requires the queued draws to be submitted beforehand
+                registers.raw[method] = origRegisterValue;
+                FlushMultiDraw();
+                registers.raw[method] = argument;
             }
         }
 
@@ -505,6 +574,13 @@ namespace skyline::soc::gm20b::engine::maxwell3d {
         HandleMethod(method, argument);
     }
 
+    void Maxwell3D::CallMethodBatch(u32 method, span<u32> arguments) {
+        for (u32 argument : arguments) {
+            LOGV("Called method in Maxwell 3D: 0x{:X} args: 0x{:X}", method, argument);
+            HandleMethod(method++, argument);
+        }
+    }
+
     void Maxwell3D::CallMethodBatchNonInc(u32 method, span<u32> arguments) {
         switch (method) {
             case ENGINE_STRUCT_OFFSET(i2m, loadInlineData):
@@ -514,8 +590,10 @@ namespace skyline::soc::gm20b::engine::maxwell3d {
                 break;
         }
 
-        for (u32 argument : arguments)
+        for (u32 argument : arguments) {
+            LOGV("Called method in Maxwell 3D: 0x{:X} args: 0x{:X}", method, argument);
             HandleMethod(method, argument);
+        }
     }
 
     void Maxwell3D::CallMethodFromMacro(u32 method, u32 argument) {
@@ -544,11 +622,12 @@ namespace skyline::soc::gm20b::engine::maxwell3d {
             interconnect.Draw(topology, *registers.streamOutputEnable, true, indexBufferCount, indexBufferFirst, instanceCount, globalBaseVertexIndex, globalBaseInstanceIndex);
     }
 
-    void Maxwell3D::DrawIndexedIndirect(u32 drawTopology, span<u8> indirectBuffer, u32 count, u32 stride) {
+    bool Maxwell3D::DrawIndexedIndirect(u32 drawTopology, span<u8> indirectBuffer, u32 count, u32 stride) {
         FlushEngineState();
         auto topology{static_cast<type::DrawTopology>(drawTopology)};
         if (CheckRenderEnable())
-            interconnect.DrawIndirect(topology, *registers.streamOutputEnable, true, indirectBuffer, count, stride);
+            return interconnect.DrawIndirect(topology, *registers.streamOutputEnable, true, indirectBuffer, count, stride);
+        return true;
     }
 
 }
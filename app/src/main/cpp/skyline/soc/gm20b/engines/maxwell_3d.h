@@ -32,6 +32,7 @@ namespace skyline::soc::gm20b::engine::maxwell3d {
             struct {
                 bool constantBufferActive : 1;
                 bool drawActive : 1;
+                bool multiDrawActive : 1;
             };
         } batchEnableState{};
 
@@ -69,12 +70,49 @@ namespace skyline::soc::gm20b::engine::maxwell3d {
             }
         } deferredDraw{};
 
+        /**
+         * @brief Consecutive non-instanced draws are often only separated by writes to their own parameters (start vertex, first index and base vertex), rather than submitting each of these separately we queue them up and submit them together as a single multi-draw once any other state changes
+         */
+        struct MultiDrawState {
+            static constexpr size_t MaxDrawCount{1024}; //!< The minimum value of 'maxMultiDrawCount' guaranteed by VK_EXT_multi_draw
+
+            bool indexed; //!< If the queued draws are indexed
+            type::DrawTopology drawTopology; //!< Topology shared by all queued draws
+            u32 drawBaseInstance; //!< Base instance shared by all queued draws
+            std::vector<gpu::interconnect::maxwell3d::Maxwell3D::MultiDrawEntry> draws;
+
+            /**
+             * @return If the given deferred draw can be merged into the queued draws
+             */
+            bool IsCompatible(const DeferredDrawState &draw) const {
+                return indexed == draw.indexed && drawTopology == draw.drawTopology && drawBaseInstance == draw.drawBaseInstance;
+            }
+        } multiDraw{};
+
         bool CheckRenderEnable();
 
         type::DrawTopology ApplyTopologyOverride(type::DrawTopology beginMethodTopology);
 
+        /**
+         * @brief Submits all draws queued in the multi-draw state
+         */
+        void FlushMultiDraw();
+
+        /**
+         * @brief Ends the current deferred draw, queueing it to be merged with subsequent draws if possible or submitting it directly otherwise
+         */
+        void QueueDeferredDraw();
+
+        /**
+         * @brief Submits the current deferred draw along with any queued draws
+         */
         void FlushDeferredDraw();
 
+        /**
+         * @return If the method only sets a parameter of the next draw or begins a new draw, these don't affect any state used by queued draws so they don't require them to be flushed
+         */
+        static bool IsDrawParameterMethod(u32 method);
+
         /**
          * @brief Calls the appropriate function corresponding to a certain method with the supplied argument
          */
@@ -478,6 +516,8 @@ namespace skyline::soc::gm20b::engine::maxwell3d {
 
         void CallMethod(u32 method, u32 argument);
 
+        void CallMethodBatch(u32 method, span<u32> arguments);
+
         void CallMethodBatchNonInc(u32 method, span<u32> arguments);
 
         void CallMethodFromMacro(u32 method, u32 argument) override;
@@ -488,6 +528,6 @@ namespace skyline::soc::gm20b::engine::maxwell3d {
 
         void DrawIndexedInstanced(u32 drawTopology, u32 indexBufferCount, u32 instanceCount, u32 globalBaseVertexIndex, u32 indexBufferFirst, u32 globalBaseInstanceIndex) override;
 
-        void DrawIndexedIndirect(u32 drawTopology, span<u8> indirectBuffer, u32 count, u32 stride) override;
+        bool DrawIndexedIndirect(u32 drawTopology, span<u8> indirectBuffer, u32 count, u32 stride) override;
     };
 }
@@ -150,7 +150,7 @@ namespace skyline::soc::gm20b::engine {
         }
 
         gpu::texture::Dimensions srcDimensions{registers.srcSurface->width, registers.srcSurface->height, registers.srcSurface->depth};
-        size_t srcLayerStride{gpu::texture::GetBlockLinearLayerSize(srcDimensions, 1, 1, 1, registers.srcSurface->blockSize.Height(), registers.srcSurface->blockSize.Depth())};
+        size_t srcLayerStride{gpu::texture::GetBlockLinearLayout(srcDimensions, 1, 1, 1, 0, 0, 0, registers.srcSurface->blockSize.Height(), registers.srcSurface->blockSize.Depth(), 1)->layerSize};
         size_t srcLayerAddress{*registers.offsetIn + (registers.srcSurface->layer * srcLayerStride)};
 
         // Get source address
@@ -203,7 +203,7 @@ namespace skyline::soc::gm20b::engine {
         auto srcMappings{channelCtx.asCtx->gmmu.TranslateRange(*registers.offsetIn, srcSize)};
 
         gpu::texture::Dimensions dstDimensions{registers.dstSurface->width, registers.dstSurface->height, registers.dstSurface->depth};
-        size_t dstLayerStride{gpu::texture::GetBlockLinearLayerSize(dstDimensions, 1, 1, 1, registers.dstSurface->blockSize.Height(), registers.dstSurface->blockSize.Depth())};
+        size_t dstLayerStride{gpu::texture::GetBlockLinearLayout(dstDimensions, 1, 1, 1, 0, 0, 0, registers.dstSurface->blockSize.Height(), registers.dstSurface->blockSize.Depth(), 1)->layerSize};
         size_t dstLayerAddress{*registers.offsetOut + (registers.dstSurface->layer * dstLayerStride)};
 
         // Get destination address
@@ -261,8 +261,17 @@ namespace skyline::soc::gm20b::engine {
         }
     }
 
+    void MaxwellDma::CallMethodBatch(u32 method, span<u32> arguments) {
+        for (u32 argument : arguments) {
+            LOGV("Called method in Maxwell DMA: 0x{:X} args: 0x{:X}", method, argument);
+            HandleMethod(method++, argument);
+        }
+    }
+
     void MaxwellDma::CallMethodBatchNonInc(u32 method, span<u32> arguments) {
-        for (u32 argument : arguments)
+        for (u32 argument : arguments) {
+            LOGV("Called method in Maxwell DMA: 0x{:X} args: 0x{:X}", method, argument);
             HandleMethod(method, argument);
+        }
     }
 }
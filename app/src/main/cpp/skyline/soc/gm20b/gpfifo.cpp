@@ -82,6 +82,105 @@ namespace skyline::soc::gm20b {
     };
     static_assert(sizeof(PushBufferMethodHeader) == sizeof(u32));
 
+    /**
+     * @brief An iterator over the entries of a pushbuffer that may be split across several host mappings, this allows processing it in-place without first copying it into a contiguous buffer
+     * @note The position of the iterator is tracked by the amount of entries remaining till the end of the pushbuffer, the end iterator is one with no remaining entries
+     */
+    class PushBufferIterator {
+      private:
+        const span<u8> *segment{}; //!< The mapping containing the current entry
+        u32 *current{}; //!< A pointer to the current entry
+        u32 *segmentEnd{}; //!< A pointer to the end of the current mapping
+        size_t remaining{}; //!< The amount of entries from the current one till the end of the pushbuffer
+
+        /**
+         * @brief Moves to the first entry of the next mapping, this must only be called when the current mapping has been exhausted
+         */
+        void NextSegment() {
+            auto entries{(++segment)->cast<u32>()};
+            current = entries.data();
+            segmentEnd = current + entries.size();
+        }
+
+      public:
+        using difference_type = ssize_t;
+        using value_type = u32;
+
+        PushBufferIterator() = default;
+
+        /**
+         * @param segments The mappings of the pushbuffer, all of these must be valid and a multiple of the entry size
+         * @param size The size of the pushbuffer in entries
+         */
+        PushBufferIterator(span<const span<u8>> segments, size_t size) : segment{segments.data()}, remaining{size} {
+            auto entries{segment->cast<u32>()};
+            current = entries.data();
+            segmentEnd = current + entries.size();
+        }
+
+        u32 &operator*() const {
+            return *current;
+        }
+
+        /**
+         * @return A pointer to the current entry, this is only valid for `ContiguousCount()` entries
+         */
+        u32 *base() const {
+            return current;
+        }
+
+        /**
+         * @return The amount of entries from the current one that are contiguous in host memory
+         */
+        size_t ContiguousCount() const {
+            return std::min(static_cast<size_t>(segmentEnd - current), remaining);
+        }
+
+        /**
+         * @return If the current entry is the last one in the pushbuffer
+         */
+        bool IsLast() const {
+            return remaining == 1;
+        }
+
+        PushBufferIterator &operator++() {
+            remaining--;
+            if (++current == segmentEnd && remaining) [[unlikely]]
+                NextSegment();
+            return *this;
+        }
+
+        PushBufferIterator operator++(int) {
+            auto copy{*this};
+            ++*this;
+            return copy;
+        }
+
+        PushBufferIterator &operator+=(size_t count) {
+            while (count) {
+                size_t step{std::min(count, static_cast<size_t>(segmentEnd - current))};
+                current += step;
+                remaining -= step;
+                count -= step;
+                if (current == segmentEnd && remaining)
+                    NextSegment();
+            }
+            return *this;
+        }
+
+        difference_type operator-(const PushBufferIterator &other) const {
+            return static_cast<difference_type>(other.remaining) - static_cast<difference_type>(remaining);
+        }
+
+        bool operator==(const PushBufferIterator &other) const {
+            return remaining == other.remaining;
+        }
+
+        auto operator<=>(const PushBufferIterator &other) const {
+            return other.remaining <=> remaining;
+        }
+    };
+
     ChannelGpfifo::ChannelGpfifo(const DeviceState &state, ChannelContext &channelCtx, size_t numEntries) :
         state(state),
         gpfifoEngine(state.soc->host1x.syncpoints, channelCtx),
@@ -133,6 +232,7 @@ namespace skyline::soc::gm20b {
                 break;
             case SubchannelId::Copy:
                 channelCtx.maxwellDma.CallMethod(method, argument);
+                break;
             case SubchannelId::TwoD:
                 channelCtx.fermi2D.CallMethod(method, argument);
                 break;
@@ -142,6 +242,31 @@ namespace skyline::soc::gm20b {
         }
     }
 
+    void ChannelGpfifo::SendPureBatch(u32 method, span<u32> arguments, SubchannelId subChannel) {
+        if (subChannel == SubchannelId::ThreeD) [[likely]] {
+            channelCtx.maxwell3D.CallMethodBatch(method, arguments);
+            return;
+        }
+
+        switch (subChannel) {
+            case SubchannelId::Compute:
+                channelCtx.keplerCompute.CallMethodBatch(method, arguments);
+                break;
+            case SubchannelId::Inline2Mem:
+                channelCtx.inline2Memory.CallMethodBatch(method, arguments);
+                break;
+            case SubchannelId::Copy:
+                channelCtx.maxwellDma.CallMethodBatch(method, arguments);
+                break;
+            case SubchannelId::TwoD:
+                channelCtx.fermi2D.CallMethodBatch(method, arguments);
+                break;
+            default:
+                LOGW("Called method 0x{:X} in unimplemented engine 0x{:X} with batch args", method, subChannel);
+                break;
+        }
+    }
+
     void ChannelGpfifo::SendPureBatchNonInc(u32 method, span<u32> arguments, SubchannelId subChannel) {
         switch (subChannel) {
             case SubchannelId::ThreeD:
@@ -156,6 +281,9 @@ namespace skyline::soc::gm20b {
             case SubchannelId::Copy:
                 channelCtx.maxwellDma.CallMethodBatchNonInc(method, arguments);
                 break;
+            case SubchannelId::TwoD:
+                channelCtx.fermi2D.CallMethodBatchNonInc(method, arguments);
+                break;
             default:
                 LOGW("Called method 0x{:X} in unimplemented engine 0x{:X} with batch args", method, subChannel);
                 break;
@@ -176,22 +304,12 @@ namespace skyline::soc::gm20b {
 
         auto pushBufferMappedRanges{channelCtx.asCtx->gmmu.TranslateRange(gpEntry.Address(), gpEntry.size * sizeof(u32))};
 
-        bool pushBufferCopied{}; //!< Set by the below lambda in order to track if the pushbuffer is a copy of guest memory or not
-        auto pushBuffer{[&]() -> span<u32> {
-            if (pushBufferMappedRanges.size() == 1) {
-                return pushBufferMappedRanges.front().cast<u32>();
-            } else {
-                // Create an intermediate copy of pushbuffer data if it's split across multiple mappings
-                pushBufferData.resize(gpEntry.size);
-                channelCtx.asCtx->gmmu.Read<u32>(pushBufferData, gpEntry.Address());
-                pushBufferCopied = true;
-                return span(pushBufferData);
-            }
-        }()};
-
         bool pushbufferDirty{false};
 
         for (auto range : pushBufferMappedRanges) {
+            if (!range.valid()) [[unlikely]]
+                throw exception("Page fault in pushbuffer at 0x{:X}", gpEntry.Address());
+
             if (channelCtx.executor.usageTracker.dirtyIntervals.Intersect(range)) {
                 if (skipDirtyFlushes)
                     pushbufferDirty = true;
@@ -200,170 +318,157 @@ namespace skyline::soc::gm20b {
             }
         }
 
-        // There will be at least one entry here
-        auto entry{pushBuffer.begin()};
+        // The pushbuffer is processed in-place even if it's split across multiple mappings, so arguments always point into guest memory
+        PushBufferIterator entry{span<const span<u8>>{pushBufferMappedRanges.data(), pushBufferMappedRanges.size()}, gpEntry.size}; // There will be at least one entry here
+        const PushBufferIterator end{};
 
-        auto getArgument{[&](){
-            return GpfifoArgument{pushBufferCopied ? *entry : 0, pushBufferCopied ? nullptr : entry.base(), pushbufferDirty};
+        /*
+         * Stage one: Decode the pushbuffer into runs of method calls
+         * Method headers for the whole GpEntry are decoded before any method is executed, this assumes the guest doesn't use methods to rewrite later parts of the same GpEntry which matches HW where the PBDMA prefetches pushbuffer contents ahead of execution
+         * Arguments aren't copied during decoding and are only read when the run is dispatched, so only the headers are affected by this
+         */
+        methodRuns.clear();
+        std::optional<PushBufferMethodHeader> unsupportedHeader; //!< An unsupported method header that ended decoding, this is only thrown on after all prior methods have been executed
+
+        /**
+         * @brief Appends the next `count` arguments in the pushbuffer as runs, they are broken up into multiple runs at mapping boundaries
+         * @param last If the final argument is the final argument of the method
+         */
+        auto decodeArguments{[&](SubchannelId subChannel, u32 method, u32 count, bool increment, bool last) {
+            while (count) {
+                u32 runCount{static_cast<u32>(std::min<size_t>(count, entry.ContiguousCount()))};
+                methodRuns.push_back({
+                    .arguments = entry.base(),
+                    .method = method,
+                    .count = runCount,
+                    .subChannel = subChannel,
+                    .increment = increment,
+                    .last = last && runCount == count,
+                });
+
+                entry += runCount;
+                count -= runCount;
+                if (increment)
+                    method += runCount;
+            }
         }};
 
-        // Executes the current split method, returning once execution is finished or the current GpEntry has reached its end
-        auto resumeSplitMethod{[&](){
+        // Decodes as much of the current split method as is present in this GpEntry
+        auto decodeSplitMethod{[&]() {
+            u32 available{static_cast<u32>(std::min<ssize_t>(resumeState.remaining, end - entry))};
             switch (resumeState.state) {
                 case MethodResumeState::State::Inc:
-                    while (entry != pushBuffer.end() && resumeState.remaining) {
-                        SendFull(resumeState.address++, getArgument(), resumeState.subChannel, --resumeState.remaining == 0);
-                        entry++;
-                    }
-
+                    decodeArguments(resumeState.subChannel, resumeState.address, available, true, available == resumeState.remaining);
+                    resumeState.address += available;
+                    resumeState.remaining -= available;
                     break;
                 case MethodResumeState::State::OneInc:
-                    SendFull(resumeState.address++, getArgument(), resumeState.subChannel, --resumeState.remaining == 0);
-                    entry++;
+                    if (!available)
+                        break; // The method header was the final entry in this GpEntry
+
+                    decodeArguments(resumeState.subChannel, resumeState.address++, 1, false, resumeState.remaining == 1);
+                    resumeState.remaining--;
+                    available--;
 
                     // After the first increment OneInc methods work the same as a NonInc method, this is needed so they can resume correctly if they are broken up by multiple GpEntries
                     resumeState.state = MethodResumeState::State::NonInc;
                     [[fallthrough]];
                 case MethodResumeState::State::NonInc:
-                    while (entry != pushBuffer.end() && resumeState.remaining) {
-                        SendFull(resumeState.address, getArgument(), resumeState.subChannel, --resumeState.remaining == 0);
-                        entry++;
-                    }
-
+                    decodeArguments(resumeState.subChannel, resumeState.address, available, false, available == resumeState.remaining);
+                    resumeState.remaining -= available;
                     break;
             }
         }};
 
         // We've a method from a previous GpEntry that needs resuming
         if (resumeState.remaining)
-            resumeSplitMethod();
-
-        // Process more methods if the entries are still not all used up after handling resuming
-        for (; entry != pushBuffer.end(); entry++) {
-            if (entry >= pushBuffer.end()) [[unlikely]]
-                throw exception("GPFIFO buffer overflow!"); // This should never happen
+            decodeSplitMethod();
 
+        while (entry != end) {
             // Entries containing all zeroes is a NOP, skip over them
-            for (; *entry == 0; entry++)
-                if (entry == std::prev(pushBuffer.end()))
-                    return;
-
-            PushBufferMethodHeader methodHeader{.raw = *entry};
-
-            // Needed in order to check for methods split across multiple GpEntries
-            ssize_t remainingEntries{std::distance(entry, pushBuffer.end()) - 1};
-
-            // Handles storing state and initial execution for methods that are split across multiple GpEntries
-            auto startSplitMethod{[&](auto methodState) {
-                resumeState = {
-                    .remaining = methodHeader.methodCount,
-                    .address = methodHeader.methodAddress,
-                    .subChannel = methodHeader.methodSubChannel,
-                    .state = methodState
-                };
-
-                // Skip over method header as `resumeSplitMethod` doesn't expect it to be there
+            if (*entry == 0) {
                 entry++;
+                continue;
+            }
 
-                resumeSplitMethod();
-            }};
-
-            /**
-             * @brief Handles execution of a specific method type as specified by the State template parameter
-             */
-            auto dispatchCalls{[&]<MethodResumeState::State State> () {
-                /**
-                 * @brief Gets the offset to apply to the method address for a given dispatch loop index
-                 */
-                auto methodOffset{[] (u32 i) -> u32 {
-                    if constexpr(State == MethodResumeState::State::Inc)
-                        return i;
-                    else if constexpr (State == MethodResumeState::State::OneInc)
-                        return i ? 1 : 0;
-                    else
-                        return 0;
-                }};
-
-                constexpr u32 BatchCutoff{4}; //!< Cutoff needed to send method calls in a batch which is espcially important for UBO updates. This helps to avoid the extra overhead batching for small packets.
-                // TODO: Only batch for specific target methods like UBO updates, since normal dispatch is generally cheaper
-
-                if (remainingEntries >= methodHeader.methodCount) { [[likely]]
-                    if (methodHeader.Pure()) [[likely]] {
-                        if constexpr (State == MethodResumeState::State::NonInc) {
-                            // For pure noninc methods we can send all method calls as a span in one go
-                            if (methodHeader.methodCount > BatchCutoff) [[unlikely]] {
-                                SendPureBatchNonInc(methodHeader.methodAddress, span(&(*++entry), methodHeader.methodCount), methodHeader.methodSubChannel);
-
-                                entry += methodHeader.methodCount - 1;
-                                return false;
-                            }
-                        } else if constexpr (State == MethodResumeState::State::OneInc) {
-                            // For pure oneinc methods we can send the initial method then send the rest as a span in one go
-                            if (methodHeader.methodCount > (BatchCutoff + 1)) [[unlikely]] {
-                                SendPure(methodHeader.methodAddress, *++entry, methodHeader.methodSubChannel);
-                                SendPureBatchNonInc(methodHeader.methodAddress + 1, span((++entry).base(), methodHeader.methodCount - 1), methodHeader.methodSubChannel);
-
-                                entry += methodHeader.methodCount - 2;
-                                return false;
-                            }
-                        }
-
-                        #pragma unroll(2)
-                        for (u32 i{}; i < methodHeader.methodCount; i++)
-                            SendPure(methodHeader.methodAddress + methodOffset(i), *++entry, methodHeader.methodSubChannel);
-                    } else {
-                        // Slow path for methods that touch GPFIFO or macros
-                        for (u32 i{}; i < methodHeader.methodCount; i++) {
-                            entry++;
-                            SendFull(methodHeader.methodAddress + methodOffset(i), getArgument(), methodHeader.methodSubChannel, i == methodHeader.methodCount - 1);
-                        }
+            PushBufferMethodHeader methodHeader{.raw = *entry++};
+
+            auto decodeMethod{[&](MethodResumeState::State state) {
+                if (end - entry < methodHeader.methodCount) {
+                    // Methods that are split across multiple GpEntries store their state in order to be resumed by the next GpEntry
+                    resumeState = {
+                        .remaining = methodHeader.methodCount,
+                        .address = methodHeader.methodAddress,
+                        .subChannel = methodHeader.methodSubChannel,
+                        .state = state
+                    };
+
+                    decodeSplitMethod();
+                } else if (state == MethodResumeState::State::OneInc) {
+                    if (methodHeader.methodCount) {
+                        decodeArguments(methodHeader.methodSubChannel, methodHeader.methodAddress, 1, false, methodHeader.methodCount == 1);
+                        decodeArguments(methodHeader.methodSubChannel, methodHeader.methodAddress + 1, methodHeader.methodCount - 1, false, true);
                     }
                 } else {
-                    startSplitMethod(State);
-                    return true;
+                    decodeArguments(methodHeader.methodSubChannel, methodHeader.methodAddress, methodHeader.methodCount, state == MethodResumeState::State::Inc, true);
                 }
-
-                return false;
             }};
 
-            /**
-             * @brief Handles execution of a single method
-             * @return If the this was the final method in the current GpEntry
-             */
-            auto processMethod{[&] () -> bool {
-                if (methodHeader.secOp == PushBufferMethodHeader::SecOp::IncMethod)  [[likely]] {
-                    return dispatchCalls.operator()<MethodResumeState::State::Inc>();
-                } else if (methodHeader.secOp == PushBufferMethodHeader::SecOp::OneInc) [[likely]] {
-                    return dispatchCalls.operator()<MethodResumeState::State::OneInc>();
-                } else if (methodHeader.secOp == PushBufferMethodHeader::SecOp::ImmdDataMethod) {
-                    if (methodHeader.Pure())
-                        SendPure(methodHeader.methodAddress, methodHeader.immdData, methodHeader.methodSubChannel);
-                    else
-                        SendFull(methodHeader.methodAddress, GpfifoArgument{methodHeader.immdData}, methodHeader.methodSubChannel, true);
-
-                    return false;
-                } else if (methodHeader.secOp == PushBufferMethodHeader::SecOp::NonIncMethod) [[unlikely]] {
-                    return dispatchCalls.operator()<MethodResumeState::State::NonInc>();
-                } else if (methodHeader.secOp == PushBufferMethodHeader::SecOp::EndPbSegment) [[unlikely]] {
-                    return true;
-                } else if (methodHeader.secOp == PushBufferMethodHeader::SecOp::Grp0UseTert) {
-                    if (methodHeader.tertOp == PushBufferMethodHeader::TertOp::Grp0SetSubDevMask)
-                        return false;
-
-                    throw exception("Unsupported pushbuffer method TertOp: {}", static_cast<u8>(methodHeader.tertOp));
-                } else {
-                    throw exception("Unsupported pushbuffer method SecOp: {}", static_cast<u8>(methodHeader.secOp));
-                }
-            }};
+            if (methodHeader.secOp == PushBufferMethodHeader::SecOp::IncMethod) [[likely]] {
+                decodeMethod(MethodResumeState::State::Inc);
+            } else if (methodHeader.secOp == PushBufferMethodHeader::SecOp::OneInc) [[likely]] {
+                decodeMethod(MethodResumeState::State::OneInc);
+            } else if (methodHeader.secOp == PushBufferMethodHeader::SecOp::ImmdDataMethod) {
+                methodRuns.push_back({
+                    .immediate = methodHeader.immdData,
+                    .method = methodHeader.methodAddress,
+                    .count = 1,
+                    .subChannel = methodHeader.methodSubChannel,
+                    .last = true,
+                });
+            } else if (methodHeader.secOp == PushBufferMethodHeader::SecOp::NonIncMethod) [[unlikely]] {
+                decodeMethod(MethodResumeState::State::NonInc);
+            } else if (methodHeader.secOp == PushBufferMethodHeader::SecOp::EndPbSegment) [[unlikely]] {
+                break;
+            } else if (methodHeader.secOp == PushBufferMethodHeader::SecOp::Grp0UseTert && methodHeader.tertOp == PushBufferMethodHeader::TertOp::Grp0SetSubDevMask) {
+                continue;
+            } else {
+                unsupportedHeader = methodHeader;
+                break;
+            }
+        }
 
-            bool hitEnd{[&]() {
-                if (methodHeader.methodSubChannel != SubchannelId::ThreeD) [[unlikely]]
-                    channelCtx.maxwell3D.FlushEngineState(); // Flush the 3D engine state when doing any calls to other engines
-                return processMethod();
-            }()};
+        /* Stage two: Dispatch the decoded runs to their engines */
+        for (const auto &run : methodRuns) {
+            if (run.subChannel != SubchannelId::ThreeD) [[unlikely]]
+                channelCtx.maxwell3D.FlushEngineState(); // Flush the 3D engine state when doing any calls to other engines
 
-            if (hitEnd)
-                break;
+            u32 lastMethod{run.increment ? run.method + run.count - 1 : run.method};
+            bool pure{run.method >= engine::GPFIFO::RegisterCount && lastMethod < engine::EngineMethodsEnd};
+
+            if (!run.arguments) {
+                if (pure)
+                    SendPure(run.method, run.immediate, run.subChannel);
+                else
+                    SendFull(run.method, GpfifoArgument{run.immediate}, run.subChannel, true);
+            } else if (pure) [[likely]] {
+                // Pure runs never touch GPFIFO or macro methods so they can be sent to the engine in one go
+                if (run.increment)
+                    SendPureBatch(run.method, span(run.arguments, run.count), run.subChannel);
+                else
+                    SendPureBatchNonInc(run.method, span(run.arguments, run.count), run.subChannel);
+            } else {
+                // Slow path for methods that touch GPFIFO or macros
+                for (u32 i{}; i < run.count; i++)
+                    SendFull(run.increment ? run.method + i : run.method, GpfifoArgument{0, run.arguments + i, pushbufferDirty}, run.subChannel, run.last && i == run.count - 1);
+            }
+        }
+
+        if (unsupportedHeader) [[unlikely]] {
+            if (unsupportedHeader->secOp == PushBufferMethodHeader::SecOp::Grp0UseTert)
+                throw exception("Unsupported pushbuffer method TertOp: {}", static_cast<u8>(unsupportedHeader->tertOp));
+            else
+                throw exception("Unsupported pushbuffer method SecOp: {}", static_cast<u8>(unsupportedHeader->secOp));
         }
     }
 
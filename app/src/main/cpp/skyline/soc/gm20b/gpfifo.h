@@ -107,9 +107,22 @@ namespace skyline::soc::gm20b {
         ChannelContext &channelCtx;
         engine::GPFIFO gpfifoEngine; //!< The engine for processing GPFIFO method calls
         CircularQueue<GpEntry> gpEntries;
-        std::vector<u32> pushBufferData; //!< Persistent vector storing pushbuffer data to avoid constant reallocations
         bool skipDirtyFlushes{}; //!< If GPU flushing should be skipped when fetching pushbuffer contents
 
+        /**
+         * @brief A run of method calls decoded from a pushbuffer, all arguments in a run target the same subchannel and are contiguous in host memory
+         */
+        struct MethodRun {
+            u32 *arguments{}; //!< A pointer to the arguments in the pushbuffer, this is nullptr for immediate data methods
+            u32 immediate{}; //!< The argument of an immediate data method
+            u32 method; //!< The method address of the first argument
+            u32 count; //!< The number of arguments in the run
+            SubchannelId subChannel;
+            bool increment{}; //!< If the method address increments with each argument
+            bool last{}; //!< If the final argument in the run is the final argument of its method, this is required for macros which can be split over multiple runs
+        };
+        std::vector<MethodRun> methodRuns; //!< Persistent vector storing decoded method runs to avoid constant reallocations
+
         /**
          * @brief Holds the required state in order to resume a method started from one call to `Process` in another
          * @note This is needed as games (especially OpenGL ones) can split method entries over multiple GpEntries
@@ -141,13 +154,18 @@ namespace skyline::soc::gm20b {
          */
         void SendPure(u32 method, u32 argument, SubchannelId subchannel);
 
+        /**
+         * @brief Sends a batch of method calls to consecutive methods to the appropriate subchannel, macro and GPFIFO methods are not handled
+         */
+        void SendPureBatch(u32 method, span<u32> arguments, SubchannelId subChannel);
+
         /**
          * @brief Sends a batch of method calls all directed at the same method to the appropriate subchannel, macro and GPFIFO methods are not handled
          */
         void SendPureBatchNonInc(u32 method, span<u32> arguments, SubchannelId subChannel);
 
         /**
-         * @brief Processes the pushbuffer contained within the given GpEntry, calling methods as needed
+         * @brief Processes the pushbuffer contained within the given GpEntry, it's first decoded into method runs which are then dispatched to the engines in bulk
          */
         void Process(GpEntry gpEntry);
 
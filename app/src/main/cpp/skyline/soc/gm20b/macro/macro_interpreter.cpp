@@ -8,7 +8,7 @@
 namespace skyline::soc::gm20b::engine {
     MacroInterpreter::MacroInterpreter(span<u32> macroCode) : macroCode{macroCode} {}
 
-    void MacroInterpreter::Execute(size_t offset, span<u32> args, MacroEngineBase *targetEngine) {
+    MacroExecutionStatistics MacroInterpreter::Execute(size_t offset, span<u32> args, MacroEngineBase *targetEngine) {
         // Reset the interpreter state
         engine = targetEngine;
         opcode = reinterpret_cast<Opcode *>(&macroCode[offset]);
@@ -16,14 +16,19 @@ namespace skyline::soc::gm20b::engine {
         argument = args.data();
         methodAddress.raw = 0;
         carryFlag = false;
+        statistics = {};
 
         // The first argument is stored in register 1
         registers[1] = *argument++;
 
         while (Step());
+
+        return statistics;
     }
 
     __attribute__((always_inline)) bool MacroInterpreter::Step(Opcode *delayedOpcode) {
+        statistics.instructions++;
+
         switch (opcode->operation) {
             case Opcode::Operation::AluRegister: {
                 u32 result{HandleAlu(opcode->aluOperation, registers[opcode->srcA], registers[opcode->srcB])};
@@ -200,6 +205,7 @@ namespace skyline::soc::gm20b::engine {
     __attribute__((always_inline)) void MacroInterpreter::Send(u32 pArgument) {
         engine->CallMethodFromMacro(methodAddress.address, pArgument);
         methodAddress.address += methodAddress.increment;
+        statistics.methods++;
     }
 
     __attribute__((always_inline)) void MacroInterpreter::WriteRegister(u8 reg, u32 value) {
@@ -8,11 +8,21 @@
 namespace skyline::soc::gm20b::engine {
     struct MacroEngineBase;
 
+    /**
+     * @brief Counters describing the work done by a single macro execution
+     */
+    struct MacroExecutionStatistics {
+        u32 instructions; //!< The amount of instructions executed, including delay slots
+        u32 methods; //!< The amount of methods sent to the target engine
+    };
+
     /**
      * @brief The MacroInterpreter class handles interpreting macros. Macros are small programs that run on the GPU and are used for things like instanced rendering
      */
     class MacroInterpreter {
       private:
+        friend class MacroJit;
+
         #pragma pack(push, 1)
         union Opcode {
             u32 raw;
@@ -112,6 +122,7 @@ namespace skyline::soc::gm20b::engine {
         const u32 *argument{}; //!< A pointer to the argument buffer for the program, it is read from sequentially
         MethodAddress methodAddress{};
         bool carryFlag{}; //!< A flag representing if an arithmetic operation has set the most significant bit
+        MacroExecutionStatistics statistics{};
 
         /**
          * @brief Steps forward one macro instruction, including delay slots
@@ -144,7 +155,8 @@ namespace skyline::soc::gm20b::engine {
 
         /**
          * @brief Executes a GPU macro from macro memory with the given arguments targeting the specified engine
+         * @return Statistics about the work done by the macro
          */
-        void Execute(size_t offset, span<u32> args, MacroEngineBase *targetEngine);
+        MacroExecutionStatistics Execute(size_t offset, span<u32> args, MacroEngineBase *targetEngine);
     };
 }
@@ -0,0 +1,366 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2024 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include <unordered_set>
+#include "soc/gm20b/engines/engine.h"
+#include "macro_jit.h"
+
+namespace skyline::soc::gm20b::engine {
+    MacroJit::MacroJit(span<u32> macroCode) : macroCode{macroCode} {}
+
+    template<MacroJit::Opcode::AluOperation Operation>
+    __attribute__((always_inline)) u32 MacroJit::Alu(Context &ctx, u32 srcA, u32 srcB) {
+        using AluOperation = Opcode::AluOperation;
+        if constexpr (Operation == AluOperation::Add) {
+            u64 result{static_cast<u64>(srcA) + srcB};
+            ctx.carryFlag = result >> 32;
+            return static_cast<u32>(result);
+        } else if constexpr (Operation == AluOperation::AddWithCarry) {
+            u64 result{static_cast<u64>(srcA) + srcB + ctx.carryFlag};
+            ctx.carryFlag = result >> 32;
+            return static_cast<u32>(result);
+        } else if constexpr (Operation == AluOperation::Subtract) {
+            u64 result{static_cast<u64>(srcA) - srcB};
+            ctx.carryFlag = result & 0xFFFFFFFF;
+            return static_cast<u32>(result);
+        } else if constexpr (Operation == AluOperation::SubtractWithBorrow) {
+            u64 result{static_cast<u64>(srcA) - srcB - !ctx.carryFlag};
+            ctx.carryFlag = result & 0xFFFFFFFF;
+            return static_cast<u32>(result);
+        } else if constexpr (Operation == AluOperation::BitwiseXor) {
+            return srcA ^ srcB;
+        } else if constexpr (Operation == AluOperation::BitwiseOr) {
+            return srcA | srcB;
+        } else if constexpr (Operation == AluOperation::BitwiseAnd) {
+            return srcA & srcB;
+        } else if constexpr (Operation == AluOperation::BitwiseAndNot) {
+            return srcA & ~srcB;
+        } else if constexpr (Operation == AluOperation::BitwiseNand) {
+            return ~(srcA & srcB);
+        }
+    }
+
+    template<MacroJit::Opcode::AssignmentOperation Operation>
+    __attribute__((always_inline)) void MacroJit::Assign(Context &ctx, u8 reg, u32 result) {
+        using AssignmentOperation = Opcode::AssignmentOperation;
+        auto send{[&ctx](u32 argument) {
+            ctx.engine->CallMethodFromMacro(ctx.methodAddress.address, argument);
+            ctx.methodAddress.address += ctx.methodAddress.increment;
+            ctx.statistics.methods++;
+        }};
+
+        // Writes to register 0 are redirected to DiscardRegister at compile-time so there's no need to check for them here
+        if constexpr (Operation == AssignmentOperation::IgnoreAndFetch) {
+            ctx.registers[reg] = *ctx.argument++;
+        } else if constexpr (Operation == AssignmentOperation::Move) {
+            ctx.registers[reg] = result;
+        } else if constexpr (Operation == AssignmentOperation::MoveAndSetMethod) {
+            ctx.registers[reg] = result;
+            ctx.methodAddress.raw = result;
+        } else if constexpr (Operation == AssignmentOperation::FetchAndSend) {
+            ctx.registers[reg] = *ctx.argument++;
+            send(result);
+        } else if constexpr (Operation == AssignmentOperation::MoveAndSend) {
+            ctx.registers[reg] = result;
+            send(result);
+        } else if constexpr (Operation == AssignmentOperation::FetchAndSetMethod) {
+            ctx.registers[reg] = *ctx.argument++;
+            ctx.methodAddress.raw = result;
+        } else if constexpr (Operation == AssignmentOperation::MoveAndSetMethodThenFetchAndSend) {
+            ctx.registers[reg] = result;
+            ctx.methodAddress.raw = result;
+            send(*ctx.argument++);
+        } else if constexpr (Operation == AssignmentOperation::MoveAndSetMethodThenSendHigh) {
+            ctx.registers[reg] = result;
+            ctx.methodAddress.raw = result;
+            send(ctx.methodAddress.increment);
+        }
+    }
+
+    template<MacroJit::Opcode::Operation Operation, MacroJit::Opcode::AluOperation AluOperation, MacroJit::Opcode::AssignmentOperation AssignmentOperation>
+    u32 MacroJit::ExecuteInstruction(Context &ctx, const Instruction &instruction) {
+        using Op = Opcode::Operation;
+        u32 result;
+        if constexpr (Operation == Op::AluRegister) {
+            result = Alu<AluOperation>(ctx, ctx.registers[instruction.srcA], ctx.registers[instruction.srcB]);
+        } else if constexpr (Operation == Op::AddImmediate) {
+            result = static_cast<u32>(static_cast<i32>(ctx.registers[instruction.srcA]) + instruction.immediate);
+        } else if constexpr (Operation == Op::BitfieldReplace) {
+            u32 src{(ctx.registers[instruction.srcB] >> instruction.srcBit) & instruction.mask};
+            result = (ctx.registers[instruction.srcA] & ~(instruction.mask << instruction.destBit)) | (src << instruction.destBit);
+        } else if constexpr (Operation == Op::BitfieldExtractShiftLeftImmediate) {
+            result = ((ctx.registers[instruction.srcB] >> ctx.registers[instruction.srcA]) & instruction.mask) << instruction.destBit;
+        } else if constexpr (Operation == Op::BitfieldExtractShiftLeftRegister) {
+            result = ((ctx.registers[instruction.srcB] >> instruction.srcBit) & instruction.mask) << ctx.registers[instruction.srcA];
+        } else if constexpr (Operation == Op::ReadImmediate) {
+            result = ctx.engine->ReadMethodFromMacro(static_cast<u32>(static_cast<i32>(ctx.registers[instruction.srcA]) + instruction.immediate));
+        }
+
+        Assign<AssignmentOperation>(ctx, instruction.dest, result);
+        return instruction.next;
+    }
+
+    template<MacroJit::Opcode::BranchCondition Condition>
+    u32 MacroJit::ExecuteBranch(Context &ctx, const Instruction &instruction) {
+        u32 value{ctx.registers[instruction.srcA]};
+        bool branch{(Condition == Opcode::BranchCondition::Zero) ? (value == 0) : (value != 0)};
+        return branch ? instruction.target : instruction.next;
+    }
+
+    u32 MacroJit::Invalid(Context &ctx, const Instruction &instruction) {
+        Opcode opcode{.raw = instruction.raw};
+        if (opcode.operation == Opcode::Operation::Branch)
+            throw exception("Cannot branch while inside a delay slot");
+        else if (opcode.operation == Opcode::Operation::AluRegister)
+            throw exception("Unknown MME ALU operation encountered: 0x{:X}", static_cast<u8>(opcode.aluOperation));
+        else
+            throw exception("Unknown MME opcode encountered: 0x{:X}", static_cast<u8>(opcode.operation));
+    }
+
+    MacroJit::Handler MacroJit::GetHandler(Opcode opcode) {
+        using Op = Opcode::Operation;
+        using AluOp = Opcode::AluOperation;
+        using AssignOp = Opcode::AssignmentOperation;
+
+        auto withAssignment{[&opcode]<Op Operation, AluOp AluOperation>() -> Handler {
+            switch (opcode.assignmentOperation) {
+                #define ASSIGNMENT_CASE(name) \
+                    case AssignOp::name:      \
+                        return &ExecuteInstruction<Operation, AluOperation, AssignOp::name>
+
+                ASSIGNMENT_CASE(IgnoreAndFetch);
+                ASSIGNMENT_CASE(Move);
+                ASSIGNMENT_CASE(MoveAndSetMethod);
+                ASSIGNMENT_CASE(FetchAndSend);
+                ASSIGNMENT_CASE(MoveAndSend);
+                ASSIGNMENT_CASE(FetchAndSetMethod);
+                ASSIGNMENT_CASE(MoveAndSetMethodThenFetchAndSend);
+                ASSIGNMENT_CASE(MoveAndSetMethodThenSendHigh);
+
+                #undef ASSIGNMENT_CASE
+            }
+            return &Invalid;
+        }};
+
+        switch (opcode.operation) {
+            case Op::AluRegister:
+                switch (opcode.aluOperation) {
+                    #define ALU_CASE(name) \
+                        case AluOp::name:  \
+                            return withAssignment.template operator()<Op::AluRegister, AluOp::name>()
+
+                    ALU_CASE(Add);
+                    ALU_CASE(AddWithCarry);
+                    ALU_CASE(Subtract);
+                    ALU_CASE(SubtractWithBorrow);
+                    ALU_CASE(BitwiseXor);
+                    ALU_CASE(BitwiseOr);
+                    ALU_CASE(BitwiseAnd);
+                    ALU_CASE(BitwiseAndNot);
+                    ALU_CASE(BitwiseNand);
+
+                    #undef ALU_CASE
+
+                    default:
+                        return &Invalid;
+                }
+
+            // The ALU operation is unused by all other operations so it's always specialised as Add to avoid redundant instantiations
+            case Op::AddImmediate:
+                return withAssignment.template operator()<Op::AddImmediate, AluOp::Add>();
+            case Op::BitfieldReplace:
+                return withAssignment.template operator()<Op::BitfieldReplace, AluOp::Add>();
+            case Op::BitfieldExtractShiftLeftImmediate:
+                return withAssignment.template operator()<Op::BitfieldExtractShiftLeftImmediate, AluOp::Add>();
+            case Op::BitfieldExtractShiftLeftRegister:
+                return withAssignment.template operator()<Op::BitfieldExtractShiftLeftRegister, AluOp::Add>();
+            case Op::ReadImmediate:
+                return withAssignment.template operator()<Op::ReadImmediate, AluOp::Add>();
+
+            case Op::Branch:
+                if (opcode.branchCondition == Opcode::BranchCondition::Zero)
+                    return &ExecuteBranch<Opcode::BranchCondition::Zero>;
+                else
+                    return &ExecuteBranch<Opcode::BranchCondition::NonZero>;
+
+            default:
+                return &Invalid;
+        }
+    }
+
+    namespace {
+        /**
+         * @brief Walks the control flow graph of a macro starting at the supplied offset, calling the visitor once for each reachable (index, slot kind) pair
+         * @param visitor A callable taking the index and slot kind of an instruction, returning false aborts the walk
+         * @return If the walk completed without any instruction falling outside of the macro code
+         */
+        template<typename SlotKind, typename Opcode, typename Visitor>
+        bool WalkMacro(span<u32> macroCode, size_t offset, Visitor &&visitor) {
+            std::vector<std::pair<i64, SlotKind>> pending;
+            std::unordered_set<u64> visited;
+
+            auto push{[&](i64 index, SlotKind kind) {
+                if (visited.emplace((static_cast<u64>(index) << 2) | static_cast<u64>(kind)).second)
+                    pending.emplace_back(index, kind);
+            }};
+            push(static_cast<i64>(offset), SlotKind::Normal);
+
+            while (!pending.empty()) {
+                auto [index, kind]{pending.back()};
+                pending.pop_back();
+
+                if (index < 0 || static_cast<size_t>(index) >= macroCode.size())
+                    return false;
+
+                Opcode opcode{.raw = macroCode[static_cast<size_t>(index)]};
+                if (!visitor(index, kind, opcode))
+                    return false;
+
+                if (kind == SlotKind::DelaySlotThenExit)
+                    continue;
+
+                if (kind == SlotKind::DelaySlotThenTarget) {
+                    // The branch owning this delay slot is the preceding instruction, branches inside delay slots throw when executed so they have no successors
+                    if (opcode.operation != Opcode::Operation::Branch)
+                        push(index - 1 + Opcode{.raw = macroCode[static_cast<size_t>(index - 1)]}.immediate, SlotKind::Normal);
+                    continue;
+                }
+
+                if (opcode.operation == Opcode::Operation::Branch) {
+                    if (opcode.noDelay)
+                        push(index + opcode.immediate, SlotKind::Normal);
+                    else
+                        push(index + 1, SlotKind::DelaySlotThenTarget);
+                }
+
+                push(index + 1, opcode.exit ? SlotKind::DelaySlotThenExit : SlotKind::Normal);
+            }
+
+            return true;
+        }
+    }
+
+    std::optional<std::pair<size_t, size_t>> MacroJit::FindReachableRange(size_t offset) {
+        size_t start{offset}, end{offset + 1};
+        if (!WalkMacro<SlotKind, Opcode>(macroCode, offset, [&](i64 index, SlotKind, Opcode) {
+            start = std::min(start, static_cast<size_t>(index));
+            end = std::max(end, static_cast<size_t>(index) + 1);
+            return true;
+        }))
+            return std::nullopt;
+
+        return std::make_pair(start, end);
+    }
+
+    std::shared_ptr<MacroJit::CompiledMacro> MacroJit::Compile(size_t offset) {
+        auto macro{std::make_shared<CompiledMacro>()};
+        auto &instructions{macro->instructions};
+        std::unordered_map<u64, u32> instructionIndices; //!< A map from the index and slot kind of an instruction in macro code to its index in the compiled macro
+
+        // Instructions are assigned compiled indices in the order they're first referenced, the entrypoint is always referenced first so it'll be at index 0
+        auto getIndex{[&](i64 index, SlotKind kind) -> u32 {
+            auto [it, inserted]{instructionIndices.try_emplace((static_cast<u64>(index) << 2) | static_cast<u64>(kind), static_cast<u32>(instructions.size()))};
+            if (inserted)
+                instructions.emplace_back();
+            return it->second;
+        }};
+        getIndex(static_cast<i64>(offset), SlotKind::Normal);
+
+        bool success{WalkMacro<SlotKind, Opcode>(macroCode, offset, [&](i64 index, SlotKind kind, Opcode opcode) {
+            // Note: The instruction must be written through an index as getIndex may reallocate the vector
+            Instruction instruction{
+                .handler = GetHandler(opcode),
+                .next = ExitIndex,
+                .target = ExitIndex,
+                .immediate = opcode.immediate,
+                .mask = opcode.bitfield.GetMask(),
+                .dest = static_cast<u8>(opcode.dest ? opcode.dest : DiscardRegister),
+                .srcA = opcode.srcA,
+                .srcB = opcode.srcB,
+                .srcBit = opcode.bitfield.srcBit,
+                .destBit = opcode.bitfield.destBit,
+                .raw = opcode.raw,
+            };
+
+            if (kind == SlotKind::Normal) {
+                instruction.next = getIndex(index + 1, opcode.exit ? SlotKind::DelaySlotThenExit : SlotKind::Normal);
+                if (opcode.operation == Opcode::Operation::Branch)
+                    instruction.target = opcode.noDelay ? getIndex(index + opcode.immediate, SlotKind::Normal) : getIndex(index + 1, SlotKind::DelaySlotThenTarget);
+            } else if (opcode.operation == Opcode::Operation::Branch) {
+                instruction.handler = &Invalid;
+            } else if (kind == SlotKind::DelaySlotThenTarget) {
+                instruction.next = getIndex(index - 1 + Opcode{.raw = macroCode[static_cast<size_t>(index - 1)]}.immediate, SlotKind::Normal);
+            }
+
+            instructions[getIndex(index, kind)] = instruction;
+            return true;
+        })};
+
+        return success ? macro : nullptr;
+    }
+
+    std::shared_ptr<MacroJit::CompiledMacro> MacroJit::Lookup(size_t offset) {
+        auto range{FindReachableRange(offset)};
+        if (!range)
+            return nullptr;
+
+        // The entrypoint is used as the seed as the same code can be entered at different points
+        auto [start, end]{*range};
+        auto code{macroCode.subspan(start, end - start)};
+        u64 hash{XXH3_64bits_withSeed(code.data(), code.size_bytes(), offset - start)};
+
+        if (auto it{cache.find(hash)}; it != cache.end())
+            return it->second;
+
+        // Titles which regularly upload new macros would otherwise grow the cache indefinitely, macros that are still in use by a position are retained as they'd be recompiled immediately
+        if (cache.size() >= MaxCachedMacros)
+            std::erase_if(cache, [](const auto &entry) { return entry.second.use_count() <= 1; });
+
+        auto macro{Compile(offset)};
+        cache.emplace(hash, macro);
+        return macro;
+    }
+
+    std::optional<size_t> MacroJit::GetMacroSize(size_t offset) {
+        if (auto range{FindReachableRange(offset)})
+            return range->second - offset;
+        return std::nullopt;
+    }
+
+    void MacroJit::Invalidate() {
+        compiledValid.fill(false);
+        compiledMacros.fill(nullptr);
+    }
+
+    std::optional<MacroExecutionStatistics> MacroJit::Execute(u32 position, size_t offset, span<u32> args, MacroEngineBase *targetEngine) {
+        if (!compiledValid[position]) {
+            compiledMacros[position] = Lookup(offset);
+            compiledValid[position] = true;
+        }
+
+        auto macro{compiledMacros[position].get()};
+        if (!macro)
+            return std::nullopt;
+
+        Context ctx{
+            .registers = {},
+            .argument = args.data(),
+            .carryFlag = false,
+            .engine = targetEngine,
+            .statistics = {},
+        };
+        ctx.methodAddress.raw = 0;
+
+        // The first argument is stored in register 1
+        ctx.registers[1] = *ctx.argument++;
+
+        const Instruction *instructions{macro->instructions.data()};
+        for (u32 index{}; index != ExitIndex;) {
+            const auto &instruction{instructions[index]};
+            index = instruction.handler(ctx, instruction);
+            ctx.statistics.instructions++;
+        }
+
+        return ctx.statistics;
+    }
+}
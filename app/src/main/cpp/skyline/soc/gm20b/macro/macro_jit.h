@@ -0,0 +1,140 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2024 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include <optional>
+#include <common.h>
+#include "macro_interpreter.h"
+
+namespace skyline::soc::gm20b::engine {
+    struct MacroEngineBase;
+
+    /**
+     * @brief The MacroJit class compiles macros into pre-decoded threaded code which avoids all of the decoding and dispatch overhead of the interpreter
+     * @note Every instruction is compiled to a handler specialised for its operation, ALU operation and assignment with all operands pre-extracted, delay slots are unrolled into separate instructions and branch targets are resolved ahead of time
+     * @note Compiled macros are cached by a hash of their code so they can be shared between positions and reused after the macro code is reuploaded, the cache is bounded as the macro code is guest-controlled
+     */
+    class MacroJit {
+      private:
+        using Opcode = MacroInterpreter::Opcode;
+        using MethodAddress = MacroInterpreter::MethodAddress;
+
+        /**
+         * @brief The state of a macro during execution
+         */
+        struct Context {
+            std::array<u32, 9> registers; //!< The general-purpose registers, writes to register 0 are redirected to the last register so they're discarded
+            const u32 *argument; //!< A pointer to the argument buffer for the program, it is read from sequentially
+            MethodAddress methodAddress;
+            bool carryFlag;
+            MacroEngineBase *engine;
+            MacroExecutionStatistics statistics;
+        };
+
+        struct Instruction;
+
+        /**
+         * @return The index of the next instruction to execute
+         */
+        using Handler = u32 (*)(Context &ctx, const Instruction &instruction);
+
+        static constexpr u32 ExitIndex{std::numeric_limits<u32>::max()}; //!< The instruction index that denotes the macro has exited
+        static constexpr u8 DiscardRegister{8}; //!< The register used as the destination for instructions writing to register 0
+
+        struct Instruction {
+            Handler handler;
+            u32 next; //!< The index of the instruction to execute after this one
+            u32 target; //!< The index of the instruction to execute if a branch is taken
+            i32 immediate;
+            u32 mask; //!< The mask for bitfield operations
+            u8 dest;
+            u8 srcA;
+            u8 srcB;
+            u8 srcBit;
+            u8 destBit;
+            u32 raw; //!< The raw opcode, used for error reporting
+        };
+
+        /**
+         * @brief The context an instruction is reached in, delay slots are compiled separately from the same instruction reached normally as they have different successors
+         */
+        enum class SlotKind : u8 {
+            Normal,
+            DelaySlotThenTarget, //!< A delay slot of a taken branch, execution continues at the branch target
+            DelaySlotThenExit, //!< A delay slot of an exiting instruction, execution stops after it
+        };
+
+        /**
+         * @brief A macro compiled to threaded code, instruction 0 is the entrypoint
+         */
+        struct CompiledMacro {
+            std::vector<Instruction> instructions;
+        };
+
+        static constexpr size_t MaxCachedMacros{0x200}; //!< The amount of compiled macros after which any that aren't in use by a position are evicted from the cache
+
+        span<u32> macroCode; //!< Span pointing to the global macro code memory
+        std::unordered_map<u64, std::shared_ptr<CompiledMacro>> cache; //!< A cache of compiled macros keyed by the hash of their code, this holds at most `MaxCachedMacros` entries in addition to those in use by a position
+        std::array<std::shared_ptr<CompiledMacro>, 0x80> compiledMacros; //!< The compiled macro for each macro position, this is reset by `Invalidate`
+        std::array<bool, 0x80> compiledValid{}; //!< If the corresponding entry in `compiledMacros` is valid, a null entry that's valid is a macro that can't be compiled
+
+        template<Opcode::AluOperation Operation>
+        static u32 Alu(Context &ctx, u32 srcA, u32 srcB);
+
+        template<Opcode::AssignmentOperation Operation>
+        static void Assign(Context &ctx, u8 reg, u32 result);
+
+        template<Opcode::Operation Operation, Opcode::AluOperation AluOperation, Opcode::AssignmentOperation AssignmentOperation>
+        static u32 ExecuteInstruction(Context &ctx, const Instruction &instruction);
+
+        template<Opcode::BranchCondition Condition>
+        static u32 ExecuteBranch(Context &ctx, const Instruction &instruction);
+
+        /**
+         * @brief A handler for instructions that are invalid when executed, this'll throw an exception when reached
+         */
+        static u32 Invalid(Context &ctx, const Instruction &instruction);
+
+        /**
+         * @return The handler for the supplied opcode
+         */
+        static Handler GetHandler(Opcode opcode);
+
+        /**
+         * @brief Finds the range of macro code that's reachable from the supplied offset
+         * @return The reachable range or std::nullopt if any reachable instruction lies outside of macro code memory
+         */
+        std::optional<std::pair<size_t, size_t>> FindReachableRange(size_t offset);
+
+        /**
+         * @brief Compiles the macro at the supplied offset in macro code memory
+         * @return The compiled macro or nullptr if it couldn't be compiled
+         */
+        std::shared_ptr<CompiledMacro> Compile(size_t offset);
+
+        /**
+         * @return The compiled macro at the supplied offset from the cache, compiling it if it isn't present
+         */
+        std::shared_ptr<CompiledMacro> Lookup(size_t offset);
+
+      public:
+        MacroJit(span<u32> macroCode);
+
+        /**
+         * @brief Invalidates the compiled macros for all positions, this must be called when the macro code or positions are changed
+         */
+        void Invalidate();
+
+        /**
+         * @return The size of the macro at the supplied offset in macro code memory, this covers all code reachable from the entrypoint
+         */
+        std::optional<size_t> GetMacroSize(size_t offset);
+
+        /**
+         * @brief Executes the macro at the given position with the supplied arguments targeting the specified engine
+         * @return Statistics about the work done by the macro or std::nullopt if it couldn't be compiled, in which case it must be executed by the interpreter instead
+         */
+        std::optional<MacroExecutionStatistics> Execute(u32 position, size_t offset, span<u32> args, MacroEngineBase *targetEngine);
+    };
+}
@@ -3,7 +3,7 @@
 // Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
 
 #include <range/v3/algorithm/any_of.hpp>
-#include <soc/gm20b/engines/maxwell/types.h>
+#include <common/trace.h>
 #include <soc/gm20b/engines/engine.h>
 #include "macro_state.h"
 
@@ -12,17 +12,6 @@ namespace skyline::soc::gm20b {
         return ranges::any_of(args, [](const GpfifoArgument &arg) { return arg.dirty; });
     }
 
-    static bool TopologyRequiresConversion(engine::maxwell3d::type::DrawTopology topology) {
-        switch (topology) {
-            case engine::maxwell3d::type::DrawTopology::Quads:
-            case engine::maxwell3d::type::DrawTopology::QuadStrip:
-            case engine::maxwell3d::type::DrawTopology::Polygon:
-                return true;
-            default:
-                return false;
-        }
-    }
-
     namespace macro_hle {
         bool DrawInstanced(size_t offset, span<GpfifoArgument> args, engine::MacroEngineBase *targetEngine, const std::function<void(void)> &flushCallback) {
             if (AnyArgsDirty(args))
@@ -36,19 +25,19 @@ namespace skyline::soc::gm20b {
 
         bool DrawInstancedIndexedIndirect(size_t offset, span<GpfifoArgument> args, engine::MacroEngineBase *targetEngine, const std::function<void(void)> &flushCallback) {
             u32 topology{*args[0]};
-            bool topologyConversion{TopologyRequiresConversion(static_cast<engine::maxwell3d::type::DrawTopology>(topology))};
+            // The indirect draw reads its parameters directly from the pushbuffer, which is only possible if they weren't split across separate mappings
+            // Topologies requiring conversion are handled by a GPU pass prior to the draw so GPU-written parameters never need to be read back
+            bool indirect{args[1].argumentPtr && args[5].argumentPtr == args[1].argumentPtr + 4};
 
-            // If the indirect topology isn't supported flush and fallback to a non indirect draw
-            if (topologyConversion && args[1].dirty)
-                flushCallback();
+            if (indirect && args[1].dirty && targetEngine->DrawIndexedIndirect(topology, span(args[1].argumentPtr, 5).cast<u8>(), 1, 0))
+                return true;
 
-            if (topologyConversion || !args[1].dirty) {
-                u32 instanceCount{targetEngine->ReadMethodFromMacro(0xD1B) & *args[2]};
-                targetEngine->DrawIndexedInstanced(topology, *args[1], instanceCount, *args[4], *args[3], *args[5]);
-            } else {
-                targetEngine->DrawIndexedIndirect(topology, span(args[1].argumentPtr, 5).cast<u8>(), 1, 0);
-            }
+            // If the draw can't be done indirectly flush and fallback to a non indirect draw
+            if (args[1].dirty)
+                flushCallback();
 
+            u32 instanceCount{targetEngine->ReadMethodFromMacro(0xD1B) & *args[2]};
+            targetEngine->DrawIndexedInstanced(topology, *args[1], instanceCount, *args[4], *args[3], *args[5]);
             return true;
         }
 
@@ -58,7 +47,10 @@ namespace skyline::soc::gm20b {
             u32 hash;
         };
 
-        constexpr std::array<HleFunctionInfo, 0x4> functions{{
+        /**
+         * @note Entries are keyed on the XXH32 of the first `size` words of a macro, the "Macro without HLE" log emits these for any macro that misses HLE in the same format as an entry
+         */
+        constexpr std::array<HleFunctionInfo, 0x3> functions{{
             {DrawInstanced, 0x12, 0x2FDD711},
             {DrawInstancedIndexedIndirect, 0x17, 0xDBC3B762},
             {DrawInstancedIndexedIndirect, 0x1F, 0xDA07F4E5} // This macro is the same as above but it writes draw params to a cbuf, which are unnecessary due to hades HLE
@@ -82,11 +74,41 @@ namespace skyline::soc::gm20b {
         invalidatePending = true;
     }
 
+    MacroState::~MacroState() {
+        if (collectStatistics)
+            DumpStatistics();
+    }
+
+    std::pair<u32, size_t> MacroState::GetMacroSignature(size_t offset) {
+        // Macros that reach outside of macro memory can't be HLEd so the remainder of macro memory is used to keep them identifiable
+        size_t size{macroJit.GetMacroSize(offset).value_or(macroCode.size() - offset)};
+        auto code{span(macroCode).subspan(offset, size)};
+        return {XXH32(code.data(), code.size_bytes(), 0), size};
+    }
+
+    void MacroState::DumpStatistics() {
+        std::vector<const MacroStatistics *> sortedStatistics;
+        sortedStatistics.reserve(macroStatistics.size());
+        for (const auto &[hash, statistics] : macroStatistics)
+            sortedStatistics.push_back(&statistics);
+        std::sort(sortedStatistics.begin(), sortedStatistics.end(), [](const MacroStatistics *a, const MacroStatistics *b) { return a->time > b->time; });
+
+        for (const auto *statistics : sortedStatistics)
+            LOGI("Macro hash: 0x{:X}, size: 0x{:X}, calls: {}, HLE hits: {}, HLE misses: {}, instructions: {}, methods: {}, time: {}us", statistics->hash, statistics->size, statistics->calls, statistics->hleHits, statistics->hleMisses, statistics->instructions, statistics->methods, statistics->time / 1000);
+    }
+
     void MacroState::Execute(u32 position, span<GpfifoArgument> args, engine::MacroEngineBase *targetEngine, const std::function<void(void)> &flushCallback) {
+        TRACE_EVENT("gpu", "MacroState::Execute", "position", position);
+
+        // Timing is only done while statistics are being collected or tracing as it requires querying the clock twice for every macro call
+        bool profile{collectStatistics || TRACE_EVENT_CATEGORY_ENABLED("gpu")};
+        i64 startTime{profile ? util::GetTimeNs() : 0};
+
         size_t offset{macroPositions[position]};
 
         if (invalidatePending) {
             macroHleFunctions.fill({});
+            macroJit.Invalidate();
             invalidatePending = false;
         }
 
@@ -94,17 +116,48 @@ namespace skyline::soc::gm20b {
 
         if (!hleEntry.valid) {
             hleEntry.function = macro_hle::LookupFunction(span(macroCode).subspan(offset));
+
+            // Statistics are keyed by the macro's contents rather than its position so a re-upload of a different macro to the same position starts with fresh counters
+            if (collectStatistics) {
+                auto [hash, size]{GetMacroSignature(offset)};
+                hleEntry.statistics = &macroStatistics[hash];
+                hleEntry.statistics->hash = hash;
+                hleEntry.statistics->size = size;
+            }
+
             hleEntry.valid = true;
         }
 
-        if (macroHleFunctions[position].function && macroHleFunctions[position].function(offset, args, targetEngine, flushCallback))
-            return;
+        MacroStatistics discardedStatistics{};
+        auto &statistics{hleEntry.statistics ? *hleEntry.statistics : discardedStatistics};
+        statistics.calls++;
 
-        if (AnyArgsDirty(args))
-            flushCallback();
+        engine::MacroExecutionStatistics executionStatistics{};
+        if (hleEntry.function && hleEntry.function(offset, args, targetEngine, flushCallback)) {
+            statistics.hleHits++;
+        } else {
+            // The signatures of macros that miss HLE are logged as their call count grows, this allows finding hot macros that are worth HLEing without waiting for the statistics dump
+            if (std::has_single_bit(++statistics.hleMisses) && hleEntry.statistics)
+                LOGI("Macro without HLE ({} calls): {{Function, 0x{:X}, 0x{:X}}}", statistics.hleMisses, statistics.size, statistics.hash);
 
-        argumentStorage.resize(args.size());
-        std::transform(args.begin(), args.end(), argumentStorage.begin(), [](GpfifoArgument arg) { return *arg; });
-        macroInterpreter.Execute(offset, argumentStorage, targetEngine);
+            if (AnyArgsDirty(args))
+                flushCallback();
+
+            argumentStorage.resize(args.size());
+            std::transform(args.begin(), args.end(), argumentStorage.begin(), [](GpfifoArgument arg) { return *arg; });
+            if (auto jitStatistics{macroJit.Execute(position, offset, argumentStorage, targetEngine)})
+                executionStatistics = *jitStatistics;
+            else
+                executionStatistics = macroInterpreter.Execute(offset, argumentStorage, targetEngine);
+
+            statistics.instructions += executionStatistics.instructions;
+            statistics.methods += executionStatistics.methods;
+        }
+
+        if (profile) {
+            statistics.time += util::GetTimeNs() - startTime;
+            TRACE_COUNTER("gpu", "Macro Instructions", executionStatistics.instructions);
+            TRACE_COUNTER("gpu", "Macro Methods", executionStatistics.methods);
+        }
     }
 }
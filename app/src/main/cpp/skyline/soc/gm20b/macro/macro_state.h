@@ -5,6 +5,7 @@
 
 #include <common.h>
 #include "macro_interpreter.h"
+#include "macro_jit.h"
 
 namespace skyline::soc::gm20b {
     /**
@@ -32,28 +33,59 @@ namespace skyline::soc::gm20b {
      * @brief Holds per-channel macro state
      */
     struct MacroState {
+        /**
+         * @brief Cumulative profiling counters for a single macro
+         */
+        struct MacroStatistics {
+            u32 hash;
+            size_t size;
+            u64 calls;
+            u64 hleHits; //!< The amount of calls that were handled by a HLE function
+            u64 hleMisses; //!< The amount of calls that had to be executed by the JIT or interpreter
+            u64 instructions; //!< The amount of macro instructions executed by the JIT or interpreter
+            u64 methods; //!< The amount of methods sent by the JIT or interpreter
+            i64 time; //!< The wall time spent executing the macro in nanoseconds
+        };
+
         struct MacroHleEntry {
             macro_hle::Function function;
+            MacroStatistics *statistics; //!< The statistics of the macro at this position, this is only set when statistics collection is enabled
             bool valid;
         };
 
         engine::MacroInterpreter macroInterpreter; //!< The macro interpreter for handling 3D/2D macros
+        engine::MacroJit macroJit; //!< The macro JIT for handling 3D/2D macros, this is used in preference to the interpreter for any macros it can compile
         std::array<u32, 0x2000> macroCode{}; //!< Stores GPU macros, writes to it will wraparound on overflow
         std::array<size_t, 0x80> macroPositions{}; //!< The positions of each individual macro in macro code memory, there can be a maximum of 0x80 macros at any one time
         std::array<MacroHleEntry, 0x80> macroHleFunctions{}; //!< The HLE functions for each macro position, used to optionally override the interpreter
         std::vector<u32> argumentStorage; //!< Storage for the macro arguments during execution using the interpreter
 
+        bool collectStatistics; //!< If per-macro statistics should be collected, they are logged when the channel is destroyed and the signatures of macros without a HLE implementation are logged as they become hot so they can be HLEd
+        std::unordered_map<u32, MacroStatistics> macroStatistics; //!< The statistics of all executed macros keyed by their HLE hash, this is only populated when statistics collection is enabled
+
         bool invalidatePending{};
 
-        MacroState() : macroInterpreter{macroCode} {}
+        explicit MacroState(bool collectStatistics = false) : macroInterpreter{macroCode}, macroJit{macroCode}, collectStatistics{collectStatistics} {}
+
+        ~MacroState();
 
         /**
-         * @brief Invalidates the HLE function cache
+         * @brief Invalidates the HLE function and JIT caches
          */
         void Invalidate();
 
         /**
-         * @brief Executes a macro at a given position, this can either be a HLE function or the interpreter
+         * @return The HLE hash and size of the macro at the supplied offset, macros that reach outside of macro memory use the remainder of macro memory
+         */
+        std::pair<u32, size_t> GetMacroSignature(size_t offset);
+
+        /**
+         * @brief Logs the statistics of all macros that have been called, sorted by the time spent in them
+         */
+        void DumpStatistics();
+
+        /**
+         * @brief Executes a macro at a given position, this can either be a HLE function, the JIT or the interpreter
          */
         void Execute(u32 position, span<GpfifoArgument> args, engine::MacroEngineBase *targetEngine, const std::function<void(void)> &flushCallback);
     };
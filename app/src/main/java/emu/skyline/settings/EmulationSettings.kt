@@ -61,8 +61,10 @@ class EmulationSettings private constructor(context : Context, prefName : String
     var useDirectMemoryImport by sharedPreferences(context, false, prefName = prefName)
     var forceMaxGpuClocks by sharedPreferences(context, false, prefName = prefName)
     var freeGuestTextureMemory by sharedPreferences(context, true, prefName = prefName)
+    var useGpuTextureDecoding by sharedPreferences(context, false, prefName = prefName)
     var useAsyncShaders by sharedPreferences(context, false, prefName = prefName)
     var disableShaderCache by sharedPreferences(context, false, prefName = prefName)
+    var lazyPipelineLoading by sharedPreferences(context, false, prefName = prefName)
     var enableDynamicResolution by sharedPreferences(context, false, prefName = prefName)
     var enableSampleShading by sharedPreferences(context, false, prefName = prefName)
 
@@ -74,6 +76,7 @@ class EmulationSettings private constructor(context : Context, prefName : String
     // Debug
     var logLevel by sharedPreferences(context, 2, prefName = prefName) // Info by default
     var validationLayer by sharedPreferences(context, false, prefName = prefName)
+    var logMacroStatistics by sharedPreferences(context, false, prefName = prefName)
 
     /**
      * Copies all settings from the global settings to this instance.
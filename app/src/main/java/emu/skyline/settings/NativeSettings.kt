@@ -39,8 +39,10 @@ data class NativeSettings(
     var useDirectMemoryImport : Boolean,
     var forceMaxGpuClocks : Boolean,
     var freeGuestTextureMemory : Boolean,
+    var useGpuTextureDecoding : Boolean,
     var useAsyncShaders : Boolean,
     var disableShaderCache : Boolean,
+    var lazyPipelineLoading : Boolean,
     var enableSampleShading : Boolean,
 
     // Hacks
@@ -50,7 +52,8 @@ data class NativeSettings(
 
     // Debug
     var logLevel : Int,
-    var validationLayer : Boolean
+    var validationLayer : Boolean,
+    var logMacroStatistics : Boolean
 ) {
     constructor(context : Context, pref : EmulationSettings) : this(
         pref.enableSpeedLimit,
@@ -71,14 +74,17 @@ data class NativeSettings(
         pref.useDirectMemoryImport,
         pref.forceMaxGpuClocks,
         pref.freeGuestTextureMemory,
+        pref.useGpuTextureDecoding,
         pref.useAsyncShaders,
         pref.disableShaderCache,
+        pref.lazyPipelineLoading,
         pref.enableSampleShading,
         pref.enableFastGpuReadbackHack,
         pref.enableFastReadbackWrites,
         pref.disableSubgroupShuffle,
         pref.logLevel,
-        BuildConfig.BUILD_TYPE != "release" && pref.validationLayer
+        BuildConfig.BUILD_TYPE != "release" && pref.validationLayer,
+        pref.logMacroStatistics
     )
 
     /**